@@ -27,7 +27,14 @@ namespace NetOff
         UNPAUSE = 9,
         RESET = 10,
         INPUTS = 11,
-        CLIENT_ABORT = 12
+        CLIENT_ABORT = 12,
+        /*! The inputs of all simulations arrived in one frame, see SimulationServer::sendOutputValuesAll(). */
+        INPUTS_ALL = 23,
+        /*! The client wants the outputs of a simulation pushed, see SimulationServer::pushOutputValues(). */
+        SUBSCRIBE = 24,
+        UNSUBSCRIBE = 25,
+        /*! The server stepped the simulations itself, see SimulationServer::stepSimulations(). */
+        STEPPED = 26
     };
 
     enum InitialServerMessageSpecifyer
@@ -0,0 +1,207 @@
+/*
+ * AsyncSimulationClient.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_ASYNCSIMULATIONCLIENT_HPP_
+#define INCLUDE_ASYNCSIMULATIONCLIENT_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SimulationClient.hpp"
+#include "SpscQueue.hpp"
+
+namespace NetOff
+{
+
+    /*! \brief Values of one step, owned by the caller or copied out of the connection by the I/O thread. */
+    struct StepValues
+    {
+        int simId;
+        double time;
+        std::vector<double> reals;
+        std::vector<int> ints;
+        std::vector<char> bools;
+
+        StepValues()
+                : simId(-1),
+                  time(0.0),
+                  reals(),
+                  ints(),
+                  bools()
+        {
+        }
+    };
+
+    /*! \brief Runs the steps of a started SimulationClient on a background I/O thread.
+     *
+     * The calling thread hands requests over through a lock-free queue and continues, e.g. with rendering, while the
+     * inputs are sent and the server computes. Results are delivered by std::future or, for the callback variants,
+     * by processCompletions() on the calling thread. All functions have to be called from the same thread.
+     *
+     * Requests are handled in order. The I/O thread only waits for outputs, when no further request is queued, so
+     * inputs sent meanwhile leave when the next outputs arrived.
+     *
+     * At most queueCapacity requests with a callback can wait for processCompletions(), so the I/O thread always
+     * finds a free slot for their completions.
+     */
+    class AsyncSimulationClient
+    {
+     public:
+        typedef std::function<void(const bool & sent)> SendCallback;
+
+        typedef std::function<void(const StepValues & outputs)> RecvCallback;
+
+        /*! \brief Takes over the client, which has to be started. The client must not be used otherwise, until this
+         * object is destroyed.
+         * \param queueCapacity Number of requests, which can be queued at once, and of requests with a callback, whose
+         *                      callback didn't run yet.
+         */
+        AsyncSimulationClient(SimulationClient & client, const size_t & queueCapacity = 1024);
+
+        AsyncSimulationClient(const AsyncSimulationClient &) = delete;
+
+        AsyncSimulationClient& operator=(const AsyncSimulationClient &) = delete;
+
+        /*! \brief Waits until all requests are handled and all requested outputs arrived, then stops the I/O thread. */
+        ~AsyncSimulationClient();
+
+        /*! \brief Sends the input values of a step, see SimulationClient::sendInputValues().
+         *
+         * The containers of the client belong to the I/O thread, so the values are passed in the order of the input
+         * variables given to SimulationClient::initializeSimulation().
+         * \return Future, which becomes true when the values were sent. Errors are rethrown by its get().
+         */
+        std::future<bool> sendInputValuesAsync(const int & simId, const double & time, StepValues inputs);
+
+        /*! \brief Same as above, but the callback is run by processCompletions() after the values were sent.
+         * \exception std::runtime_error queueCapacity callbacks didn't run yet, call processCompletions() first.
+         */
+        void sendInputValuesAsync(const int & simId, const double & time, StepValues inputs,
+                                  const SendCallback & callback);
+
+        /*! \brief Receives the outputs of the oldest pending step of the simulation, see
+         * SimulationClient::recvOutputValues().
+         * \return Future of the outputs. Errors are rethrown by its get().
+         */
+        std::future<StepValues> recvOutputValuesAsync(const int & simId, const double & time);
+
+        /*! \brief Same as above, but the callback is run by processCompletions() when the outputs arrived.
+         * \exception std::runtime_error queueCapacity callbacks didn't run yet, call processCompletions() first.
+         */
+        void recvOutputValuesAsync(const int & simId, const double & time, const RecvCallback & callback);
+
+        /*! \brief Runs the callbacks of all completed requests on the calling thread.
+         *
+         * An error of a request with a callback is rethrown here, the following completions stay queued.
+         * \return Number of callbacks run.
+         */
+        size_t processCompletions();
+
+     private:
+        enum class RequestType
+        {
+            SEND,
+            RECV
+        };
+
+        struct Request
+        {
+            RequestType type;
+            int simId;
+            double time;
+            StepValues inputs;
+            std::promise<bool> sent;
+            std::promise<StepValues> outputs;
+            SendCallback sendCallback;
+            RecvCallback recvCallback;
+
+            Request()
+                    : type(RequestType::SEND),
+                      simId(-1),
+                      time(0.0),
+                      inputs(),
+                      sent(),
+                      outputs(),
+                      sendCallback(),
+                      recvCallback()
+            {
+            }
+        };
+
+        /*! Finished request with a callback. */
+        struct Completion
+        {
+            SendCallback sendCallback;
+            bool sent;
+            RecvCallback recvCallback;
+            StepValues outputs;
+            std::exception_ptr error;
+
+            Completion()
+                    : sendCallback(),
+                      sent(false),
+                      recvCallback(),
+                      outputs(),
+                      error()
+            {
+            }
+        };
+
+        SimulationClient & _client;
+
+        SpscQueue<Request> _requests;
+        SpscQueue<Completion> _completions;
+        /*! Requests with a callback, whose callback didn't run yet, and their limit. Only used by the caller. */
+        size_t _numCallbacks;
+        size_t _maxCallbacks;
+
+        std::thread _ioThread;
+        std::atomic<bool> _stop;
+        /*! The I/O thread sleeps on _wakeup, while no request is queued and no outputs are awaited. */
+        std::atomic<bool> _sleeping;
+        std::mutex _mutex;
+        std::condition_variable _wakeup;
+
+        /*! Receive requests per simulation, which wait for their outputs, and outputs, that arrived before they were
+         * requested. Only used by the I/O thread. A list, because the vector needs a non-throwing move to grow
+         * without copying, and the requests can't be copied. */
+        std::vector<std::list<Request>> _awaited;
+        std::vector<std::deque<StepValues>> _unclaimed;
+        size_t _numAwaited;
+
+        void push(Request && request);
+
+        /*! Reserves the completion of a request with a callback, throws if none is left. */
+        void reserveCompletion();
+
+        void run();
+
+        void handle(Request & request);
+
+        /*! Waits for the next outputs of any simulation and completes the request awaiting them. */
+        void receiveOutputs();
+
+        void completeSend(Request & request, const bool & sent, const std::exception_ptr & error);
+
+        void completeRecv(Request & request, StepValues && outputs, const std::exception_ptr & error);
+
+        void pushCompletion(Completion && completion);
+
+        StepValues copyOutputs(const int & simId);
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_ASYNCSIMULATIONCLIENT_HPP_ */
@@ -0,0 +1,102 @@
+/*
+ * BufferPool.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_BUFFERPOOL_HPP_
+#define INCLUDE_BUFFERPOOL_HPP_
+
+#include <cstddef>
+#include <memory>
+
+namespace NetOff
+{
+
+    /*! \brief Process wide pool of the message buffers.
+     *
+     * Buffers are cache line aligned and rounded up to a power of two times 64 bytes. A released buffer goes to the
+     * free list of its size class and is handed out again by the next request of that class, so a steady state of
+     * messages doesn't allocate. The control blocks of the returned shared pointers are pooled the same way. A class
+     * keeps up to 16 MiB of free buffers, but at least two, the rest is returned to the heap. The pool is thread safe.
+     */
+    class BufferPool
+    {
+     public:
+        enum : size_t
+        {
+            /*! Alignment of every buffer, a cache line. */
+            alignment = 64
+        };
+
+        /*! \brief Counters of the pool since the start of the process. */
+        struct Statistics
+        {
+            /*! Buffers, which had to be allocated from the heap. */
+            size_t numAllocated;
+            /*! Buffers, which were taken from a free list. */
+            size_t numReused;
+            /*! Bytes of the buffers in the free lists. */
+            size_t numFreeBytes;
+        };
+
+        /*! \brief Returns a buffer of at least size bytes, which goes back to the pool when the last pointer to it is
+         * released. */
+        static std::shared_ptr<char> allocate(const size_t & size);
+
+        /*! \brief Returns a buffer of at least size bytes, which has to be given back with deallocate(). */
+        static char * allocateRaw(const size_t & size);
+
+        static void deallocate(char * data);
+
+        static Statistics getStatistics();
+
+        /*! \brief Returns the buffers of all free lists to the heap. */
+        static void trim();
+
+        /*! \brief Allocator of the pool for standard containers and shared pointer control blocks. */
+        template<typename T>
+        struct Allocator
+        {
+            typedef T value_type;
+
+            Allocator()
+            {
+            }
+
+            template<typename U>
+            Allocator(const Allocator<U> &)
+            {
+            }
+
+            T * allocate(const size_t & num)
+            {
+                return reinterpret_cast<T *>(BufferPool::allocateRaw(num * sizeof(T)));
+            }
+
+            void deallocate(T * data, const size_t &)
+            {
+                BufferPool::deallocate(reinterpret_cast<char *>(data));
+            }
+
+            template<typename U>
+            bool operator==(const Allocator<U> &) const
+            {
+                return true;
+            }
+
+            template<typename U>
+            bool operator!=(const Allocator<U> &) const
+            {
+                return false;
+            }
+        };
+
+     private:
+        BufferPool() = delete;
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_BUFFERPOOL_HPP_ */
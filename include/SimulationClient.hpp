@@ -8,14 +8,20 @@
 #ifndef INCLUDE_SIMULATIONCLIENT_HPP_
 #define INCLUDE_SIMULATIONCLIENT_HPP_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <map>
 #include <vector>
 
 #include "AdditionalTypes.hpp"
+#include "Statistics.hpp"
 #include "ValueContainer.hpp"
 #include "VariableList.hpp"
 #include "network_impl/NetworkClient.hpp"
+#include "network_impl/RealTime.hpp"
+#include "messages/FrameHeader.hpp"
+#include "messages/MessageArena.hpp"
 #include "messages/ValueContainerMessage.hpp"
 
 namespace NetOff
@@ -30,8 +36,9 @@ namespace NetOff
 
         /*! \brief Constructs a SimulationClient object from the given server address and port.
          *
-         * \param hostAddress   Address of the server to connect this SimulationClient.
-         * \param port          The port to use for the connection.
+         * \param hostAddress   Address of the server to connect this SimulationClient. A server on the same host can
+         *                      also be reached by its Unix domain socket as "unix:/path/to/socket".
+         * \param port          The port to use for the connection, ignored for Unix domain sockets.
          */
         SimulationClient(std::string hostAddress, const int & port);
 
@@ -149,35 +156,205 @@ namespace NetOff
         ValueContainer & getInputValueContainer(const int & simId);
         ValueContainer & getOutputValueContainer(const int & simId);
 
-        /*! \brief Receive the output values for the given simulation and time from the server.
+        /*! \brief Receive the output values of the oldest pending step of the given simulation from the server.
          *
-         * Because we have a asynchronous communication, the time value is used to unambiguously identify the output
-         * values on client side and also when sending the corresponding input values via \ref sendInputValues().
+         * The outputs are matched to the inputs by the sequence number of the frames, so the outputs of pipelined
+         * steps are returned in the order their inputs were sent with \ref sendInputValues(). Outputs of other
+         * simulations, which arrive meanwhile, are buffered until they are received.
          *
          * \param simId ID of the simulation.
-         * \param time  Value of time step.
+         * \param time  Value of time step. Only informative, it isn't used to match the outputs.
          * \exception std::runtime_error Simulation was not yet started.
+         * \exception std::runtime_error No step of the simulation is pending.
+         * \exception std::runtime_error The answer to a batch arrived first. It's kept, until it's received by
+         *                                \ref recvOutputValuesAll().
+         * \exception std::runtime_error The server answered with an unexpected sequence number.
          * \return ValueContainer containing the output values.
          */
         ValueContainer & recvOutputValues(const int & simId, const double & time);
 
+        /*! \brief Receives the outputs of the pending step, that arrived first, of any simulation.
+         *
+         * A server, which steps the simulations in parallel, answers them as soon as they are done. So a slow
+         * simulation doesn't hold up the outputs of the fast ones. The outputs are stored in the output container of
+         * the returned simulation, see \ref getOutputValueContainer().
+         *
+         * \exception std::runtime_error Simulation was not yet started.
+         * \exception std::runtime_error No step of any simulation is pending.
+         * \exception std::runtime_error The answer to a batch arrived first. It's kept, until it's received by
+         *                                \ref recvOutputValuesAll().
+         * \exception std::runtime_error The server answered with an unexpected sequence number.
+         * \return ID of the simulation or -1, if the connection was lost.
+         */
+        int recvAnyOutput();
+
+        /*! \brief Receives the output values of the oldest pending step of the simulation, if they arrived already.
+         *
+         * Never blocks: it reads the data available on the connection, see \ref processIncoming(). The outputs are
+         * stored in the output container of the simulation, see \ref getOutputValueContainer().
+         *
+         * \param simId ID of the simulation.
+         * \exception std::runtime_error Simulation was not yet started.
+         * \exception std::runtime_error No step of the simulation is pending.
+         * \exception std::runtime_error The answer to a batch arrived first, see \ref recvAnyOutput().
+         * \exception std::runtime_error The server answered with an unexpected sequence number.
+         * \return True, if the outputs were received. False, if they didn't arrive yet or the connection was lost.
+         */
+        bool tryRecvOutputValues(const int & simId);
+
+        /*! \brief Reads all data available on the connection without blocking.
+         *
+         * A frame, that didn't arrive completely, is continued by the next call. Answers to pending steps are
+         * buffered until they are received, pushed outputs are stored like by \ref pollLatestOutputs(). Reading stops
+         * at the answer to a batch until it's received by \ref recvOutputValuesAll().
+         *
+         * An external event loop waits until \ref nativeHandle() is readable and calls this function. It has to be
+         * called before every wait, with the shared memory transport it asks the server to signal the socket.
+         *
+         * \exception std::runtime_error Simulation was not yet started.
+         * \return Number of frames completed or -1, if the connection was lost.
+         */
+        int processIncoming();
+
+        /*! \brief Returns the socket of the connection, which becomes readable when outputs arrive. */
+        SocketHandle nativeHandle() const;
+
         /*! \brief Sends input values of the given simulation and time to the server.
          *
-         * Because we have a asynchronous communication, the time value is used to unambiguously identify the input
-         * values on server side and also when receiving the corresponding output values via \ref recvOutputValues().
+         * Several steps per simulation can be sent before their outputs are received, see \ref setPipelineDepth().
+         * The input container can be changed as soon as this function returned.
          *
          * \param simId ID of the simulation.
          * \param time  Value of time step.
          * \param vals  The input values.
          * \exception std::runtime_error Simulation was not yet started.
          * \exception std::runtime_error Given simulation ID and simulation ID of vals to not match.
+         * \exception std::runtime_error The pipeline of the simulation is full.
          * \return True, if the values were successfully sent.
          */
         bool sendInputValues(const int & simId, const double & time, const ValueContainer & vals);
 
+        /*! \brief Sends the input values of all simulations at the given time to the server in one frame.
+         *
+         * The values are taken from the input containers, see \ref getInputValueContainer(). The server answers
+         * with the outputs of all simulations in one frame, which is received by \ref recvOutputValuesAll(). Batches
+         * and single steps can be mixed, their outputs are received in the order the inputs were sent.
+         *
+         * \param time  Value of time step.
+         * \exception std::runtime_error Simulation was not yet started.
+         * \exception std::runtime_error The pipeline of the batches is full.
+         * \return True, if the values were successfully sent.
+         */
+        bool sendInputValuesAll(const double & time);
+
+        /*! \brief Receives the output values of all simulations of the oldest pending batch, see
+         * \ref sendInputValuesAll(). The values are stored in the output containers.
+         *
+         * \param time  Value of time step. Only informative, it isn't used to match the outputs.
+         * \exception std::runtime_error Simulation was not yet started.
+         * \exception std::runtime_error No batch is pending.
+         * \exception std::runtime_error The server answered with an unexpected frame.
+         * \return True, if the values were successfully received.
+         */
+        bool recvOutputValuesAll(const double & time);
+
+        /*! \brief Asks the server to push the outputs of the simulation, while it runs freely.
+         *
+         * The pushed outputs are read by \ref pollLatestOutputs() without sending requests. Input values sent with
+         * \ref sendInputValues() become asynchronous updates of the simulation, which aren't answered.
+         *
+         * \param simId  ID of the simulation.
+         * \param period Simulation time between two pushed outputs, 0 pushes the outputs of every step.
+         * \exception std::runtime_error Simulation was not yet started.
+         * \return True, if the request was sent.
+         */
+        bool subscribe(const int & simId, const double & period);
+
+        /*! \brief Stops pushing the outputs of the simulation. Outputs pushed meanwhile are still received. */
+        bool unsubscribe(const int & simId);
+
+        bool isSubscribed(const int & simId) const;
+
+        /*! \brief Reads all outputs, that arrived already, and returns the newest ones of the simulation.
+         *
+         * Answers to pending steps are buffered until they are received by \ref recvOutputValues(), reading stops at
+         * the answer to a batch until it's received by \ref recvOutputValuesAll(). The container is overwritten by
+         * every output of the simulation received later.
+         *
+         * \param simId     ID of the simulation.
+         * \param received  Set to true, if pushed outputs of the simulation arrived since the last call. Optional.
+         * \param timeoutMs Maximal time to wait for data, if nothing arrived yet. Default is 0, -1 waits infinitely.
+         * \return ValueContainer containing the newest output values.
+         */
+        ValueContainer & pollLatestOutputs(const int & simId, bool * received = nullptr, const int & timeoutMs = 0);
+
+        /*! \brief Returns the time of the newest output values of the simulation. */
+        const double & getOutputTime(const int & simId) const;
+
+        /*! \brief Limits the number of steps per simulation, which can be sent before their outputs are received.
+         * 0, the default, doesn't limit them.
+         *
+         * A deeper pipeline hides the round trip time of the connection. Client and server block while sending, so
+         * the frames of a full pipeline have to fit into the socket buffers or the shared memory rings. Outputs, which
+         * arrive before they are received, are stored in a slot per step in flight, which start() reserves. Without a
+         * limit the slots grow on demand, which allocates until the most steps in flight were stored once.
+         */
+        void setPipelineDepth(const size_t & depth);
+
+        size_t getPipelineDepth() const;
+
+        /*! \brief Returns the number of steps of the simulation, whose outputs weren't received yet. */
+        size_t getNumPendingSteps(const int & simId) const;
+
+        /*! \brief Returns the number of batches, whose outputs weren't received yet. */
+        size_t getNumPendingBatches() const;
+
         /*! \brief Returns true, if the current status is CurrentStatus::STARTED. */
         bool isStarted() const;
 
+        /*! \brief Sets the deadline in milliseconds of initializeConnection(), a negative value waits infinitely. */
+        void setConnectionTimeout(const int & timeoutMs);
+
+        /*! \brief Limits the bytes per send/receive system call of the connection, see NetworkMember::setHighWaterMark(). */
+        void setHighWaterMark(const int & numBytes);
+
+        /*! \brief Sets how the client waits for outputs, see NetworkMember::setWaitPolicy().
+         *
+         * Spinning trades a core for latency, it only pays off when the client has a core of its own.
+         */
+        void setWaitPolicy(const WaitPolicy & policy, const int & spinUs = 50);
+
+        /*! \brief Sets the ring size per direction of the shared memory transport, which initializeConnection() offers
+         * to a server on the same host. 0 keeps the data on the socket. Default is 1 MiB.
+         */
+        void setSharedMemorySize(const size_t & ringBytes);
+
+        /*! \brief Returns the system calls and bytes the connection used since the last reset. */
+        NetworkCounters getNetworkCounters() const;
+
+        void resetNetworkCounters();
+
+        /*! \brief Returns the messages and bytes per message type, the system calls of the connection and the round
+         * trip times of the steps per simulation since the connection was established or the last reset.
+         *
+         * The counters are relaxed atomics, so another thread can call this while the client steps, e.g. while an
+         * AsyncSimulationClient drives it, as long as no simulation is added meanwhile. Round trips are timed from
+         * sending the inputs until their outputs arrived, not until they were received by the caller.
+         */
+        SimulationStatistics getStatistics() const;
+
+        /*! \brief Resets the statistics including the network counters. Has to be called by the thread using the
+         * client, otherwise counts of concurrent messages may survive the reset. */
+        void resetStatistics();
+
+        /*! \brief Sets the profile, which start() applies to the calling thread and the message buffers. The worker
+         * settings are only used by the server. */
+        void setRealTimeProfile(const RealTimeProfile & profile);
+
+        /*! \brief Returns which settings of the profile were applied and the page faults and heap growth since
+         * start(). */
+        RealTimeReport getRealTimeReport() const;
+
      private:
 
         /////////////////////////////////////////
@@ -205,30 +382,174 @@ namespace NetOff
 
         std::vector<ValueContainerMessage<ClientMessageSpecifyer> > _inputMessages;
         std::vector<ValueContainerMessage<ServerMessageSpecifyer> > _outputMessages;
+        /*! The messages of all simulations, packed by start(). */
+        MessageArena<ClientMessageSpecifyer> _inputArena;
+        MessageArena<ServerMessageSpecifyer> _outputArena;
+
+        size_t _pipelineDepth;
+        /*! Sequence number of the next frame sent per simulation and of the next answer expected per simulation. */
+        std::vector<uint32_t> _sendSeq;
+        std::vector<uint32_t> _recvSeq;
+        /*! Sequence numbers of the batches of all simulations. */
+        uint32_t _batchSendSeq;
+        uint32_t _batchRecvSeq;
+
+        std::vector<bool> _isSubscribed;
+        /*! Number of pushed outputs received per simulation and the value seen by the last pollLatestOutputs(). */
+        std::vector<size_t> _numPushed;
+        std::vector<size_t> _numPolled;
+        /*! A batch answer read by pollLatestOutputs(), processIncoming() or recvAnyOutput(), which wasn't received
+         * yet. */
+        bool _hasHeldAnswer;
+        FrameHeader _heldAnswer;
+
+        /*! Answers of a simulation, that arrived before they were received: a ring of num answers starting at
+         * first, every slot holds a frame header and a payload of the size of the output message. */
+        struct EarlyAnswers
+        {
+            std::vector<FrameHeader> headers;
+            std::vector<char> payloads;
+            size_t first;
+            size_t num;
+
+            EarlyAnswers();
+        };
+
+        /*! Early answers per simulation and the simulations of all early answers in the order they arrived, a ring
+         * of _numEarly entries starting at _earlyBegin. start() reserves a slot per step in flight, so storing an
+         * early answer doesn't allocate. */
+        std::vector<EarlyAnswers> _earlyAnswers;
+        std::vector<int> _earlyOrder;
+        size_t _earlyBegin;
+        size_t _numEarly;
+
+        /*! Frame, which processIncoming() received in parts. The payload is staged, so the output messages only
+         * change when the frame is complete. */
+        struct PartialFrame
+        {
+            FrameHeader header;
+            size_t numHeaderBytes;
+            std::vector<char> payload;
+            size_t numPayloadBytes;
+
+            PartialFrame()
+                    : header(),
+                      numHeaderBytes(0),
+                      payload(),
+                      numPayloadBytes(0)
+            {
+            }
+        };
+
+        PartialFrame _partialFrame;
+
+        RealTimeProfile _realTimeProfile;
+        RealTimeReport _realTimeReport;
+        ResourceUsage _startUsage;
+
+        /*! Values of awaitedSimId of recvFrame(): the answer of any simulation is awaited, or none is. */
+        enum : int
+        {
+            anySim = -2,
+            noSim = -3
+        };
+
+        /*! Time a frame, that is answered, was sent. */
+        struct SendStamp
+        {
+            uint32_t seq;
+            /*! 0, if the answer arrived already. */
+            uint64_t ns;
+        };
+
+        enum : size_t
+        {
+            /*! The send times of a simulation are kept in a ring indexed by the sequence number. Steps of a deeper
+             * pipeline overwrite the times of older ones, which then aren't timed. */
+            numSendStamps = 64
+        };
+
+        MessageTraffic _traffic;
+        std::vector<std::unique_ptr<LatencyHistogram>> _stepLatencies;
+        LatencyHistogram _batchLatency;
+        std::vector<std::vector<SendStamp>> _sendStamps;
+        std::vector<SendStamp> _batchSendStamps;
+
+        /*! Counts a received frame and records the round trip time, if it answers a step. */
+        void countFrame(const FrameHeader & header, const char * payload);
+
+        /*! Records the time since the frame with the sequence number was sent, if it's still in the ring. */
+        void recordRoundTrip(SendStamp & stamp, const uint32_t & seq, LatencyHistogram & latency);
+
+        /*! Receives the next frame into the output message(s) it belongs to. An answer of a single simulation other
+         * than awaitedSimId is stored as early answer instead.
+         * \exception std::runtime_error The frame belongs to an unknown simulation or has an unexpected size.
+         */
+        bool recvFrame(FrameHeader & header, const int & awaitedSimId);
+
+        /*! Receives the next answer of the simulation, which may have arrived early, or of all simulations for
+         * FrameHeader::allSims, or of any simulation for anySim. Pushed frames are skipped. */
+        bool recvAnswer(FrameHeader & header, const int & awaitedSimId);
+
+        /*! Returns the payload size of the frame.
+         * \exception std::runtime_error The frame belongs to an unknown simulation or has an unexpected size.
+         */
+        size_t getPayloadSize(const FrameHeader & header) const;
+
+        /*! Reads the available bytes of the partial frame. Returns 1, if it's complete, 0, if it isn't, or -1, if the
+         * connection was lost. */
+        int recvPartialFrame();
+
+        /*! Receives the rest of the partial frame blocking and stores it like recvFrame(). */
+        bool finishPartialFrame(FrameHeader & header, const int & awaitedSimId);
+
+        /*! Copies the complete payload of the partial frame into the output message(s) it belongs to or stores it as
+         * early answer. */
+        void storePartialFrame(const int & awaitedSimId);
+
+        /*! Appends an early answer to the simulation and returns the buffer its payload has to be read into. */
+        char * storeEarlyAnswer(const FrameHeader & header);
+
+        /*! Moves the oldest early answer of the simulation into its output message. */
+        void takeEarlyAnswer(const int & simId, FrameHeader & header);
+
+        /*! Enlarges the ring of early answers of the simulation and the arrival order to hold at least capacity
+         * answers of it. */
+        void reserveEarlyAnswers(const int & simId, const size_t & capacity);
+
+        /*! Applies the profile to the calling thread and the messages and records the usage. */
+        void applyRealTimeProfile();
+
+        /*! Throws, if outputs of a simulation are pending, which would be received before the answer of a request. */
+        void checkNoPendingSteps(const std::string & function) const;
+
+        /*! Throws, if the answer to a batch was read. Its outputs lie in the output containers, until
+         * recvOutputValuesAll() receives it, so no other answer may overwrite them. */
+        void checkNoHeldAnswer() const;
 
         /*! \brief Send the input values of the simulation specified by its ID.
          *
-         * \param simId ID of the simulation
+         * \param simId    ID of the simulation
+         * \param answered True, if the server answers the message, which is then pending until it's received.
          * @return True, if values were send successfully.
          */
-        bool send(const int simId);
+        bool send(const int simId, const bool & answered = true);
 
-        /*! \brief Receive the output values of the simulation specified by its ID.
-         *
-         * Because we have a asynchronous communication, the two values of expectedTime and specification are needed to
-         * unambiguously identify the output values.
+        /*! \brief Receive the answer to the oldest pending frame of the simulation specified by its ID.
          *
          * \param simId         ID of the simulation
-         * \param expectedTime  Time the values are needed for.
          * \param spec          Specifier to identify message and thus output values.
-         * @return True, if values were send successfully.
+         * \exception std::runtime_error The answer belongs to another simulation or frame.
+         * @return True, if values were received successfully and have the expected specifier.
          */
-        bool recv(const int simId, const double & expectedTime, const ServerMessageSpecifyer & spec =
-                          ServerMessageSpecifyer::OUTPUTS);
+        bool recv(const int simId, const ServerMessageSpecifyer & spec = ServerMessageSpecifyer::OUTPUTS);
 
         template<typename MessageType>
         bool sendInitialRequest(MessageType & in)
         {
+            // every message starts with its specifier, variableSend() prefixes the size
+            _traffic.countSent(*reinterpret_cast<const InitialClientMessageSpecifyer *>(in.data()),
+                               sizeof(int) + in.dataSize());
             return _netClient.variableSend(in.data(), in.dataSize());
         }
 
@@ -236,7 +557,13 @@ namespace NetOff
         MessageType recvInitialServerSuccess(const InitialServerMessageSpecifyer & in, const std::string & erroMessage,
                                              size_t * numBytes = nullptr)
         {
-            auto answer = _netClient.variableRecv(numBytes);
+            size_t numReceived = 0;
+            auto answer = _netClient.variableRecv(&numReceived);
+            if (numBytes != nullptr)
+                *numBytes = numReceived;
+            if (answer != nullptr)
+                _traffic.countReceived(*reinterpret_cast<const InitialServerMessageSpecifyer *>(answer.get()),
+                                       sizeof(int) + numReceived);
             MessageType sr(answer);
             if (!sr.testRequest(in))
                 throw std::runtime_error(erroMessage);
@@ -8,26 +8,50 @@
 #ifndef INCLUDE_SIMULATIONSERVER_HPP_
 #define INCLUDE_SIMULATIONSERVER_HPP_
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "AdditionalTypes.hpp"
+#include "Statistics.hpp"
 #include "ValueContainer.hpp"
 #include "VariableList.hpp"
+#include "StepPool.hpp"
 #include "network_impl/NetworkServer.hpp"
+#include "network_impl/RealTime.hpp"
+#include "messages/FrameHeader.hpp"
+#include "messages/MessageArena.hpp"
 #include "messages/ValueContainerMessage.hpp"
 
 namespace NetOff
 {
+    /*! \brief Offers simulations to SimulationClients.
+     *
+     * By default exactly one client is served and initializeConnection() waits for it. With setMaxClients() the
+     * server accepts further clients while running. All clients are watched by one event loop:
+     * waitForClientRequest() selects the next client with a pending request, and all other functions refer to the
+     * selected client until the next selection. Every client has its own handshake state and simulation ids.
+     */
     class SimulationServer
     {
      public:
+        /*! \brief Computes one step of a simulation, i.e. the outputs at time from the inputs. */
+        typedef std::function<void(const double & time, const ValueContainer & inputs, ValueContainer & outputs)> StepCallback;
 
         SimulationServer();
 
         SimulationServer(const int & port);
 
+        /*! \brief Constructs a server listening on a port number like "4444" or on a Unix domain socket given as
+         * "unix:/path/to/socket". Unix domain sockets need the POSIX backend.
+         */
+        SimulationServer(const std::string & address);
+
         SimulationServer(const SimulationServer& rhs) = delete;
 
         SimulationServer& operator=(const SimulationServer& rhs) = delete;
@@ -50,6 +74,41 @@ namespace NetOff
          */
         void deinitialize();
 
+        /*! \brief Sets the maximal number of concurrently served clients. Has to be called before
+         * initializeConnection(). Default is 1.
+         *
+         * With more than one client, initializeConnection() returns without waiting and clients are accepted by
+         * waitForClientRequest(). A receive then times out after 10 seconds, see setReceiveTimeout().
+         */
+        void setMaxClients(const size_t & maxClients);
+
+        const size_t & getMaxClients() const;
+
+        /*! \brief Waits until a client sent a request or closed its connection and selects that client.
+         *
+         * New clients are accepted meanwhile. Afterwards getInitialClientRequest() has to be called, if the client
+         * isn't started yet (see isClientStarted()), getClientRequest() otherwise. A lost connection or a malformed
+         * frame is reported as CLIENT_INIT_ABORT or CLIENT_ABORT respectively.
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         * \return Id of the selected client or -1 on timeout.
+         */
+        int waitForClientRequest(const int & timeoutMs = -1);
+
+        /*! \brief Selects the client the following calls refer to, e.g. to answer a request later. */
+        void selectClient(const int & clientId);
+
+        /*! \brief Returns the id of the selected client. */
+        int getLastClientId() const;
+
+        /*! \brief Returns true, if the selected client finished its initialization phase with START. */
+        bool isClientStarted() const;
+
+        /*! \brief Closes the connection to the selected client, e.g. after it aborted. The server keeps running. */
+        void disconnectClient();
+
+        /*! \brief Returns the number of connected clients. */
+        size_t getNumClients() const;
+
         InitialClientMessageSpecifyer getInitialClientRequest();
 
         /*! \brief Returns the pair <FmuPath, simId> for the most recently added simulation. */
@@ -77,6 +136,75 @@ namespace NetOff
         const int & getPort() const;
         void setPort(const int & port);
 
+        /*! \brief Sets the deadline in milliseconds of initializeConnection() for the first client, a negative value
+         * waits infinitely. */
+        void setConnectionTimeout(const int & timeoutMs);
+
+        /*! \brief Limits the bytes per send/receive system call of the connections, see NetworkMember::setHighWaterMark(). */
+        void setHighWaterMark(const int & numBytes);
+
+        /*! \brief Sets how the server waits for requests of its clients, see NetworkMember::setWaitPolicy().
+         *
+         * The spinning isn't supported together with the io_uring engine, which always blocks.
+         */
+        void setWaitPolicy(const WaitPolicy & policy, const int & spinUs = 50);
+
+        /*! \brief Sets how long a receive waits for the rest of a request, a negative value waits infinitely.
+         *
+         * A server of several clients only reads requests that started to arrive, but a client that stalls in the
+         * middle of one would hold up all others. It's then treated as lost, i.e. its request is reported as
+         * CLIENT_ABORT. Default is infinite for one client and 10 seconds after setMaxClients() with more, which this
+         * overrides, if it's called afterwards.
+         */
+        void setReceiveTimeout(const int & timeoutMs);
+
+        /*! \brief En-/disables the shared memory transport for clients on the same host. Enabled by default. */
+        void setSharedMemory(const bool & enable);
+
+        /*! \brief Serves the clients with the io_uring engine of the POSIX backend. Has to be called before
+         * initializeConnection(). Falls back to epoll, if io_uring isn't available.
+         *
+         * Output values are then sent in one batch, when the server runs out of requests to handle. Large outputs are
+         * sent zero copy from the output container, so a container has to be fetched again with
+         * getOutputValueContainer() before it's changed after sendOutputValues().
+         */
+        void setIoUring(const bool & enable);
+
+        /*! \brief True, if the io_uring engine is used. */
+        bool isIoUringActive() const;
+
+        /*! \brief Returns the system calls and bytes all connections used since the last reset. */
+        NetworkCounters getNetworkCounters() const;
+
+        void resetNetworkCounters();
+
+        /*! \brief Returns the messages and bytes per message type, the system calls and the step times of the
+         * connection to a client since it connected or the last reset.
+         *
+         * The step time of a simulation lasts from receiving its inputs until its outputs were sent, with the
+         * io_uring engine until they were queued. Additionally the durations of the step callbacks of
+         * stepSimulations() and the time the server waited for the next request of the client are recorded. A server
+         * with several clients waits in waitForClientRequest() instead, which isn't attributed to a client.
+         *
+         * The counters are relaxed atomics, so another thread can call this while the server runs, as long as the
+         * client stays connected and doesn't add simulations meanwhile.
+         * \exception std::runtime_error The client isn't connected.
+         */
+        SimulationStatistics getStatistics(const int & clientId) const;
+
+        /*! \brief Resets the statistics of the client including its network counters. Has to be called by the thread
+         * running the server, otherwise counts of concurrent messages may survive the reset. */
+        void resetStatistics(const int & clientId);
+
+        /*! \brief Sets the profile, which confirmStart() applies to the thread calling it, the message buffers of the
+         * client and the workers of stepSimulations(). With worker settings the workers are started by confirmStart().
+         */
+        void setRealTimeProfile(const RealTimeProfile & profile);
+
+        /*! \brief Returns which settings of the profile were applied and the page faults and heap growth since the
+         * last confirmStart(). */
+        RealTimeReport getRealTimeReport() const;
+
         /////////////////////////////////////////
         ////////////RUNNING CONNECTION///////////
         /////////////////////////////////////////
@@ -88,48 +216,216 @@ namespace NetOff
 
         bool sendOutputValues(const int & simId, const double & time);
         ValueContainer & recvInputValues(const int & simId);
+
+        /*! \brief Answers an INPUTS_ALL request with the outputs of all simulations in one frame.
+         *
+         * After getClientRequest() returned INPUTS_ALL, the inputs of all simulations are available in their input
+         * containers and getLastSimId() returns FrameHeader::allSims. The output containers of all simulations
+         * have to be filled before this call.
+         * \param time Value of time step, stored in all output messages.
+         */
+        bool sendOutputValuesAll(const double & time);
+
+        /*! \brief True, if the selected client subscribed to the outputs of the simulation.
+         *
+         * getClientRequest() reports SUBSCRIBE and UNSUBSCRIBE requests, which don't need an answer. The inputs of a
+         * subscribed simulation are updates, which are received with recvInputValues() but not answered.
+         */
+        bool isSubscribed(const int & simId) const;
+
+        /*! \brief Pushes the outputs of a subscribed simulation to the selected client, while it runs freely.
+         *
+         * Outputs are skipped, until the period of the subscription passed since the last pushed ones, so this can be
+         * called after every step.
+         * \param time Value of time step, stored in the output message.
+         * \return True, if the outputs were pushed.
+         */
+        bool pushOutputValues(const int & simId, const double & time);
+
+        /*! \brief Sets the number of worker threads of stepSimulations(). Default is the number of hardware threads. */
+        void setNumWorkers(const size_t & numWorkers);
+
+        size_t getNumWorkers() const;
+
+        /*! \brief Registers the step of a simulation of the selected client, which stepSimulations() runs for its
+         * inputs. An empty function removes the step. The step is called from a worker thread and can split an
+         * expensive computation with StepPool::runSubTasks(), so idle workers help with it.
+         */
+        void setStepCallback(const int & simId, const StepCallback & step);
+
+        /*! \brief Serves the requests of the selected client like getClientRequest(), but steps the simulations
+         * with a step callback itself.
+         *
+         * The INPUTS of such simulations are stepped in parallel on the workers and every simulation is answered
+         * as soon as its step finished, while further requests are received. So the answers of a round arrive in
+         * any order, see SimulationClient::recvAnyOutput(). An INPUTS_ALL request is stepped the
+         * same way, if all simulations have a step, and answered when all are done. Returns STEPPED, when all
+         * stepped simulations are answered and no further request is available. Any other request is returned
+         * after the running steps are answered and has to be handled like a result of getClientRequest().
+         *
+         * A step callback, that throws, isn't answered. The client is reported as CLIENT_ABORT after the running
+         * steps finished and getStepError() returns the exception.
+         */
+        ClientMessageSpecifyer stepSimulations();
+
+        /*! \brief Returns the exception of the first step callback of the selected client, that threw, or null. */
+        std::exception_ptr getStepError() const;
+
         bool isActive() const;
 
      private:
+        /*! \brief Handshake and simulation state of one connected client. */
+        struct ClientSession
+        {
+            CurrentState _currentState;
+
+            std::map<std::string, int> _pathToId;
+
+            InitialClientMessageSpecifyer _lastInitSpec;
+            ClientMessageSpecifyer _lastSpec;
+            std::vector<double> _lastReceivedTime;
+            /*! Sequence number of the last frame per simulation, which is echoed by the answer. */
+            std::vector<uint32_t> _lastReceivedSeq;
+            uint32_t _lastBatchSeq;
+            /*! Period of the subscription per simulation, negative if the simulation isn't subscribed, and the time the
+             * next output is pushed at. */
+            std::vector<double> _subscriptionPeriods;
+            std::vector<double> _nextPushTimes;
+            int _lastSimId;
+
+            std::string _lastSimulationFile;
+
+            /*! <FmuPath, simId> */
+            std::pair<const std::string, int> * _lastAddedSim;
+
+            bool _handledLastRequest;
+
+            std::vector<VariableList> _allInputVarNames;
+            std::vector<VariableList> _allOutputVarNames;
+            std::vector<VariableList> _selectedInputVarNames;
+            std::vector<VariableList> _selectedOutputVarNames;
+
+            std::vector<bool> _isInitialized;
+
+            std::vector<ValueContainerMessage<ClientMessageSpecifyer>> _inputMessages;
+            std::vector<ValueContainerMessage<ServerMessageSpecifyer>> _outputMessages;
+            /*! The messages of all simulations, packed by confirmStart(). */
+            MessageArena<ClientMessageSpecifyer> _inputArena;
+            MessageArena<ServerMessageSpecifyer> _outputArena;
+            /*! Gather list of a batch answer through the io_uring engine, which finds the registration of every
+             * message only in a part of its own. Kept to avoid allocations per round. */
+            std::vector<NetworkBuffer> _batchParts;
+            /*! Buffers of the output messages registered at the io_uring engine, -1 if not registered. */
+            std::vector<int> _outputBufferIds;
+            /*! Steps of stepSimulations() and whether a step of the simulation is running. */
+            std::vector<StepCallback> _stepCallbacks;
+            std::vector<bool> _isStepping;
+            /*! Exception of the first step callback, that threw, see getStepError(). */
+            std::exception_ptr _stepError;
+
+            /*! Statistics of the client, see getStatistics(). */
+            MessageTraffic _traffic;
+            std::vector<std::unique_ptr<LatencyHistogram>> _stepLatencies;
+            LatencyHistogram _batchLatency;
+            LatencyHistogram _computeTime;
+            LatencyHistogram _waitTime;
+            /*! Arrival time of the last frame header and of the unanswered inputs per simulation and of all
+             * simulations, 0 if they are answered. */
+            uint64_t _headerNs;
+            std::vector<uint64_t> _receivedNs;
+            uint64_t _batchReceivedNs;
+
+            ClientSession();
+
+            ClientSession(const ClientSession &) = delete;
+
+            ClientSession & operator=(const ClientSession &) = delete;
+        };
+
         int _port;
+        std::string _socketPath;
 
         CurrentState _currentState;
 
-        std::map<std::string, int> _pathToId;
         NetworkServer _netServer;
+        size_t _maxClients;
 
-        InitialClientMessageSpecifyer _lastInitSpec;
-        ClientMessageSpecifyer _lastSpec;
-        std::vector<double> _lastReceivedTime;
-        int _lastSimId;
+        /*! Sessions indexed by the connection id of their client. */
+        std::vector<std::unique_ptr<ClientSession>> _clients;
+        int _currentClient;
 
-        std::string _lastSimulationFile;
+        size_t _numWorkers;
+        /*! Workers of stepSimulations(), started on first use. */
+        std::unique_ptr<StepPool> _stepPool;
 
-        /*! <FmuPath, simId> */
-        std::pair<const std::string, int> * _lastAddedSim;
+        RealTimeProfile _realTimeProfile;
+        RealTimeReport _realTimeReport;
+        ResourceUsage _startUsage;
+        /*! Cleared by a worker, whose settings failed. */
+        std::atomic<bool> _workersPinned;
+        std::atomic<bool> _workerPrioritiesSet;
 
-        bool _handledLastRequest;
+        //size_t _tmpDataSize;
+        //std::shared_ptr<char> _tmpRecvData;
 
-        std::vector<VariableList> _allInputVarNames;
-        std::vector<VariableList> _allOutputVarNames;
-        std::vector<VariableList> _selectedInputVarNames;
-        std::vector<VariableList> _selectedOutputVarNames;
+        /*! Returns the session of the selected client or throws, if none is selected. */
+        ClientSession & client();
 
-        std::vector<bool> _isInitialized;
+        const ClientSession & client() const;
 
-        std::vector<ValueContainerMessage<ClientMessageSpecifyer>> _inputMessages;
-        std::vector<ValueContainerMessage<ServerMessageSpecifyer>> _outputMessages;
+        NetworkConnection & connection();
 
-        //size_t _tmpDataSize;
-        //std::shared_ptr<char> _tmpRecvData;
+        /*! Creates the session of a newly accepted client, if it doesn't exist yet. Returns the client id. */
+        int openSession(const int & clientId);
 
         std::shared_ptr<char> recvInitialMessage();
 
-        int recvSimulationId();
+        /*! Receives the FrameHeader of the next message and checks it. Returns false, if the connection was lost or
+         * the frame belongs to no simulation or has the wrong size. */
+        bool recvFrameHeader(FrameHeader & header);
+
+        /*! Receives the message of a FrameHeader into the input message of one or, for a batch, all simulations and
+         * sets _lastSimId and its sequence number. Returns false, if the connection was lost. */
+        bool recvPayload(const FrameHeader & header);
+
+        /*! Receives the next message, see recvPayload(). */
+        bool recvMessage();
+
+        /*! Evaluates the received message of the selected client and returns its request. */
+        ClientMessageSpecifyer evaluateRequest();
+
+        bool sendMessage(const int & simId, const uint32_t & flags = 0);
+
+        /*! Sends the output messages of all simulations in one frame. */
+        bool sendMessageAll();
 
-        int recvMessage();
+        /*! Runs the step callback of a simulation of the selected client, called by the workers. */
+        void runStep(const int & simId);
 
-        bool sendMessage(const int & simId);
+        /*! Starts the workers of stepSimulations(), which apply the worker settings of the profile. */
+        void startStepPool();
+
+        /*! Applies the worker settings of the profile to the calling worker. */
+        void setUpWorker(const size_t & index);
+
+        /*! Moves the messages of the session into its arenas and registers the new output buffers at the engine. */
+        void packMessages(ClientSession & c);
+
+        /*! Applies the profile to the calling thread and the messages of the session and records the usage. */
+        void applyRealTimeProfile(ClientSession & c);
+
+        /*! Marks the simulation of a finished step as idle and sends its outputs, if answer is true. A failed step
+         * isn't answered, its error is kept for getStepError(). Ignores the -1 of a pool without steps. */
+        void answerStep(const int & simId, const std::exception_ptr & error, const bool & answer = true);
+
+        /*! Answers finished steps until the simulation isn't stepped anymore. */
+        void waitForStep(const int & simId);
+
+        /*! Waits for all running steps and answers them, if answer is true. */
+        void finishSteps(const bool & answer);
+
+        /*! Finishes the running steps without answers and reports CLIENT_ABORT. */
+        ClientMessageSpecifyer abortSteps();
 
         void prepareAddSim(std::shared_ptr<char> & data);
 
@@ -139,10 +435,18 @@ namespace NetOff
 
         void prepareStart();
 
+        /*! Returns the session of a client or throws, if it isn't connected. */
+        ClientSession & session(const int & clientId);
+
+        const ClientSession & session(const int & clientId) const;
+
         template<typename MessageType>
         bool sendInitialRequest(MessageType & in)
         {
-            return _netServer.variableSend(in.data(), in.dataSize());
+            // every message starts with its specifier, variableSend() prefixes the size
+            client()._traffic.countSent(*reinterpret_cast<const InitialServerMessageSpecifyer *>(in.data()),
+                                        sizeof(int) + in.dataSize());
+            return connection().variableSend(in.data(), in.dataSize());
         }
     };
 
@@ -0,0 +1,102 @@
+/*
+ * SpscQueue.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_SPSCQUEUE_HPP_
+#define INCLUDE_SPSCQUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace NetOff
+{
+
+    /*! \brief Bounded lock-free queue between exactly one producer and one consumer thread.
+     *
+     * Only the producer calls push(), only the consumer calls pop(). The two positions live on different cache lines,
+     * so producer and consumer don't invalidate each other's line on every operation.
+     */
+    template<typename T>
+    class SpscQueue
+    {
+     public:
+        /*! \brief Creates a queue holding at least capacity elements. */
+        explicit SpscQueue(const size_t & capacity)
+                : _slots(),
+                  _mask(0),
+                  _head(0),
+                  _headPadding(),
+                  _tail(0),
+                  _tailPadding()
+        {
+            size_t size = 2;
+            while (size < capacity)
+            {
+                size *= 2;
+            }
+            _slots.resize(size);
+            _mask = size - 1;
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+
+        SpscQueue& operator=(const SpscQueue &) = delete;
+
+        /*! \brief Appends the value. Returns false and leaves the value untouched, if the queue is full. */
+        bool push(T && value)
+        {
+            const size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) > _mask)
+            {
+                return false;
+            }
+            _slots[tail & _mask] = std::move(value);
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /*! \brief Moves the oldest value out of the queue. Returns false, if the queue is empty. */
+        bool pop(T & value)
+        {
+            const size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            value = std::move(_slots[head & _mask]);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /*! \brief True, if the queue is empty. Exact for the consumer, a snapshot for the producer. */
+        bool empty() const
+        {
+            return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+        }
+
+     private:
+        /*! Size of a cache line, the positions are padded to it. */
+        enum : size_t
+        {
+            cacheLine = 64
+        };
+
+        std::vector<T> _slots;
+        size_t _mask;
+
+        /*! Position of the next pop, written by the consumer. */
+        std::atomic<size_t> _head;
+        char _headPadding[cacheLine - sizeof(std::atomic<size_t>)];
+        /*! Position of the next push, written by the producer. */
+        std::atomic<size_t> _tail;
+        char _tailPadding[cacheLine - sizeof(std::atomic<size_t>)];
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_SPSCQUEUE_HPP_ */
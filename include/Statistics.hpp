@@ -0,0 +1,229 @@
+/*
+ * Statistics.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_STATISTICS_HPP_
+#define INCLUDE_STATISTICS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace NetOff
+{
+
+    /*! \brief Traffic of a connection as seen by the socket layer. */
+    struct NetworkCounters
+    {
+        size_t numSendCalls;
+        size_t numRecvCalls;
+        size_t numBytesSent;
+        size_t numBytesReceived;
+    };
+
+    /*! \brief Returns the time of a monotonic clock in nanoseconds. */
+    uint64_t getMonotonicNs();
+
+    /*! \brief Counter, which is written by one thread and can be read by any other at any time.
+     *
+     * Loads and stores are relaxed atomics, so counting is a plain add without a locked instruction. Only the thread,
+     * that owns the counted object, may add, concurrent adds of several threads would get lost.
+     */
+    class RelaxedCounter
+    {
+     public:
+        RelaxedCounter()
+                : _value(0)
+        {
+        }
+
+        void add(const uint64_t & num)
+        {
+            _value.store(_value.load(std::memory_order_relaxed) + num, std::memory_order_relaxed);
+        }
+
+        uint64_t get() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            _value.store(0, std::memory_order_relaxed);
+        }
+
+     private:
+        std::atomic<uint64_t> _value;
+    };
+
+    /*! \brief NetworkCounters of a connection in use, see RelaxedCounter. */
+    struct LiveNetworkCounters
+    {
+        RelaxedCounter numSendCalls;
+        RelaxedCounter numRecvCalls;
+        RelaxedCounter numBytesSent;
+        RelaxedCounter numBytesReceived;
+
+        LiveNetworkCounters()
+                : numSendCalls(),
+                  numRecvCalls(),
+                  numBytesSent(),
+                  numBytesReceived()
+        {
+        }
+
+        NetworkCounters get() const;
+
+        void reset();
+    };
+
+    /*! \brief Histogram of durations in nanoseconds, which any number of threads record into without locks.
+     *
+     * Every power of two is split into four buckets, so a percentile is off by at most 25 %. Durations of 2^42 ns
+     * (73 minutes) and longer share the last bucket. Recording is a few relaxed atomic adds.
+     */
+    class LatencyHistogram
+    {
+     public:
+        enum : size_t
+        {
+            numBuckets = 164
+        };
+
+        /*! \brief Copy of a histogram at one point in time. */
+        struct Snapshot
+        {
+            uint64_t buckets[numBuckets];
+            uint64_t count;
+            uint64_t sumNs;
+            uint64_t maxNs;
+
+            Snapshot();
+
+            double getMeanUs() const;
+
+            double getMaxUs() const;
+
+            /*! \brief Returns the upper bound of the bucket holding the quantile, e.g. 0.99, in microseconds, but at
+             * most the maximum. 0, if nothing was recorded. */
+            double getPercentileUs(const double & quantile) const;
+        };
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram &) = delete;
+
+        LatencyHistogram & operator=(const LatencyHistogram &) = delete;
+
+        void record(const uint64_t & ns);
+
+        Snapshot getSnapshot() const;
+
+        void reset();
+
+        /*! \brief Returns the smallest duration counted by the bucket. */
+        static uint64_t getBucketStart(const size_t & bucket);
+
+     private:
+        std::atomic<uint64_t> _buckets[numBuckets];
+        std::atomic<uint64_t> _count;
+        std::atomic<uint64_t> _sumNs;
+        std::atomic<uint64_t> _maxNs;
+
+        static size_t getBucket(const uint64_t & ns);
+    };
+
+    /*! \brief Messages and bytes of one message type. */
+    struct MessageCounters
+    {
+        uint64_t numSent;
+        uint64_t numBytesSent;
+        uint64_t numReceived;
+        uint64_t numBytesReceived;
+    };
+
+    /*! \brief Statistics of a connection between a SimulationClient and a SimulationServer, see
+     * SimulationClient::getStatistics() and SimulationServer::getStatistics().
+     */
+    struct SimulationStatistics
+    {
+        enum : size_t
+        {
+            /*! The message specifiers of both sides don't overlap and are smaller. */
+            numMessageTypes = 27
+        };
+
+        /*! Messages per type, indexed by the value of their InitialClientMessageSpecifyer,
+         * ClientMessageSpecifyer, InitialServerMessageSpecifyer or ServerMessageSpecifyer. Bytes include the frame
+         * header. A batch of all simulations counts as one INPUTS_ALL message, its answer as one OUTPUTS message. */
+        MessageCounters messages[numMessageTypes];
+
+        /*! System calls and bytes of the connection. */
+        NetworkCounters network;
+
+        /*! Per simulation: The client records the round trip time from sending the inputs until their outputs
+         * arrived. The server records the time from receiving the inputs until the outputs were sent, i.e. the time
+         * the step took on the server. */
+        std::vector<LatencyHistogram::Snapshot> stepLatencies;
+
+        /*! The same for the batches of all simulations. */
+        LatencyHistogram::Snapshot batchLatency;
+
+        /*! Server only: Durations of the step callbacks run by SimulationServer::stepSimulations(). */
+        LatencyHistogram::Snapshot computeTime;
+
+        /*! Server only: Time the server waited for the next request of the client. */
+        LatencyHistogram::Snapshot waitTime;
+
+        SimulationStatistics();
+
+        /*! \brief Returns the name of the message specifier type, e.g. "INPUTS", or an empty string. */
+        static const char * getMessageTypeName(const size_t & type);
+    };
+
+    /*! \brief Messages per type of a connection in use, see SimulationStatistics::messages and RelaxedCounter. */
+    class MessageTraffic
+    {
+     public:
+        MessageTraffic();
+
+        MessageTraffic(const MessageTraffic &) = delete;
+
+        MessageTraffic & operator=(const MessageTraffic &) = delete;
+
+        /*! \brief Counts a message. Unknown types are ignored. */
+        void countSent(const int & type, const size_t & numBytes);
+
+        void countReceived(const int & type, const size_t & numBytes);
+
+        void copyTo(SimulationStatistics & statistics) const;
+
+        void reset();
+
+     private:
+        struct Counters
+        {
+            RelaxedCounter numSent;
+            RelaxedCounter numBytesSent;
+            RelaxedCounter numReceived;
+            RelaxedCounter numBytesReceived;
+
+            Counters()
+                    : numSent(),
+                      numBytesSent(),
+                      numReceived(),
+                      numBytesReceived()
+            {
+            }
+        };
+
+        Counters _types[SimulationStatistics::numMessageTypes];
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_STATISTICS_HPP_ */
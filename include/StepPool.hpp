@@ -0,0 +1,250 @@
+/*
+ * StepPool.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_STEPPOOL_HPP_
+#define INCLUDE_STEPPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NetOff
+{
+
+    /*! \brief Fixed set of worker threads, which run the steps of simulations.
+     *
+     * A step is identified by an id, usually the simulation id, which is passed to the step function. The thread that
+     * submits the steps collects them with waitFinished(), so it can answer every step as soon as it's done.
+     *
+     * Every worker has its own queue of tasks. Submitted steps are dealt round robin to the workers, a worker takes
+     * the newest task of its own queue and an idle worker steals the oldest task of another one. So workers with
+     * cheap steps take over the remaining steps of a worker stuck in an expensive one. An expensive step can split
+     * itself with runSubTasks(), whose sub-tasks are stolen the same way.
+     */
+    class StepPool
+    {
+     public:
+        typedef std::function<void(const int & id)> StepFunction;
+
+        typedef std::function<void(const size_t & task)> SubTaskFunction;
+
+        typedef std::function<void(const size_t & index)> ThreadFunction;
+
+        /*! \brief Starts the worker threads, at least one.
+         * \param onStart Run by every worker with its index, before it takes tasks, e.g. to pin itself to a CPU. The
+         *                constructor returns after all workers ran it.
+         */
+        StepPool(const size_t & numThreads, const StepFunction & step, const ThreadFunction & onStart = ThreadFunction());
+
+        StepPool(const StepPool &) = delete;
+
+        StepPool& operator=(const StepPool &) = delete;
+
+        /*! \brief Waits for the running steps and joins the threads. */
+        ~StepPool();
+
+        size_t getNumThreads() const;
+
+        /*! \brief Queues the step at the next worker. */
+        void submit(const int & id);
+
+        /*! \brief Returns the id of a finished step. Waits, if steps are still running.
+         *
+         * \param error Set to the exception the step function threw for this step, otherwise reset.
+         * \return Id of the step or -1, if no submitted step is left.
+         */
+        int waitFinished(std::exception_ptr & error);
+
+        /*! \brief Returns the id of a finished step without waiting or -1, if none finished yet, see
+         * waitFinished(). */
+        int tryFinished(std::exception_ptr & error);
+
+        /*! \brief Returns the number of submitted steps, which weren't returned by waitFinished() yet. */
+        size_t getNumPending() const;
+
+        /*! \brief Runs task(0) to task(numTasks - 1) and returns when all are done.
+         *
+         * Called from a step, the tasks are queued at the calling worker, so idle workers can steal them, while the
+         * caller works on them as well. Called from any other thread, the tasks are run one after another. An
+         * exception of a task is rethrown after all tasks are done.
+         */
+        static void runSubTasks(const size_t & numTasks, const SubTaskFunction & task);
+
+     private:
+        /*! Double ended queue in a ring, which only allocates when it grows beyond its largest size so far. A
+         * std::deque allocates and frees its blocks continuously while it's used as a queue. */
+        template<typename T>
+        class Ring
+        {
+         public:
+            Ring()
+                    : _slots(initialCapacity),
+                      _first(0),
+                      _num(0)
+            {
+            }
+
+            bool empty() const
+            {
+                return _num == 0;
+            }
+
+            T & front()
+            {
+                return _slots[_first];
+            }
+
+            T & back()
+            {
+                return _slots[(_first + _num - 1) & (_slots.size() - 1)];
+            }
+
+            void pushBack(const T & value)
+            {
+                if (_num == _slots.size())
+                {
+                    grow();
+                }
+                _slots[(_first + _num) & (_slots.size() - 1)] = value;
+                ++_num;
+            }
+
+            void popFront()
+            {
+                _first = (_first + 1) & (_slots.size() - 1);
+                --_num;
+            }
+
+            void popBack()
+            {
+                --_num;
+            }
+
+         private:
+            /*! A power of two, so the positions wrap with a mask. */
+            enum : size_t
+            {
+                initialCapacity = 64
+            };
+
+            std::vector<T> _slots;
+            size_t _first;
+            size_t _num;
+
+            void grow()
+            {
+                std::vector<T> slots(2 * _slots.size());
+                for (size_t i = 0; i < _num; ++i)
+                {
+                    slots[i] = _slots[(_first + i) & (_slots.size() - 1)];
+                }
+                _slots.swap(slots);
+                _first = 0;
+            }
+        };
+
+        /*! Sub-tasks of one runSubTasks() call. */
+        struct SubTaskGroup
+        {
+            const SubTaskFunction * function;
+            std::atomic<size_t> numRemaining;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+            SubTaskGroup(const SubTaskFunction * subTask, const size_t & numTasks)
+                    : function(subTask),
+                      numRemaining(numTasks),
+                      errorMutex(),
+                      error()
+            {
+            }
+
+            SubTaskGroup(const SubTaskGroup &) = delete;
+
+            SubTaskGroup & operator=(const SubTaskGroup &) = delete;
+        };
+
+        /*! A finished step and the exception of its step function, if it threw. */
+        struct Finished
+        {
+            int id;
+            std::exception_ptr error;
+
+            Finished()
+                    : id(-1),
+                      error()
+            {
+            }
+
+            Finished(const int & stepId, const std::exception_ptr & stepError)
+                    : id(stepId),
+                      error(stepError)
+            {
+            }
+        };
+
+        /*! Either a step or, if group is set, a sub-task. */
+        struct Task
+        {
+            int id;
+            SubTaskGroup * group;
+            size_t index;
+        };
+
+        struct Worker
+        {
+            std::thread thread;
+            std::mutex mutex;
+            Ring<Task> tasks;
+
+            Worker()
+                    : thread(),
+                      mutex(),
+                      tasks()
+            {
+            }
+        };
+
+        StepFunction _step;
+        ThreadFunction _onStart;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        size_t _nextWorker;
+        /*! Number of tasks in all queues, idle workers sleep while it's 0. */
+        std::atomic<size_t> _numQueued;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _workAvailable;
+        std::condition_variable _stepFinished;
+
+        Ring<Finished> _finished;
+        size_t _numPending;
+        /*! Workers, which ran _onStart. */
+        size_t _numStarted;
+        bool _stop;
+
+        void run(const size_t & index);
+
+        void push(const size_t & index, const Task & task);
+
+        /*! Takes the newest task of the own queue or steals the oldest one of another worker. */
+        bool pop(const size_t & index, Task & task);
+
+        void execute(const Task & task);
+
+        /*! Pops a finished step, the lock has to be held. */
+        int popFinished(std::exception_ptr & error);
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_STEPPOOL_HPP_ */
@@ -0,0 +1,48 @@
+/*
+ * FrameHeader.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_MESSAGES_FRAMEHEADER_HPP_
+#define INCLUDE_MESSAGES_FRAMEHEADER_HPP_
+
+#include <cstdint>
+
+namespace NetOff
+{
+    /*! \brief Prefix of every ValueContainerMessage exchanged after a simulation was added.
+     *
+     * Data structure: [ numBytes | simId | seq | flags | payload ]. The header and the payload are sent with one gather write
+     * and the receiver picks the destination buffer by simId and checks the expected size with numBytes.
+     *
+     * seq counts the frames a client sent per simulation. The server answers with the seq of the request, so the
+     * client matches pipelined outputs to its inputs without comparing times.
+     *
+     * A frame with simId allSims carries the messages of all simulations of the client in the order of their ids.
+     * These batches are counted separately by seq.
+     *
+     * Outputs the server pushes to a subscribed client aren't answers to a request. They are marked with the flag
+     * pushed and their seq is unused.
+     */
+    struct FrameHeader
+    {
+        /*! Constants are enumerators, so they can be passed by reference without a definition. */
+        enum : int
+        {
+            allSims = -1
+        };
+        enum : uint32_t
+        {
+            pushed = 1
+        };
+
+        int numBytes;
+        int simId;
+        uint32_t seq;
+        uint32_t flags;
+    };
+}
+
+#endif /* INCLUDE_MESSAGES_FRAMEHEADER_HPP_ */
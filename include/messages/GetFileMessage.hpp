@@ -10,6 +10,7 @@
 
 #include "AbstractMessage.hpp"
 #include "AdditionalTypes.hpp"
+#include "BufferPool.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
 
 #include <algorithm>
@@ -33,7 +34,7 @@ namespace NetOff
         {
             std::cout << "size: " << _dataSize << "\n";
             _dataSize = sizeof(InitialClientMessageSpecifyer) + sizeof(int) + getStringDataSize(file);
-            _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+            _data = BufferPool::allocate(_dataSize);
             _req = reinterpret_cast<InitialClientMessageSpecifyer*>(_data.get());
             char * p = saveShiftIntegralInData(InitialClientMessageSpecifyer::GET_FILE, _data.get());
             _simId = reinterpret_cast<int*>(p);
@@ -118,7 +119,7 @@ namespace NetOff
             endPos = fileStream.tellg();
 
             _dataSize = sizeof(InitialServerMessageSpecifyer) + sizeof(int) + endPos - startPos;
-            _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+            _data = BufferPool::allocate(_dataSize);
             _req = reinterpret_cast<InitialServerMessageSpecifyer*>(_data.get());
             char * p = saveShiftIntegralInData(InitialServerMessageSpecifyer::SUCCESS_GET_FILE, _data.get());
             _simId = reinterpret_cast<int*>(p);
@@ -0,0 +1,85 @@
+/*
+ * MessageArena.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_MESSAGES_MESSAGEARENA_HPP_
+#define INCLUDE_MESSAGES_MESSAGEARENA_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "BufferPool.hpp"
+#include "ValueContainerMessage.hpp"
+
+namespace NetOff
+{
+
+    /*! \brief One cache line aligned buffer holding the messages of all simulations of one direction.
+     *
+     * The messages follow each other without gaps in the order of their simulation ids, which is the layout of a batch
+     * frame. So a batch is sent or received as one span and a round over many simulations touches memory linearly.
+     */
+    template<typename Specifyer>
+    class MessageArena
+    {
+     public:
+        MessageArena()
+                : _data(),
+                  _size(0)
+        {
+        }
+
+        /*! \brief Moves the messages into a new arena. Their containers keep their addresses and values, but the
+         * pointers into the old buffers become invalid. */
+        void pack(std::vector<ValueContainerMessage<Specifyer>> & messages)
+        {
+            size_t size = 0;
+            for (const ValueContainerMessage<Specifyer> & message : messages)
+            {
+                size += message.dataSize();
+            }
+            std::shared_ptr<char> data = BufferPool::allocate(size);
+            char * p = data.get();
+            for (ValueContainerMessage<Specifyer> & message : messages)
+            {
+                message.moveTo(data, p);
+                p += message.dataSize();
+            }
+            _data = data;
+            _size = size;
+        }
+
+        /*! \brief Releases the arena, once the messages moved out of it as well. */
+        void clear()
+        {
+            _data.reset();
+            _size = 0;
+        }
+
+        /*! \brief True, if the messages weren't packed. */
+        bool empty() const
+        {
+            return _data == nullptr;
+        }
+
+        char * data()
+        {
+            return _data.get();
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+     private:
+        std::shared_ptr<char> _data;
+        size_t _size;
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_MESSAGES_MESSAGEARENA_HPP_ */
@@ -9,6 +9,7 @@
 #define INCLUDE_MESSAGES_VALUECONTAINERMESSAGE_HPP_
 
 #include "AbstractMessage.hpp"
+#include "BufferPool.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
 #include "VariableList.hpp"
 #include "ValueContainer.hpp"
@@ -33,7 +34,7 @@ namespace NetOff
             _dataSize = sizeof(Specifyer) + sizeof(int) + sizeof(double)
                     + ValueContainer::calcDataSize(vars.getReals().size(), vars.getInts().size(),
                                                    vars.getBools().size());
-            _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+            _data = BufferPool::allocate(_dataSize);
             char * p = _data.get();
             _spec = reinterpret_cast<Specifyer *>(p);
             p = saveShiftIntegralInData<Specifyer>(spec, p);
@@ -125,6 +126,23 @@ namespace NetOff
             return _dataSize;
         }
 
+        /*! \brief Copies the message to data, which belongs to the buffer arena and has room for dataSize() bytes, and
+         * uses it from now on. The container keeps its address and values. */
+        void moveTo(const std::shared_ptr<char> & arena, char * data)
+        {
+            std::copy(_data.get(), _data.get() + _dataSize, data);
+            _data = std::shared_ptr<char>(arena, data);
+            char * p = data;
+            _spec = reinterpret_cast<Specifyer *>(p);
+            p += sizeof(Specifyer);
+            _id = reinterpret_cast<int *>(p);
+            p += sizeof(int);
+            _time = reinterpret_cast<double *>(p);
+            p += sizeof(double);
+            _container = ValueContainer(_data, p, _container.sizeReal(), _container.sizeInt(), _container.sizeBool(),
+                                        *_id);
+        }
+
      private:
 
         std::shared_ptr<char> _data;
@@ -11,4 +11,5 @@
 #include "RuntimeMessage.hpp"
 #include "ValueContainerMessage.hpp"
 #include "GetFileMessage.hpp"
+#include "FrameHeader.hpp"
 
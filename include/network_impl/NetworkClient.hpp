@@ -25,6 +25,11 @@ namespace NetOff
 
         ~NetworkClient() = default;
 
+        /*! \brief Connects to the server, retrying until the connection timeout is reached.
+         *
+         * \param host Host name or IP address of the server, or "unix:/path" to connect to a Unix domain socket.
+         * \param port Port of the server, ignored for Unix domain sockets.
+         */
         bool initialize(const std::string & host, const int & port);
 
         void deinitialize() override;
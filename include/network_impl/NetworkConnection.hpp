@@ -0,0 +1,74 @@
+/*
+ * NetworkConnection.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_NETWORK_IMPL_NETWORKCONNECTION_HPP_
+#define INCLUDE_NETWORK_IMPL_NETWORKCONNECTION_HPP_
+
+#include "NetworkMember.hpp"
+
+namespace NetOff
+{
+
+    /*! \brief Server side of a connection to one client. Created by NetworkServer when a client is accepted. */
+    class NetworkConnection : public NetworkMember
+    {
+     public:
+        /*! \brief Takes ownership of the accepted socket and applies the given settings to it. */
+        NetworkConnection(const SocketHandle & socket, const ConnectionOptions & options);
+
+        NetworkConnection(const NetworkConnection &) = delete;
+
+        NetworkConnection& operator=(const NetworkConnection &) = delete;
+
+        virtual ~NetworkConnection();
+
+        /*! \brief Answers the transport offer, the first message of the client, see NetworkMember::offerSharedMemory().
+         * Waits until the offer arrived.
+         * \return False, if the connection failed.
+         */
+        bool negotiateTransport();
+
+        /*! \brief Receives the available part of the transport offer without blocking and answers it, once it's
+         * complete. A server of several clients uses it, so a client sending its offer slowly can't stall the others.
+         * \return False, if the connection failed. isNegotiated() tells, whether the offer was answered.
+         */
+        bool continueNegotiation();
+
+        bool isNegotiated() const;
+
+        /*! \brief Hands the receive side of the socket to the engine of the server, see UringEngine.
+         * \return False, if the engine can't take the connection and the socket is used directly.
+         */
+        bool attachEngine(UringEngine & engine, const int & tag);
+
+        bool isAttached() const;
+
+        /*! \brief Sends the buffers with the next batch of the engine. Without an engine they are sent immediately.
+         *
+         * The buffers are copied, except large payloads in a buffer registered at the engine.
+         * \return False, if the connection failed.
+         */
+        bool queueSend(const NetworkBuffer * parts, const int & numParts);
+
+        void deinitialize() override;
+
+        /** Returns 'S' to identify it as server. */
+        char getChar() const override;
+
+     private:
+        bool _negotiated;
+
+        /*! The received part of the transport offer. */
+        std::vector<char> _offer;
+        int _offerBytes;
+
+        bool answerOffer();
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_NETWORK_IMPL_NETWORKCONNECTION_HPP_ */
@@ -8,12 +8,81 @@
 #ifndef INCLUDE_NETWORK_IMPL_NETWORKMEMBER_HPP_
 #define INCLUDE_NETWORK_IMPL_NETWORKMEMBER_HPP_
 
+#include "NetOffConfig.hpp"
+
+#ifdef NETOFF_USE_SDL_NET
 #include <SDL_net.h>
+#endif
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "ShmChannel.hpp"
+#include "Statistics.hpp"
 
 namespace NetOff
 {
+    class UringEngine;
+
+#ifdef NETOFF_USE_SDL_NET
+    typedef TCPsocket SocketHandle;
+    typedef SDLNet_SocketSet SocketSetHandle;
+#else
+    /*! The POSIX backend works directly on file descriptors, socket sets are epoll instances. */
+    typedef int SocketHandle;
+    typedef int SocketSetHandle;
+#endif
+
+    /*! \brief One part of a gather write, see NetworkMember::sendv(). */
+    struct NetworkBuffer
+    {
+        const char * data;
+        int size;
+    };
+
+    /*! \brief How a receive waits for data, see NetworkMember::setWaitPolicy(). */
+    enum class WaitPolicy
+    {
+        /*! Sleeps in the kernel until data arrives. */
+        BLOCK,
+        /*! Polls the connection until data arrives, never sleeps. */
+        BUSY_POLL,
+        /*! Polls the connection for a while, then sleeps. */
+        SPIN_THEN_BLOCK
+    };
+
+    /*! \brief Socket settings of a connection, see the setters of NetworkMember. */
+    struct ConnectionOptions
+    {
+        int highWaterMark;
+        int connectionTimeout;
+        unsigned int initialBackoff;
+        unsigned int maxBackoff;
+
+        int sendBufferSize;
+        int recvBufferSize;
+        bool noDelay;
+
+        /*! Ring size per direction of the shared memory transport, 0 disables it. */
+        size_t sharedMemoryBytes;
+
+        WaitPolicy waitPolicy;
+        /*! Polling time of WaitPolicy::SPIN_THEN_BLOCK and the SO_BUSY_POLL budget in microseconds. */
+        int spinUs;
 
+        /*! Maximal time in milliseconds a receive waits for data, -1 waits infinitely. A server of several clients
+         * only receives from connections, that became readable, so this limits how long a client can stall in the
+         * middle of a message. */
+        int recvTimeout;
+
+        ConnectionOptions();
+    };
+
+    /*! \brief Common base of the connections of NetworkServer and NetworkClient.
+     *
+     * The socket layer is selected at build time. By default the native POSIX backend (raw file descriptors, epoll)
+     * is used, with NETOFF_USE_SDL_NET the SDL_net backend is compiled instead.
+     */
     class NetworkMember
     {
      public:
@@ -27,24 +96,197 @@ namespace NetOff
 
         bool send(const char * buffer, const int & num);
 
+        /*! \brief Sends all given buffers in order, with a single gather write if the backend supports it.
+         *
+         * \param parts     Buffers to send.
+         * \param numParts  Number of buffers.
+         * \return True, if all bytes were sent.
+         */
+        bool sendv(const NetworkBuffer * parts, const int & numParts);
+
+        /*! \brief Receives exactly num bytes.
+         *
+         * Incoming data is read ahead into an internal buffer, so a frame header and its payload are usually fetched
+         * with a single system call. Fails, if no data arrives within ConnectionOptions::recvTimeout.
+         */
         bool recv(char * buffer, const int & num);
 
+        /*! \brief Receives up to num bytes without blocking: the read ahead buffer and, if the connection is readable,
+         * one system call.
+         * \return Number of bytes received, 0 if none are available, or -1 if the connection failed.
+         */
+        int recvAvailable(char * buffer, const int & num);
+
         bool variableSend(const char * buffer, const int & num);
 
+        /*! \brief Receives a buffer sent by variableSend(). Returns an empty pointer, if the connection failed. */
         std::shared_ptr<char> variableRecv(size_t * numBytes = nullptr);
 
+        /*! \brief Waits until data can be read from the connection. Already buffered data counts as readable.
+         *
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         * \return True, if the connection is readable.
+         */
+        bool waitReadable(const int & timeoutMs);
+
+        /*! \brief Returns the socket of the connection, e.g. to integrate it into an external event loop. */
+        SocketHandle nativeHandle() const;
+
+        /*! \brief True, if recv() can be served from the read ahead buffer or the shared memory ring without
+         * touching the socket. */
+        bool hasBufferedData() const;
+
+        /*! \brief True, if the connection was switched to the shared memory transport. */
+        bool isSharedMemory() const;
+
+        /*! \brief Prepares an event loop to wait on nativeHandle(): with shared memory the peer is asked to signal its
+         * next message on the socket.
+         * \return False, if data is available already and waiting isn't necessary.
+         */
+        bool armWakeup();
+
+        /*! \brief Discards the wakeup signals of the shared memory transport from the socket.
+         * \return False, if the peer closed the connection.
+         */
+        bool drainWakeups();
+
+        /*! \brief Sets the kernel socket buffer sizes (SO_SNDBUF/SO_RCVBUF). A value of 0 keeps the system default.
+         *
+         * The sizes are applied when the connection is established, or immediately if it already is.
+         * \remark Not supported by the SDL_net backend.
+         */
+        void setSocketBufferSizes(const int & sendBytes, const int & recvBytes);
+
+        /*! \brief En-/disables Nagle's algorithm (TCP_NODELAY). Default is no delay. */
+        void setNoDelay(const bool & noDelay);
+
+        /*! \brief Limits the number of bytes submitted to or requested from one send/receive system call.
+         *
+         * By default the whole remaining buffer is passed to the kernel.
+         * \param numBytes Maximal number of bytes per call, values < 1 remove the limit.
+         */
+        void setHighWaterMark(const int & numBytes);
+
+        int getHighWaterMark() const;
+
+        /*! \brief Sets how a receive waits for data. Default is WaitPolicy::BLOCK.
+         *
+         * Polling saves the wakeup of a sleeping thread on every message at the cost of a busy core, it's meant for
+         * processes pinned to dedicated cores. Sockets are polled with non-blocking system calls and additionally
+         * get SO_BUSY_POLL, which lets the kernel poll the device queue of the network card (it may need
+         * CAP_NET_ADMIN and has no effect on the loopback device). The shared memory transport is polled without any
+         * system call.
+         * \param policy How to wait.
+         * \param spinUs Polling time of WaitPolicy::SPIN_THEN_BLOCK and the SO_BUSY_POLL budget in microseconds.
+         * \remark Not supported by the SDL_net backend and the io_uring engine, which always block.
+         */
+        void setWaitPolicy(const WaitPolicy & policy, const int & spinUs = 50);
+
+        const WaitPolicy & getWaitPolicy() const;
+
+        /*! \brief Sets how long NetworkServer::acceptConnection waits for a client and NetworkClient::initialize
+         * retries to reach the server.
+         *
+         * \param timeoutMs Deadline in milliseconds, a negative value waits infinitely. Default is 100 seconds.
+         */
+        void setConnectionTimeout(const int & timeoutMs);
+
+        /*! \brief Sets the pause between two connection attempts of a client.
+         *
+         * The first retry waits initialUs microseconds, every further retry doubles the pause up to maxUs.
+         */
+        void setRetryBackoff(const unsigned & initialUs, const unsigned & maxUs);
+
+        /*! \brief Returns the number of send/receive system calls and transferred bytes of this connection. The
+         * counters are relaxed atomics, so they can be read by any thread while the connection is used. */
+        NetworkCounters getCounters() const;
+
+        void resetCounters();
+
+        /*! \brief Replaces all socket settings at once, e.g. with the ones of a NetworkServer. */
+        void setOptions(const ConnectionOptions & options);
+
+        const ConnectionOptions & getOptions() const;
+
+        /*! \brief True, if the address names a Unix domain socket, i.e. has the form "unix:/path/to/socket". */
+        static bool isUnixSocketAddress(const std::string & address);
+
+        /*! \brief Returns the file system path of a Unix domain socket address. */
+        static std::string getUnixSocketPath(const std::string & address);
+
         virtual void deinitialize() = 0;
 
         virtual char getChar() const = 0;
 
      protected:
-        TCPsocket _socket;
+        SocketHandle _socket;
+        SocketSetHandle _socketSet;
+
+        ConnectionOptions _options;
+
+        LiveNetworkCounters _counters;
+
+        /*! Shared memory transport, replaces the socket for all data after the negotiation. */
+        std::unique_ptr<ShmChannel> _shm;
+
+        /*! Engine of the server that receives from the socket, if the connection is attached to one. */
+        UringEngine * _uring;
+        int _uringTag;
+
+        /*! Read ahead buffer of recv(), valid bytes are [_recvBegin,_recvEnd). */
+        std::vector<char> _recvBuffer;
+        size_t _recvBegin;
+        size_t _recvEnd;
+
+        /*! \brief Backend primitive: Sends as many bytes of the buffers as possible with one call.
+         *
+         * The first offset bytes of parts[0] are skipped.
+         * \return Number of bytes sent or -1 on error.
+         */
+        int sendSome(const NetworkBuffer * parts, const int & numParts, const int & offset);
+
+        /*! \brief Backend primitive: Reads available bytes into first and, if it's full, into second with one call.
+         * \return Number of bytes read, 0 if the connection was closed or -1 on error.
+         */
+        int recvSome(char * first, const int & firstNum, char * second, const int & secondNum);
+
+        /*! \brief Client side of the transport negotiation, has to be the first message on a new connection.
+         *
+         * A shared memory segment is offered to the server, which accepts it, if it runs on the same host. An empty
+         * offer is sent, if shared memory is disabled or not available.
+         * \return False, if the connection failed.
+         */
+        bool offerSharedMemory();
+
+        /*! \brief Server side of the transport negotiation, see offerSharedMemory().
+         * \param offerData The received offer of sharedMemoryOfferSize bytes.
+         */
+        bool answerSharedMemoryOffer(const char * offerData);
+
+        /*! Size of the transport offer in bytes. */
+        static const int sharedMemoryOfferSize;
+
+        /*! Backend primitive: Switches the data transfer to the negotiated shared memory channel. */
+        void useSharedMemory(std::unique_ptr<ShmChannel> && shm);
+
+        /*! Backend primitive: Signals the peer on the socket that a message is available in the ring. */
+        void sendWakeup();
+
+        void closeSharedMemory();
+
+        /*! Drops the read ahead data, needed when the underlying socket changes. */
+        void resetRecvBuffer();
+
+        /*! Applies the configured socket options to the connected socket and prepares it for waitReadable(). */
+        void applySocketOptions();
+
+        /*! Backend primitive: Polls the socket according to the wait policy, before a receive blocks on it. */
+        void spinReadable();
 
-        int _maxBuffer;
-        unsigned int _sleepTime;
-        unsigned int _numMaxSleeps;
+        /*! Polling time of the shared memory transport for the wait policy, see ShmChannel::setSpin(). */
+        int getShmSpinUs() const;
 
-        static void killSocket(TCPsocket & socket);
+        static void killSocket(SocketHandle & socket);
     };
 }
 
@@ -8,12 +8,23 @@
 #ifndef INCLUDE_NETWORK_IMPL_NETWORKSERVER_HPP_
 #define INCLUDE_NETWORK_IMPL_NETWORKSERVER_HPP_
 
-#include "NetworkMember.hpp"
+#include "NetworkConnection.hpp"
+#include "UringEngine.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace NetOff
 {
 
-    class NetworkServer : public NetworkMember
+    /*! \brief Listens on a port and manages the connections to the accepted clients.
+     *
+     * All connections and the listening socket are watched by one event set (epoll with the POSIX backend), so a
+     * single thread can serve many clients. Connections are identified by their index, which is reused after a
+     * connection was closed.
+     */
+    class NetworkServer
     {
      public:
         NetworkServer();
@@ -24,15 +35,130 @@ namespace NetOff
 
         virtual ~NetworkServer();
 
-        bool initialize(const int & port);
+        /*! \brief Opens the listening socket.
+         *
+         * \param port          Port to listen on.
+         * \param maxClients    Maximal number of concurrent connections. Further clients wait in the backlog until a
+         *                      connection is closed.
+         */
+        bool initialize(const int & port, const size_t & maxClients = 1);
+
+        /*! \brief Opens a listening Unix domain socket at the given path, which is removed again when the server stops
+         * listening. A stale socket file of a crashed server is replaced.
+         * \remark Not supported by the SDL_net backend.
+         */
+        bool initialize(const std::string & socketPath, const size_t & maxClients = 1);
+
+        /*! \brief Blocks until a client connects, at most for the connection timeout of the options.
+         * \return Id of the new connection or -1.
+         */
+        int acceptConnection();
+
+        /*! \brief Waits until one of the connections has incoming data or was closed by its client. New clients are
+         * accepted meanwhile.
+         *
+         * Connections with buffered data are served first and ready connections are returned in turn, so a busy
+         * client can't starve the others.
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         * \return Id of the connection or -1 on timeout.
+         */
+        int waitForData(const int & timeoutMs = -1);
+
+        /*! \brief Closes the listening socket. Established connections are kept, new clients are refused. */
+        void stopListening();
+
+        bool isListening() const;
+
+        NetworkConnection & getConnection(const int & id);
+
+        const NetworkConnection & getConnection(const int & id) const;
+
+        bool isConnected(const int & id) const;
+
+        /*! \brief Closes the connection and frees its id. */
+        void closeConnection(const int & id);
+
+        /*! \brief Returns the number of open connections. */
+        size_t getNumConnections() const;
+
+        /*! \brief Returns the number of ids, i.e. every valid connection id is smaller. */
+        size_t getConnectionIdBound() const;
+
+        /*! \brief Sets the socket settings of all open and future connections. */
+        void setOptions(const ConnectionOptions & options);
+
+        const ConnectionOptions & getOptions() const;
+
+        /*! \brief Returns the summed traffic of all connections since the last reset. */
+        NetworkCounters getCounters() const;
 
-        void deinitialize() override;
+        void resetCounters();
 
-        /** Returns 'S' to identify it as server. */
-        char getChar() const override;
+        /*! \brief Serves the socket connections with an io_uring engine instead of the event set, see UringEngine.
+         *
+         * Messages passed to NetworkConnection::queueSend() are then collected and sent as one batch, before the server
+         * waits for incoming data. Has to be called before initialize(). If io_uring isn't available, the event set
+         * and immediate sends are used.
+         */
+        void setIoUring(const bool & enable);
+
+        /*! \brief True, if the io_uring engine is running. */
+        bool isIoUringActive() const;
+
+        /*! \brief Registers memory, that holds outgoing messages, at the engine, so large payloads are sent without
+         * copying them. Has to be released with unregisterBuffer() before the memory is freed.
+         * \return Index of the buffer or -1, if there is no engine or the memory couldn't be registered.
+         */
+        int registerBuffer(const char * data, const size_t & size);
+
+        void unregisterBuffer(const int & index);
+
+        /*! \brief Sends the queued messages, if one of them refers to the registered buffer, so it can be changed. */
+        void syncBuffer(const int & index);
+
+        /*! \brief Sends all queued messages. */
+        void flush();
+
+        /*! \brief Closes all connections and the listening socket. */
+        void deinitialize();
 
      private:
-        TCPsocket _tcpsock;
+        SocketHandle _listenSocket;
+        std::string _socketPath;
+        SocketSetHandle _socketSet;
+        bool _listenerWatched;
+        size_t _maxConnections;
+        size_t _nextBuffered;
+
+        ConnectionOptions _options;
+        NetworkCounters _closedCounters;
+        std::vector<std::unique_ptr<NetworkConnection>> _connections;
+
+        bool _useUring;
+        std::unique_ptr<UringEngine> _uring;
+        /*! The engine reported the event set as readable and not all of its events were handled yet. */
+        bool _eventSetReady;
+
+        /*! Accepts a pending client and returns its connection id or -1. */
+        int acceptPending();
+
+        /*! Returns the next connection round robin, whose data is buffered or in its shared memory ring, or -1. */
+        int takeBuffered();
+
+        /*! Adds the connection to the event set of the server. */
+        void watchConnection(const int & id);
+
+        /*! Keeps the traffic of a closed connection for getCounters(). */
+        void addClosedCounters(const NetworkCounters & counters);
+
+        /*! Adds or removes the listening socket from the event set, depending on the free connection slots. */
+        void updateListener();
+
+        /*! Starts the engine, if it's enabled. Returns true, if it was started now. */
+        bool startEngine();
+
+        /*! Moves a negotiated connection from the event set to the engine, if it's running. */
+        void attachConnection(const int & id);
     };
 
 } /* namespace NetOff */
@@ -0,0 +1,82 @@
+/*
+ * RealTime.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_NETWORK_IMPL_REALTIME_HPP_
+#define INCLUDE_NETWORK_IMPL_REALTIME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace NetOff
+{
+
+    /*! \brief Settings of a real-time deployment, which are applied when the simulations start.
+     *
+     * Locking and SCHED_FIFO usually need privileges (CAP_IPC_LOCK, CAP_SYS_NICE or matching rlimits), failures are
+     * reported by RealTimeReport instead of thrown.
+     */
+    struct RealTimeProfile
+    {
+        /*! Pre-faults and locks the message buffers and locks all current and future memory with mlockall(). */
+        bool lockMemory;
+        /*! CPUs the thread calling start() runs on, empty keeps the affinity. */
+        std::vector<int> networkCpus;
+        /*! CPUs of the step workers, worker i runs on workerCpus[i % workerCpus.size()]. Empty keeps the affinity. */
+        std::vector<int> workerCpus;
+        /*! SCHED_FIFO priorities from 1 to 99, 0 keeps the default scheduler. */
+        int networkPriority;
+        int workerPriority;
+
+        RealTimeProfile();
+
+        /*! True, if any setting differs from the default. */
+        bool isEnabled() const;
+    };
+
+    /*! \brief Outcome of a RealTimeProfile. The flags are true, if the setting was requested and succeeded. */
+    struct RealTimeReport
+    {
+        bool memoryLocked;
+        bool threadsPinned;
+        bool prioritiesSet;
+        /*! Page faults of the process since the start. */
+        uint64_t numPageFaults;
+        /*! Bytes the allocated heap grew since the start. Allocations freed before the report aren't seen, counting
+         * them needs a hook of malloc. */
+        int64_t heapGrowth;
+
+        RealTimeReport();
+    };
+
+    /*! \brief Counters of the process, whose differences are reported by RealTimeReport. */
+    struct ResourceUsage
+    {
+        uint64_t numPageFaults;
+        uint64_t heapBytes;
+    };
+
+    ResourceUsage getResourceUsage();
+
+    /*! \brief Touches every page of the buffer and locks it in memory. Returns false, if it couldn't be locked. */
+    bool lockBuffer(const char * data, const size_t & size);
+
+    /*! \brief Locks all current and future pages of the process with mlockall(). */
+    bool lockAllMemory();
+
+    /*! \brief Touches the stack of the calling thread, so the first deep call after the start doesn't fault. */
+    void prefaultStack();
+
+    /*! \brief Restricts the calling thread to the CPUs. */
+    bool pinCurrentThread(const std::vector<int> & cpus);
+
+    /*! \brief Schedules the calling thread with SCHED_FIFO and the priority. */
+    bool setCurrentThreadPriority(const int & priority);
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_NETWORK_IMPL_REALTIME_HPP_ */
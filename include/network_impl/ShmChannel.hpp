@@ -0,0 +1,136 @@
+/*
+ * ShmChannel.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_NETWORK_IMPL_SHMCHANNEL_HPP_
+#define INCLUDE_NETWORK_IMPL_SHMCHANNEL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace NetOff
+{
+    struct NetworkBuffer;
+
+    /*! \brief Byte stream between two processes of the same host over a POSIX shared memory segment.
+     *
+     * The segment holds one single producer/single consumer ring per direction. Readers and writers only block, if
+     * their ring is empty or full respectively, and are woken by a futex doorbell in the segment. The creator of the
+     * segment (the client) writes the first ring and reads the second one, the other side vice versa.
+     *
+     * The socket of the connection stays open next to the channel: it detects a crashed peer and wakes an event loop
+     * of the reader, see requestWakeup().
+     */
+    class ShmChannel
+    {
+     public:
+        ShmChannel();
+
+        ShmChannel(const ShmChannel &) = delete;
+
+        ShmChannel& operator=(const ShmChannel &) = delete;
+
+        ~ShmChannel();
+
+        /*! \brief Creates and maps a new segment with rings of ringBytes each. */
+        bool create(const size_t & ringBytes);
+
+        /*! \brief Maps the segment the peer created. The token has to match the one written by the creator and the
+         * size of a ring has to be a power of two. */
+        bool open(const std::string & name, const uint64_t & token, const size_t & ringBytes);
+
+        /*! \brief Removes the name of the segment. The mappings of both sides stay valid. */
+        void unlink();
+
+        /*! \brief Notifies the peer and unmaps the segment. */
+        void close();
+
+        bool isOpen() const;
+
+        const std::string & getName() const;
+
+        uint64_t getToken() const;
+
+        /*! \brief Returns the size of one ring, create() rounds the requested size up to a power of two. */
+        size_t getRingBytes() const;
+
+        /*! \brief Sets the socket that is checked for a closed connection while waiting for the peer. */
+        void setPeerSocket(const int & socket);
+
+        /*! \brief Sets how long a reader polls the incoming ring before it sleeps on the futex.
+         * \param spinUs Polling time in microseconds, 0 sleeps right away and -1 polls only.
+         */
+        void setSpin(const int & spinUs);
+
+        /*! \brief Copies as many bytes of the buffers into the outgoing ring as fit, waits if the ring is full.
+         *
+         * The first offset bytes of parts[0] are skipped and at most maxBytes are written.
+         * \return Number of bytes written or -1, if the peer is gone.
+         */
+        int write(const NetworkBuffer * parts, const int & numParts, const int & offset, const int & maxBytes);
+
+        /*! \brief Reads the available bytes into first and, if it's full, into second. Waits, if the ring is empty.
+         * \return Number of bytes read or 0, if the peer is gone or its end of the ring is broken.
+         */
+        int read(char * first, const int & firstNum, char * second, const int & secondNum);
+
+        /*! \brief Waits until the incoming ring holds data.
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         */
+        bool waitData(const int & timeoutMs);
+
+        bool hasData() const;
+
+        /*! \brief Asks the peer to also signal its next write on the socket, so the data is seen by an event loop
+         * that waits on the socket.
+         * \return False, if data is available already and waiting isn't necessary.
+         */
+        bool requestWakeup();
+
+        /*! \brief Returns true once after the peer requested a wakeup. The caller has to signal the socket. */
+        bool takeWakeupRequest();
+
+     private:
+        struct Ring;
+        struct Segment;
+
+        Segment * _segment;
+        size_t _mappedBytes;
+        /*! Size of a ring. The copy in the segment can be changed by the peer, so it's only read once. */
+        size_t _ringBytes;
+        std::string _name;
+        int _peerSocket;
+        int _spinUs;
+
+        /*! 0 for the creator, 1 for the other side. */
+        int _side;
+
+        /*! Offset of the ring data behind the header. */
+        static size_t dataOffset();
+
+        Ring & outRing() const;
+
+        Ring & inRing() const;
+
+        char * ringData(const int & ringId) const;
+
+        /*! Polls the incoming ring for at most spinUs or, if it's negative, until timeoutMs. Returns true, if data
+         * arrived. */
+        bool spinData(const int & spinUs, const int & timeoutMs);
+
+        /*! Waits until the value of the futex word changes, at most timeoutMs. Returns false on timeout. */
+        bool waitFor(std::atomic<uint32_t> & word, const uint32_t & value, const int & timeoutMs);
+
+        void wake(std::atomic<uint32_t> & word);
+
+        bool isPeerAlive() const;
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_NETWORK_IMPL_SHMCHANNEL_HPP_ */
@@ -0,0 +1,201 @@
+/*
+ * UringEngine.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#ifndef INCLUDE_NETWORK_IMPL_URINGENGINE_HPP_
+#define INCLUDE_NETWORK_IMPL_URINGENGINE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "NetworkMember.hpp"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace NetOff
+{
+
+    /*! \brief Batched socket I/O of a NetworkServer over one io_uring instance.
+     *
+     * Every attached connection keeps a multishot receive posted, which fills a ring of provided buffers. The data is
+     * moved to a per connection queue, so receiving doesn't need a system call as long as data is queued.
+     *
+     * Outgoing frames are queued and leave with one io_uring_enter() for all connections, as soon as the server would
+     * wait for incoming data or flush() is called. The frames of one connection are linked, so they leave in order.
+     * Large payloads inside registered buffers (see registerBuffer()) are sent zero copy from that memory, all other
+     * bytes are copied into a staging buffer of the connection when they are queued.
+     *
+     * Connections are identified by a tag, the connection id of the NetworkServer. The engine is only available with
+     * the POSIX backend on Linux 6.0 or newer, initialize() fails otherwise.
+     */
+    class UringEngine
+    {
+     public:
+        /*! Returned by waitForEvent(), if the descriptor given to watchPoll() became readable. */
+        static const int pollTag = -2;
+
+        UringEngine();
+
+        UringEngine(const UringEngine &) = delete;
+
+        UringEngine& operator=(const UringEngine &) = delete;
+
+        ~UringEngine();
+
+        /*! \brief Sets up the rings. Returns false, if io_uring or one of the needed features isn't available. */
+        bool initialize(const unsigned & entries);
+
+        /*! \brief Cancels all requests and releases the rings. */
+        void close();
+
+        bool isActive() const;
+
+        /*! \brief Watches an additional descriptor, e.g. an epoll instance, see waitForEvent(). */
+        bool watchPoll(const int & fd);
+
+        /*! \brief Posts the multishot receive of the socket. The socket must not be read otherwise afterwards. */
+        bool addConnection(const int & tag, const SocketHandle & socket);
+
+        /*! \brief Sends the queued frames and cancels the receive of the connection. */
+        void removeConnection(const int & tag);
+
+        /*! \brief True, if data is queued for the connection or it was closed, i.e. recv() won't block. */
+        bool isReadable(const int & tag) const;
+
+        /*! \brief Reads queued data of the connection into first and, if it's full, into second. Waits, if no data is
+         * queued. Queued frames are sent before waiting.
+         * \return Number of bytes read, 0 if the connection was closed or -1 on error.
+         */
+        int recv(const int & tag, char * first, const int & firstNum, char * second, const int & secondNum);
+
+        /*! \brief Waits until the connection is readable, see isReadable(). Queued frames are sent before waiting.
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         */
+        bool waitData(const int & tag, const int & timeoutMs);
+
+        /*! \brief Sends the queued frames and waits until a connection received data or was closed.
+         * \param timeoutMs Maximal time to wait in milliseconds, -1 waits infinitely.
+         * \return Tag of the connection, pollTag or -1 on timeout.
+         */
+        int waitForEvent(const int & timeoutMs);
+
+        /*! \brief Registers the memory as fixed buffer, so payloads inside it are sent without copying them.
+         *
+         * The memory of a queued payload must not be changed until it's sent, see isBufferQueued().
+         * \return Index of the buffer or -1, if it couldn't be registered.
+         */
+        int registerBuffer(const char * data, const size_t & size);
+
+        /*! \brief Releases a buffer of registerBuffer(). Has to be called before its memory is freed. */
+        void unregisterBuffer(const int & index);
+
+        /*! \brief True, if a queued frame refers to the memory of the registered buffer. */
+        bool isBufferQueued(const int & index) const;
+
+        /*! \brief Queues the buffers for the next batch of the connection. */
+        void queueSend(const int & tag, const NetworkBuffer * parts, const int & numParts);
+
+        bool hasQueuedSends() const;
+
+        /*! \brief Submits all queued frames with one system call and waits until they are sent.
+         *
+         * A connection, that fails to send, is reported as closed by isReadable() and recv().
+         */
+        void flush();
+
+     private:
+        /*! Part of a queued frame, either referring to registered memory or to the staging buffer. */
+        struct QueuedPart
+        {
+            const char * data;
+            size_t stagingOffset;
+            int size;
+            int bufferIndex;
+        };
+
+        struct Connection
+        {
+            SocketHandle socket;
+            uint16_t generation;
+            bool active;
+            bool closed;
+            bool zeroCopy;
+
+            /*! Received data, valid bytes are [pendingBegin, pending.size()). */
+            std::vector<char> pending;
+            size_t pendingBegin;
+
+            std::vector<char> staging;
+            std::vector<QueuedPart> queued;
+
+            Connection();
+        };
+
+        /*! Submitted send request of a flush(). */
+        struct SendOp
+        {
+            int tag;
+            const char * data;
+            int size;
+            int result;
+            bool zeroCopy;
+        };
+
+        struct RegisteredBuffer
+        {
+            const char * data;
+            size_t size;
+            size_t queuedRefs;
+        };
+
+        struct Rings;
+
+        int _ringFd;
+        Rings * _rings;
+
+        std::vector<Connection> _connections;
+        std::vector<int> _queuedTags;
+        std::vector<SendOp> _sendOps;
+        size_t _sendsInFlight;
+
+        std::vector<RegisteredBuffer> _registered;
+        /*! Start address to index of the registered buffers. */
+        std::map<const char *, int> _registeredByAddress;
+
+        int _pollFd;
+        bool _pollReady;
+
+        /*! Returns the next free submission entry, submits the prepared ones if the queue is full. */
+        io_uring_sqe * prepareSqe();
+
+        void handleCompletion(const io_uring_cqe & cqe);
+
+        bool postRecv(const int & tag);
+
+        bool postPoll();
+
+        /*! Builds the send requests of one connection, falls back to blocking sends if they don't fit. */
+        void submitQueued(const int & tag);
+
+        /*! Sends what the requests of a connection left over with blocking system calls. */
+        void completeSends(const int & tag, const size_t & firstOp, const size_t & endOp);
+
+        /*! Processes all available completions. */
+        void reap();
+
+        /*! Submits the prepared requests and waits for at most timeoutMs until minComplete completions arrived.
+         * Returns false on timeout or error. */
+        bool enter(const unsigned & minComplete, const int & timeoutMs);
+
+        int findRegistered(const char * data, const int & size) const;
+    };
+
+} /* namespace NetOff */
+
+#endif /* INCLUDE_NETWORK_IMPL_URINGENGINE_HPP_ */
@@ -0,0 +1,348 @@
+/*
+ * AsyncSimulationClient.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "AsyncSimulationClient.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace NetOff
+{
+
+    AsyncSimulationClient::AsyncSimulationClient(SimulationClient & client, const size_t & queueCapacity)
+            : _client(client),
+              _requests(queueCapacity),
+              _completions(queueCapacity),
+              _numCallbacks(0),
+              _maxCallbacks(std::max(queueCapacity, static_cast<size_t>(1))),
+              _ioThread(),
+              _stop(false),
+              _sleeping(false),
+              _mutex(),
+              _wakeup(),
+              _awaited(),
+              _unclaimed(),
+              _numAwaited(0)
+    {
+        if (!_client.isStarted())
+        {
+            throw std::runtime_error("AsyncSimulationClient: The client has to be started.");
+        }
+        _ioThread = std::thread(&AsyncSimulationClient::run, this);
+    }
+
+    AsyncSimulationClient::~AsyncSimulationClient()
+    {
+        _stop = true;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _wakeup.notify_one();
+        }
+        _ioThread.join();
+    }
+
+    std::future<bool> AsyncSimulationClient::sendInputValuesAsync(const int & simId, const double & time,
+                                                                  StepValues inputs)
+    {
+        Request request;
+        request.type = RequestType::SEND;
+        request.simId = simId;
+        request.time = time;
+        request.inputs = std::move(inputs);
+        std::future<bool> res = request.sent.get_future();
+        push(std::move(request));
+        return res;
+    }
+
+    void AsyncSimulationClient::sendInputValuesAsync(const int & simId, const double & time,
+                                                     StepValues inputs, const SendCallback & callback)
+    {
+        Request request;
+        request.type = RequestType::SEND;
+        request.simId = simId;
+        request.time = time;
+        request.inputs = std::move(inputs);
+        request.sendCallback = callback;
+        reserveCompletion();
+        push(std::move(request));
+    }
+
+    std::future<StepValues> AsyncSimulationClient::recvOutputValuesAsync(const int & simId, const double & time)
+    {
+        Request request;
+        request.type = RequestType::RECV;
+        request.simId = simId;
+        request.time = time;
+        std::future<StepValues> res = request.outputs.get_future();
+        push(std::move(request));
+        return res;
+    }
+
+    void AsyncSimulationClient::recvOutputValuesAsync(const int & simId, const double & time,
+                                                      const RecvCallback & callback)
+    {
+        Request request;
+        request.type = RequestType::RECV;
+        request.simId = simId;
+        request.time = time;
+        request.recvCallback = callback;
+        reserveCompletion();
+        push(std::move(request));
+    }
+
+    size_t AsyncSimulationClient::processCompletions()
+    {
+        size_t res = 0;
+        Completion completion;
+        while (_completions.pop(completion))
+        {
+            --_numCallbacks;
+            if (completion.error)
+            {
+                std::rethrow_exception(completion.error);
+            }
+            if (completion.sendCallback)
+            {
+                completion.sendCallback(completion.sent);
+            }
+            else
+            {
+                completion.recvCallback(completion.outputs);
+            }
+            ++res;
+        }
+        return res;
+    }
+
+    void AsyncSimulationClient::push(Request && request)
+    {
+        // a full queue drains as fast as the I/O thread sends
+        while (!_requests.push(std::move(request)))
+        {
+            std::this_thread::yield();
+        }
+        // pairs with the fence of the I/O thread before it checks the queue and goes to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleeping.load())
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _wakeup.notify_one();
+        }
+    }
+
+    void AsyncSimulationClient::reserveCompletion()
+    {
+        // the completion queue holds at least _maxCallbacks, so the I/O thread never waits for the caller
+        if (_numCallbacks >= _maxCallbacks)
+        {
+            throw std::runtime_error("AsyncSimulationClient: Too many callbacks didn't run yet, call "
+                                     "processCompletions().");
+        }
+        ++_numCallbacks;
+    }
+
+    void AsyncSimulationClient::run()
+    {
+        Request request;
+        while (true)
+        {
+            while (_requests.pop(request))
+            {
+                handle(request);
+            }
+            if (_numAwaited > 0)
+            {
+                receiveOutputs();
+                continue;
+            }
+            if (_stop)
+            {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(_mutex);
+            _sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (_requests.empty() && !_stop)
+            {
+                _wakeup.wait(lock);
+            }
+            _sleeping = false;
+        }
+    }
+
+    void AsyncSimulationClient::handle(Request & request)
+    {
+        if (request.type == RequestType::SEND)
+        {
+            bool sent = false;
+            std::exception_ptr error;
+            try
+            {
+                ValueContainer & inputs = _client.getInputValueContainer(request.simId);
+                if (request.inputs.reals.size() != inputs.sizeReal() || request.inputs.ints.size() != inputs.sizeInt()
+                        || request.inputs.bools.size() != inputs.sizeBool())
+                {
+                    throw std::runtime_error("AsyncSimulationClient: The number of input values doesn't match the "
+                                             "simulation " + std::to_string(request.simId) + ".");
+                }
+                inputs.setRealValues(request.inputs.reals.data());
+                inputs.setIntValues(request.inputs.ints.data());
+                inputs.setBoolValues(request.inputs.bools.data());
+                sent = _client.sendInputValues(request.simId, request.time, inputs);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            completeSend(request, sent, error);
+            return;
+        }
+
+        size_t numPending = 0;
+        try
+        {
+            numPending = _client.getNumPendingSteps(request.simId);
+        }
+        catch (...)
+        {
+            completeRecv(request, StepValues(), std::current_exception());
+            return;
+        }
+        if (static_cast<size_t>(request.simId) >= _awaited.size())
+        {
+            _awaited.resize(request.simId + 1);
+            _unclaimed.resize(request.simId + 1);
+        }
+        if (!_unclaimed[request.simId].empty())
+        {
+            StepValues outputs = std::move(_unclaimed[request.simId].front());
+            _unclaimed[request.simId].pop_front();
+            completeRecv(request, std::move(outputs), nullptr);
+            return;
+        }
+        if (_awaited[request.simId].size() >= numPending)
+        {
+            completeRecv(request, StepValues(), std::make_exception_ptr(
+                    std::runtime_error("AsyncSimulationClient: No outputs pending, sendInputValuesAsync() wasn't called.")));
+            return;
+        }
+        _awaited[request.simId].push_back(std::move(request));
+        ++_numAwaited;
+    }
+
+    void AsyncSimulationClient::receiveOutputs()
+    {
+        int simId = -1;
+        std::exception_ptr error;
+        try
+        {
+            simId = _client.recvAnyOutput();
+            if (simId < 0)
+            {
+                throw std::runtime_error("AsyncSimulationClient: The connection to the server was lost.");
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        if (error)
+        {
+            // the awaited outputs will never arrive
+            for (std::list<Request> & awaited : _awaited)
+            {
+                for (Request & request : awaited)
+                {
+                    completeRecv(request, StepValues(), error);
+                }
+                awaited.clear();
+            }
+            _numAwaited = 0;
+            return;
+        }
+
+        if (static_cast<size_t>(simId) >= _awaited.size())
+        {
+            _awaited.resize(simId + 1);
+            _unclaimed.resize(simId + 1);
+        }
+        if (_awaited[simId].empty())
+        {
+            _unclaimed[simId].push_back(copyOutputs(simId));
+            return;
+        }
+        completeRecv(_awaited[simId].front(), copyOutputs(simId), nullptr);
+        _awaited[simId].pop_front();
+        --_numAwaited;
+    }
+
+    void AsyncSimulationClient::completeSend(Request & request, const bool & sent, const std::exception_ptr & error)
+    {
+        if (!request.sendCallback)
+        {
+            if (error)
+            {
+                request.sent.set_exception(error);
+            }
+            else
+            {
+                request.sent.set_value(sent);
+            }
+            return;
+        }
+        Completion completion;
+        completion.sendCallback = std::move(request.sendCallback);
+        completion.sent = sent;
+        completion.error = error;
+        pushCompletion(std::move(completion));
+    }
+
+    void AsyncSimulationClient::completeRecv(Request & request, StepValues && outputs,
+                                             const std::exception_ptr & error)
+    {
+        if (!request.recvCallback)
+        {
+            if (error)
+            {
+                request.outputs.set_exception(error);
+            }
+            else
+            {
+                request.outputs.set_value(std::move(outputs));
+            }
+            return;
+        }
+        Completion completion;
+        completion.recvCallback = std::move(request.recvCallback);
+        completion.outputs = std::move(outputs);
+        completion.error = error;
+        pushCompletion(std::move(completion));
+    }
+
+    void AsyncSimulationClient::pushCompletion(Completion && completion)
+    {
+        // a slot was reserved with the request, so the queue is never full here
+        while (!_completions.push(std::move(completion)))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    StepValues AsyncSimulationClient::copyOutputs(const int & simId)
+    {
+        const ValueContainer & container = _client.getOutputValueContainer(simId);
+        StepValues res;
+        res.simId = simId;
+        res.time = _client.getOutputTime(simId);
+        res.reals.assign(container.getRealValues(), container.getRealValues() + container.sizeReal());
+        res.ints.assign(container.getIntValues(), container.getIntValues() + container.sizeInt());
+        res.bools.assign(container.getBoolValues(), container.getBoolValues() + container.sizeBool());
+        return res;
+    }
+
+} /* namespace NetOff */
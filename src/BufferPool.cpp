@@ -0,0 +1,211 @@
+/*
+ * BufferPool.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "BufferPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace NetOff
+{
+
+    namespace
+    {
+        /*! Size classes from 64 bytes to 4 GiB, larger buffers aren't pooled. */
+        const size_t numClasses = 27;
+
+        /*! Free bytes a size class keeps at most, but at least minFreeBlocks buffers. */
+        const size_t maxFreeBytes = 16 << 20;
+
+        const size_t minFreeBlocks = 2;
+
+        /*! Precedes every buffer and fills a cache line, so the buffer is aligned as well. */
+        struct BlockHeader
+        {
+            /*! Start of the heap allocation. */
+            void * raw;
+            /*! Next free block of the class, while the block is free. */
+            BlockHeader * next;
+            /*! Size class or numClasses, if the block isn't pooled. */
+            size_t sizeClass;
+        };
+
+        static_assert(sizeof(BlockHeader) <= BufferPool::alignment, "BlockHeader has to fit in a cache line.");
+
+        struct SizeClass
+        {
+            std::mutex mutex;
+            BlockHeader * free;
+            size_t numFree;
+
+            SizeClass()
+                    : mutex(),
+                      free(nullptr),
+                      numFree(0)
+            {
+            }
+        };
+
+        struct Pool
+        {
+            SizeClass classes[numClasses];
+            std::atomic<size_t> numAllocated;
+            std::atomic<size_t> numReused;
+            std::atomic<size_t> numFreeBytes;
+
+            Pool()
+                    : classes(),
+                      numAllocated(0),
+                      numReused(0),
+                      numFreeBytes(0)
+            {
+            }
+        };
+
+        /*! Never destroyed, so buffers can still be released by destructors of static objects. */
+        Pool & pool()
+        {
+            static Pool * res = new Pool();
+            return *res;
+        }
+
+        size_t classBytes(const size_t & sizeClass)
+        {
+            return static_cast<size_t>(BufferPool::alignment) << sizeClass;
+        }
+
+        size_t sizeClassOf(const size_t & size)
+        {
+            size_t res = 0;
+            while (res < numClasses && classBytes(res) < size)
+            {
+                ++res;
+            }
+            return res;
+        }
+
+        BlockHeader * allocateBlock(const size_t & bytes, const size_t & sizeClass)
+        {
+            // one cache line for the header and up to one to align it
+            void * raw = ::operator new(bytes + 2 * BufferPool::alignment);
+            const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + BufferPool::alignment - 1)
+                    & ~static_cast<uintptr_t>(BufferPool::alignment - 1);
+            BlockHeader * block = reinterpret_cast<BlockHeader *>(aligned);
+            block->raw = raw;
+            block->next = nullptr;
+            block->sizeClass = sizeClass;
+            return block;
+        }
+
+        char * payloadOf(BlockHeader * block)
+        {
+            return reinterpret_cast<char *>(block) + BufferPool::alignment;
+        }
+
+        BlockHeader * blockOf(char * data)
+        {
+            return reinterpret_cast<BlockHeader *>(data - BufferPool::alignment);
+        }
+
+        /*! Returns the buffers to the pool. */
+        struct Release
+        {
+            void operator()(char * data) const
+            {
+                BufferPool::deallocate(data);
+            }
+        };
+    }
+
+    std::shared_ptr<char> BufferPool::allocate(const size_t & size)
+    {
+        return std::shared_ptr<char>(allocateRaw(size), Release(), Allocator<char>());
+    }
+
+    char * BufferPool::allocateRaw(const size_t & size)
+    {
+        Pool & p = pool();
+        const size_t sizeClass = sizeClassOf(std::max(size, static_cast<size_t>(1)));
+        if (sizeClass == numClasses)
+        {
+            ++p.numAllocated;
+            return payloadOf(allocateBlock(size, numClasses));
+        }
+        SizeClass & c = p.classes[sizeClass];
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            if (c.free != nullptr)
+            {
+                BlockHeader * block = c.free;
+                c.free = block->next;
+                --c.numFree;
+                ++p.numReused;
+                p.numFreeBytes -= classBytes(sizeClass);
+                return payloadOf(block);
+            }
+        }
+        ++p.numAllocated;
+        return payloadOf(allocateBlock(classBytes(sizeClass), sizeClass));
+    }
+
+    void BufferPool::deallocate(char * data)
+    {
+        if (data == nullptr)
+        {
+            return;
+        }
+        Pool & p = pool();
+        BlockHeader * block = blockOf(data);
+        if (block->sizeClass < numClasses)
+        {
+            const size_t bytes = classBytes(block->sizeClass);
+            SizeClass & c = p.classes[block->sizeClass];
+            std::lock_guard<std::mutex> lock(c.mutex);
+            if (c.numFree < std::max(minFreeBlocks, maxFreeBytes / bytes))
+            {
+                block->next = c.free;
+                c.free = block;
+                ++c.numFree;
+                p.numFreeBytes += bytes;
+                return;
+            }
+        }
+        ::operator delete(block->raw);
+    }
+
+    BufferPool::Statistics BufferPool::getStatistics()
+    {
+        Pool & p = pool();
+        Statistics res;
+        res.numAllocated = p.numAllocated.load();
+        res.numReused = p.numReused.load();
+        res.numFreeBytes = p.numFreeBytes.load();
+        return res;
+    }
+
+    void BufferPool::trim()
+    {
+        Pool & p = pool();
+        for (size_t i = 0; i < numClasses; ++i)
+        {
+            SizeClass & c = p.classes[i];
+            std::lock_guard<std::mutex> lock(c.mutex);
+            while (c.free != nullptr)
+            {
+                BlockHeader * block = c.free;
+                c.free = block->next;
+                p.numFreeBytes -= classBytes(i);
+                ::operator delete(block->raw);
+            }
+            c.numFree = 0;
+        }
+    }
+
+} /* namespace NetOff */
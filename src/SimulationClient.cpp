@@ -8,6 +8,7 @@
 #include "SimulationClient.hpp"
 #include "messages/messages.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
+#include <algorithm>
 #include <stdexcept>
 
 namespace NetOff
@@ -30,7 +31,40 @@ namespace NetOff
               _selectedOutputVarNames(),
               _isInitialized(),
               _inputMessages(),
-              _outputMessages()
+              _outputMessages(),
+              _inputArena(),
+              _outputArena(),
+              _pipelineDepth(0),
+              _sendSeq(),
+              _recvSeq(),
+              _batchSendSeq(0),
+              _batchRecvSeq(0),
+              _isSubscribed(),
+              _numPushed(),
+              _numPolled(),
+              _hasHeldAnswer(false),
+              _heldAnswer(),
+              _earlyAnswers(),
+              _earlyOrder(),
+              _earlyBegin(0),
+              _numEarly(0),
+              _partialFrame(),
+              _realTimeProfile(),
+              _realTimeReport(),
+              _startUsage(),
+              _traffic(),
+              _stepLatencies(),
+              _batchLatency(),
+              _sendStamps(),
+              _batchSendStamps(numSendStamps, SendStamp())
+    {
+    }
+
+    SimulationClient::EarlyAnswers::EarlyAnswers()
+            : headers(),
+              payloads(),
+              first(0),
+              num(0)
     {
     }
 
@@ -41,7 +75,7 @@ namespace NetOff
 
     bool SimulationClient::initializeConnection()
     {
-        if (_port < 1 || _hostAddress.size() < 1)
+        if ((_port < 1 && !NetworkMember::isUnixSocketAddress(_hostAddress)) || _hostAddress.size() < 1)
         {
             std::cout << "SimulationClient: Port or host address wasn't set.\n";
             return false;
@@ -65,7 +99,7 @@ namespace NetOff
         _currentState = CurrentState::NONE;
 
         _inputMessages[0].setSpecifyer(ClientMessageSpecifyer::CLIENT_ABORT);
-        send(0);
+        send(0, false);
         _netClient.deinitialize();
     }
 
@@ -95,7 +129,15 @@ namespace NetOff
 
         _inputMessages.resize(simId + 1);
         _outputMessages.resize(simId + 1);
+        _sendSeq.resize(simId + 1, 0);
+        _recvSeq.resize(simId + 1, 0);
+        _isSubscribed.resize(simId + 1, false);
+        _numPushed.resize(simId + 1, 0);
+        _numPolled.resize(simId + 1, 0);
+        _earlyAnswers.resize(simId + 1);
         _isInitialized.resize(simId + 1, false);
+        _stepLatencies.push_back(std::unique_ptr<LatencyHistogram>(new LatencyHistogram()));
+        _sendStamps.resize(simId + 1, std::vector<SendStamp>(numSendStamps, SendStamp()));
 
         AddSimRequestMessage req(simId, serverPathToSim);
         sendInitialRequest(req);
@@ -165,7 +207,7 @@ namespace NetOff
         }
         _inputMessages[simId].setSpecifyer(ClientMessageSpecifyer::INPUTS);
         send(simId);
-        _isInitialized[simId] = recv(simId, 0.0, ServerMessageSpecifyer::SUCCESS_SIM_INIT);
+        _isInitialized[simId] = recv(simId, ServerMessageSpecifyer::SUCCESS_SIM_INIT);
         _isInitialized[simId] = true;
         return _outputMessages[simId].getContainer();
     }
@@ -178,6 +220,7 @@ namespace NetOff
         std::shared_ptr<size_t> numBytes(new size_t[1], std::default_delete<size_t[]>());
         // Receive file content.
         std::shared_ptr<char> data = _netClient.variableRecv(numBytes.get());
+        _traffic.countReceived(InitialServerMessageSpecifyer::SUCCESS_GET_FILE, sizeof(int) + *numBytes);
         // And store it in given target path.
         GetFileSuccessMessage sucMessage(*numBytes, data, targetPath);
         return true;
@@ -213,6 +256,19 @@ namespace NetOff
                                                       "SimulationClient: Can't start server.");
 
         _currentState = CurrentState::STARTED;
+        // no simulation can be added anymore
+        _inputArena.pack(_inputMessages);
+        _outputArena.pack(_outputMessages);
+        // the answers of all steps in flight and a frame received in parts are stored without allocating
+        for (size_t simId = 0; simId < _earlyAnswers.size(); ++simId)
+        {
+            reserveEarlyAnswers(simId, std::max<size_t>(1, _pipelineDepth));
+        }
+        _partialFrame.payload.reserve(_outputArena.size());
+        if (_realTimeProfile.isEnabled())
+        {
+            applyRealTimeProfile();
+        }
 
         return true;
     }
@@ -223,11 +279,12 @@ namespace NetOff
         {
             throw std::runtime_error("ERROR: SimulationClient: It's not possible to pause before calling start().");
         }
+        checkNoPendingSteps("pause");
 
         _inputMessages[0].setSpecifyer(ClientMessageSpecifyer::PAUSE);
         send(0);
 
-        bool res = recv(0, _inputMessages[0].getTime(), ServerMessageSpecifyer::SUCCESS_PAUSE);
+        bool res = recv(0, ServerMessageSpecifyer::SUCCESS_PAUSE);
         if (res)
         {
             _currentState = CurrentState::PAUSED;
@@ -241,11 +298,12 @@ namespace NetOff
         {
             throw std::runtime_error("ERROR: SimulationClient: It's not possible to unpause before calling start().");
         }
+        checkNoPendingSteps("unpause");
 
         _inputMessages[0].setSpecifyer(ClientMessageSpecifyer::UNPAUSE);
         send(0);
 
-        bool res = recv(0, _inputMessages[0].getTime(), ServerMessageSpecifyer::SUCCESS_UNPAUSE);
+        bool res = recv(0, ServerMessageSpecifyer::SUCCESS_UNPAUSE);
         if (res)
         {
             _currentState = CurrentState::STARTED;
@@ -259,11 +317,12 @@ namespace NetOff
         {
             throw std::runtime_error("ERROR: SimulationClient: It's not possible to reset before calling start().");
         }
+        checkNoPendingSteps("reset");
 
         _inputMessages[0].setSpecifyer(ClientMessageSpecifyer::RESET);
         send(0);
 
-        bool res = recv(0, _inputMessages[0].getTime(), ServerMessageSpecifyer::SUCCESS_RESET);
+        bool res = recv(0, ServerMessageSpecifyer::SUCCESS_RESET);
         if (res)
         {
             _currentState = CurrentState::INITED;
@@ -276,16 +335,466 @@ namespace NetOff
         return _currentState == CurrentState::STARTED;
     }
 
-    bool SimulationClient::send(const int simId)
+    void SimulationClient::setConnectionTimeout(const int & timeoutMs)
+    {
+        _netClient.setConnectionTimeout(timeoutMs);
+    }
+
+    void SimulationClient::setHighWaterMark(const int & numBytes)
+    {
+        _netClient.setHighWaterMark(numBytes);
+    }
+
+    void SimulationClient::setWaitPolicy(const WaitPolicy & policy, const int & spinUs)
+    {
+        _netClient.setWaitPolicy(policy, spinUs);
+    }
+
+    void SimulationClient::setRealTimeProfile(const RealTimeProfile & profile)
+    {
+        _realTimeProfile = profile;
+    }
+
+    RealTimeReport SimulationClient::getRealTimeReport() const
+    {
+        RealTimeReport res = _realTimeReport;
+        if (_realTimeProfile.isEnabled() && _currentState >= CurrentState::STARTED)
+        {
+            const ResourceUsage usage = getResourceUsage();
+            res.numPageFaults = usage.numPageFaults - _startUsage.numPageFaults;
+            res.heapGrowth = static_cast<int64_t>(usage.heapBytes) - static_cast<int64_t>(_startUsage.heapBytes);
+        }
+        return res;
+    }
+
+    void SimulationClient::applyRealTimeProfile()
+    {
+        const RealTimeProfile & profile = _realTimeProfile;
+        RealTimeReport & report = _realTimeReport;
+        if (profile.lockMemory)
+        {
+            report.memoryLocked = true;
+            for (size_t i = 0; i < _inputMessages.size(); ++i)
+            {
+                report.memoryLocked &= lockBuffer(_inputMessages[i].data(), _inputMessages[i].dataSize());
+                report.memoryLocked &= lockBuffer(_outputMessages[i].data(), _outputMessages[i].dataSize());
+            }
+            report.memoryLocked &= lockAllMemory();
+            prefaultStack();
+        }
+        report.threadsPinned = !profile.networkCpus.empty() && pinCurrentThread(profile.networkCpus);
+        report.prioritiesSet = profile.networkPriority > 0 && setCurrentThreadPriority(profile.networkPriority);
+        _startUsage = getResourceUsage();
+    }
+
+    NetworkCounters SimulationClient::getNetworkCounters() const
+    {
+        return _netClient.getCounters();
+    }
+
+    void SimulationClient::setSharedMemorySize(const size_t & ringBytes)
+    {
+        ConnectionOptions options = _netClient.getOptions();
+        options.sharedMemoryBytes = ringBytes;
+        _netClient.setOptions(options);
+    }
+
+    void SimulationClient::resetNetworkCounters()
+    {
+        _netClient.resetCounters();
+    }
+
+    SimulationStatistics SimulationClient::getStatistics() const
+    {
+        SimulationStatistics res;
+        _traffic.copyTo(res);
+        res.network = _netClient.getCounters();
+        res.stepLatencies.reserve(_stepLatencies.size());
+        for (const std::unique_ptr<LatencyHistogram> & latency : _stepLatencies)
+        {
+            res.stepLatencies.push_back(latency->getSnapshot());
+        }
+        res.batchLatency = _batchLatency.getSnapshot();
+        return res;
+    }
+
+    void SimulationClient::resetStatistics()
+    {
+        _traffic.reset();
+        _netClient.resetCounters();
+        for (std::unique_ptr<LatencyHistogram> & latency : _stepLatencies)
+        {
+            latency->reset();
+        }
+        _batchLatency.reset();
+    }
+
+    void SimulationClient::countFrame(const FrameHeader & header, const char * payload)
+    {
+        const size_t numBytes = sizeof(header) + header.numBytes;
+        if (header.simId == FrameHeader::allSims)
+        {
+            _traffic.countReceived(ServerMessageSpecifyer::OUTPUTS, numBytes);
+            recordRoundTrip(_batchSendStamps[header.seq % numSendStamps], header.seq, _batchLatency);
+            return;
+        }
+        // the payload starts with the specifier, the answers of the handshake and of requests aren't steps
+        const ServerMessageSpecifyer spec = *reinterpret_cast<const ServerMessageSpecifyer *>(payload);
+        _traffic.countReceived(spec, numBytes);
+        if ((header.flags & FrameHeader::pushed) == 0 && spec == ServerMessageSpecifyer::OUTPUTS)
+        {
+            recordRoundTrip(_sendStamps[header.simId][header.seq % numSendStamps], header.seq,
+                            *_stepLatencies[header.simId]);
+        }
+    }
+
+    void SimulationClient::recordRoundTrip(SendStamp & stamp, const uint32_t & seq, LatencyHistogram & latency)
+    {
+        if (stamp.ns != 0 && stamp.seq == seq)
+        {
+            latency.record(getMonotonicNs() - stamp.ns);
+            stamp.ns = 0;
+        }
+    }
+
+    void SimulationClient::setPipelineDepth(const size_t & depth)
+    {
+        _pipelineDepth = depth;
+        for (size_t simId = 0; _currentState >= CurrentState::STARTED && simId < _earlyAnswers.size(); ++simId)
+        {
+            reserveEarlyAnswers(simId, depth);
+        }
+    }
+
+    size_t SimulationClient::getPipelineDepth() const
+    {
+        return _pipelineDepth;
+    }
+
+    size_t SimulationClient::getNumPendingSteps(const int & simId) const
+    {
+        if (simId < 0 || static_cast<size_t>(simId) >= _sendSeq.size())
+        {
+            throw std::runtime_error("SimulationClient: Unknown simulation " + std::to_string(simId) + ".");
+        }
+        // the difference is right across a wrap around of the sequence numbers
+        return static_cast<uint32_t>(_sendSeq[simId] - _recvSeq[simId]);
+    }
+
+    size_t SimulationClient::getNumPendingBatches() const
+    {
+        return static_cast<uint32_t>(_batchSendSeq - _batchRecvSeq);
+    }
+
+    void SimulationClient::checkNoPendingSteps(const std::string & function) const
+    {
+        bool pending = getNumPendingBatches() > 0;
+        for (size_t simId = 0; simId < _sendSeq.size(); ++simId)
+        {
+            pending = pending || _sendSeq[simId] != _recvSeq[simId];
+        }
+        if (pending)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to " + function + " while outputs are pending.");
+        }
+    }
+
+    bool SimulationClient::send(const int simId, const bool & answered)
+    {
+        // header and message leave with one gather write
+        FrameHeader header = { static_cast<int>(_inputMessages[simId].dataSize()), simId,
+                answered ? _sendSeq[simId]++ : _sendSeq[simId], 0 };
+        NetworkBuffer parts[2] = { { reinterpret_cast<const char *>(&header), sizeof(header) },
+                { _inputMessages[simId].data(), static_cast<int>(_inputMessages[simId].dataSize()) } };
+        if (answered)
+        {
+            _sendStamps[simId][header.seq % numSendStamps] = SendStamp { header.seq, getMonotonicNs() };
+        }
+        _traffic.countSent(_inputMessages[simId].getSpecifyer(), sizeof(header) + header.numBytes);
+        return _netClient.sendv(parts, 2);
+    }
+
+    bool SimulationClient::recv(const int simId, const ServerMessageSpecifyer & spec)
+    {
+        FrameHeader header;
+        if (!recvAnswer(header, simId))
+        {
+            return false;
+        }
+        // the server answers the frames of a simulation in the order they were sent
+        if (header.simId != simId || header.seq != _recvSeq[simId])
+        {
+            throw std::runtime_error("SimulationClient: Received the answer to an unexpected frame.");
+        }
+        ++_recvSeq[simId];
+        return _outputMessages[simId].getSpecifyer() == spec;
+    }
+
+    size_t SimulationClient::getPayloadSize(const FrameHeader & header) const
+    {
+        if (header.simId == FrameHeader::allSims)
+        {
+            int numBytes = 0;
+            for (const ValueContainerMessage<ServerMessageSpecifyer> & message : _outputMessages)
+            {
+                numBytes += static_cast<int>(message.dataSize());
+            }
+            if (header.numBytes != numBytes)
+            {
+                throw std::runtime_error("SimulationClient: Received a batch of an unexpected size.");
+            }
+            return numBytes;
+        }
+        if (header.simId < 0 || static_cast<size_t>(header.simId) >= _outputMessages.size()
+                || header.numBytes != static_cast<int>(_outputMessages[header.simId].dataSize()))
+        {
+            throw std::runtime_error("SimulationClient: Received a frame of an unexpected simulation or size.");
+        }
+        return header.numBytes;
+    }
+
+    bool SimulationClient::recvFrame(FrameHeader & header, const int & awaitedSimId)
+    {
+        // a frame started by processIncoming() is continued first
+        if (_partialFrame.numHeaderBytes > 0)
+        {
+            return finishPartialFrame(header, awaitedSimId);
+        }
+        if (!_netClient.recv(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            return false;
+        }
+        getPayloadSize(header);
+        if (header.simId == FrameHeader::allSims)
+        {
+            if (!_netClient.recv(_outputArena.data(), _outputArena.size()))
+            {
+                return false;
+            }
+            countFrame(header, _outputArena.data());
+            return true;
+        }
+        char * payload = _outputMessages[header.simId].data();
+        if ((header.flags & FrameHeader::pushed) != 0)
+        {
+            ++_numPushed[header.simId];
+        }
+        else if (awaitedSimId != anySim && awaitedSimId != header.simId)
+        {
+            payload = storeEarlyAnswer(header);
+        }
+        if (!_netClient.recv(payload, _outputMessages[header.simId].dataSize()))
+        {
+            return false;
+        }
+        countFrame(header, payload);
+        return true;
+    }
+
+    int SimulationClient::recvPartialFrame()
+    {
+        PartialFrame & frame = _partialFrame;
+        if (frame.numHeaderBytes < sizeof(FrameHeader))
+        {
+            int num = _netClient.recvAvailable(reinterpret_cast<char *>(&frame.header) + frame.numHeaderBytes,
+                                               sizeof(FrameHeader) - frame.numHeaderBytes);
+            if (num < 0)
+            {
+                return -1;
+            }
+            if (frame.numHeaderBytes + num < sizeof(FrameHeader))
+            {
+                frame.numHeaderBytes += num;
+                return 0;
+            }
+            // the header is only taken when it's valid, so a malformed one isn't continued by the next call
+            frame.numHeaderBytes = 0;
+            frame.payload.resize(getPayloadSize(frame.header));
+            frame.numPayloadBytes = 0;
+            frame.numHeaderBytes = sizeof(FrameHeader);
+        }
+        int num = _netClient.recvAvailable(frame.payload.data() + frame.numPayloadBytes,
+                                           frame.payload.size() - frame.numPayloadBytes);
+        if (num < 0)
+        {
+            return -1;
+        }
+        frame.numPayloadBytes += num;
+        if (frame.numPayloadBytes < frame.payload.size())
+        {
+            return 0;
+        }
+        storePartialFrame(noSim);
+        return 1;
+    }
+
+    bool SimulationClient::finishPartialFrame(FrameHeader & header, const int & awaitedSimId)
+    {
+        PartialFrame & frame = _partialFrame;
+        if (frame.numHeaderBytes < sizeof(FrameHeader))
+        {
+            if (!_netClient.recv(reinterpret_cast<char *>(&frame.header) + frame.numHeaderBytes,
+                                 sizeof(FrameHeader) - frame.numHeaderBytes))
+            {
+                return false;
+            }
+            frame.numHeaderBytes = 0;
+            frame.payload.resize(getPayloadSize(frame.header));
+            frame.numPayloadBytes = 0;
+            frame.numHeaderBytes = sizeof(FrameHeader);
+        }
+        if (!_netClient.recv(frame.payload.data() + frame.numPayloadBytes,
+                             frame.payload.size() - frame.numPayloadBytes))
+        {
+            return false;
+        }
+        header = frame.header;
+        storePartialFrame(awaitedSimId);
+        return true;
+    }
+
+    void SimulationClient::storePartialFrame(const int & awaitedSimId)
+    {
+        PartialFrame & frame = _partialFrame;
+        frame.numHeaderBytes = 0;
+        const FrameHeader & header = frame.header;
+        countFrame(header, frame.payload.data());
+        if (header.simId == FrameHeader::allSims)
+        {
+            std::copy(frame.payload.begin(), frame.payload.end(), _outputArena.data());
+            return;
+        }
+        char * payload = _outputMessages[header.simId].data();
+        if ((header.flags & FrameHeader::pushed) != 0)
+        {
+            ++_numPushed[header.simId];
+        }
+        else if (awaitedSimId != anySim && awaitedSimId != header.simId)
+        {
+            payload = storeEarlyAnswer(header);
+        }
+        std::copy(frame.payload.begin(), frame.payload.end(), payload);
+    }
+
+    char * SimulationClient::storeEarlyAnswer(const FrameHeader & header)
+    {
+        EarlyAnswers & answers = _earlyAnswers[header.simId];
+        if (answers.num == answers.headers.size())
+        {
+            // only an unlimited pipeline has more steps in flight than start() reserved slots for
+            reserveEarlyAnswers(header.simId, std::max<size_t>(1, 2 * answers.num));
+        }
+        const size_t slot = (answers.first + answers.num) % answers.headers.size();
+        answers.headers[slot] = header;
+        ++answers.num;
+        _earlyOrder[(_earlyBegin + _numEarly) % _earlyOrder.size()] = header.simId;
+        ++_numEarly;
+        return answers.payloads.data() + slot * _outputMessages[header.simId].dataSize();
+    }
+
+    void SimulationClient::takeEarlyAnswer(const int & simId, FrameHeader & header)
+    {
+        EarlyAnswers & answers = _earlyAnswers[simId];
+        const size_t payloadSize = _outputMessages[simId].dataSize();
+        const char * payload = answers.payloads.data() + answers.first * payloadSize;
+        header = answers.headers[answers.first];
+        std::copy(payload, payload + payloadSize, _outputMessages[simId].data());
+        answers.first = (answers.first + 1) % answers.headers.size();
+        --answers.num;
+        // the oldest early answer of the simulation is its first entry in the arrival order, the entries before it
+        // move up by one
+        const size_t capacity = _earlyOrder.size();
+        size_t pos = 0;
+        while (_earlyOrder[(_earlyBegin + pos) % capacity] != simId)
+        {
+            ++pos;
+        }
+        for (; pos > 0; --pos)
+        {
+            _earlyOrder[(_earlyBegin + pos) % capacity] = _earlyOrder[(_earlyBegin + pos - 1) % capacity];
+        }
+        _earlyBegin = (_earlyBegin + 1) % capacity;
+        --_numEarly;
+    }
+
+    void SimulationClient::reserveEarlyAnswers(const int & simId, const size_t & capacity)
+    {
+        EarlyAnswers & answers = _earlyAnswers[simId];
+        const size_t oldCapacity = answers.headers.size();
+        if (capacity <= oldCapacity)
+        {
+            return;
+        }
+        // both rings are unrolled, so their oldest entry moves to the first slot
+        const size_t payloadSize = _outputMessages[simId].dataSize();
+        std::vector<FrameHeader> headers(capacity);
+        std::vector<char> payloads(capacity * payloadSize);
+        for (size_t i = 0; i < answers.num; ++i)
+        {
+            const size_t slot = (answers.first + i) % oldCapacity;
+            headers[i] = answers.headers[slot];
+            std::copy(answers.payloads.begin() + slot * payloadSize, answers.payloads.begin() + (slot + 1) * payloadSize,
+                      payloads.begin() + i * payloadSize);
+        }
+        answers.headers.swap(headers);
+        answers.payloads.swap(payloads);
+        answers.first = 0;
+
+        std::vector<int> order(_earlyOrder.size() + capacity - oldCapacity);
+        for (size_t i = 0; i < _numEarly; ++i)
+        {
+            order[i] = _earlyOrder[(_earlyBegin + i) % _earlyOrder.size()];
+        }
+        _earlyOrder.swap(order);
+        _earlyBegin = 0;
+    }
+
+    bool SimulationClient::recvAnswer(FrameHeader & header, const int & awaitedSimId)
     {
-        _netClient.send(reinterpret_cast<const char *>(&_inputMessages[simId].getId()), sizeof(int));  //send id
-        return _netClient.send(_inputMessages[simId].data(), _inputMessages[simId].dataSize());
+        if (awaitedSimId == FrameHeader::allSims && _hasHeldAnswer)
+        {
+            header = _heldAnswer;
+            _hasHeldAnswer = false;
+            return true;
+        }
+        checkNoHeldAnswer();
+        if (awaitedSimId == anySim && _numEarly > 0)
+        {
+            takeEarlyAnswer(_earlyOrder[_earlyBegin], header);
+            return true;
+        }
+        if (awaitedSimId >= 0 && _earlyAnswers[awaitedSimId].num > 0)
+        {
+            takeEarlyAnswer(awaitedSimId, header);
+            return true;
+        }
+        // answers of other simulations are stored on the way, a batch answer stops the search
+        do
+        {
+            if (!recvFrame(header, awaitedSimId))
+            {
+                return false;
+            }
+        }
+        while ((header.flags & FrameHeader::pushed) != 0
+                || (header.simId != awaitedSimId && header.simId != FrameHeader::allSims && awaitedSimId != anySim));
+        if (header.simId == FrameHeader::allSims && awaitedSimId != FrameHeader::allSims)
+        {
+            // the outputs of the batch lie in the output containers already, they're kept until they're received
+            _heldAnswer = header;
+            _hasHeldAnswer = true;
+            checkNoHeldAnswer();
+        }
+        return true;
     }
 
-    bool SimulationClient::recv(const int simId, const double & expectedTime, const ServerMessageSpecifyer & spec)
+    void SimulationClient::checkNoHeldAnswer() const
     {
-        _netClient.recv(_outputMessages[simId].data(), _outputMessages[simId].dataSize());
-        return _outputMessages[simId].getTime() == expectedTime && _outputMessages[simId].getSpecifyer() == spec;
+        if (_hasHeldAnswer)
+        {
+            throw std::runtime_error("SimulationClient: A batch answer arrived first, call recvOutputValuesAll().");
+        }
     }
 
     const std::string & SimulationClient::getHostAddress() const
@@ -308,18 +817,122 @@ namespace NetOff
         _port = port;
     }
 
-    ValueContainer & SimulationClient::recvOutputValues(const int & simId, const double & time)
+    ValueContainer & SimulationClient::recvOutputValues(const int & simId, const double & /*time*/)
     {
         if (_currentState < CurrentState::STARTED)
         {
             throw std::runtime_error(
                     "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
         }
+        if (getNumPendingSteps(simId) == 0)
+        {
+            throw std::runtime_error("SimulationClient: No outputs pending, sendInputValues() wasn't called.");
+        }
 
-        recv(simId, time, ServerMessageSpecifyer::OUTPUTS);
+        recv(simId, ServerMessageSpecifyer::OUTPUTS);
         return _outputMessages[simId].getContainer();
     }
 
+    int SimulationClient::recvAnyOutput()
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
+        }
+        bool pending = false;
+        for (size_t simId = 0; simId < _sendSeq.size() && !pending; ++simId)
+        {
+            pending = getNumPendingSteps(simId) > 0;
+        }
+        if (!pending)
+        {
+            throw std::runtime_error("SimulationClient: No outputs pending, sendInputValues() wasn't called.");
+        }
+
+        FrameHeader header;
+        if (!recvAnswer(header, anySim))
+        {
+            return -1;
+        }
+        if (header.simId < 0 || header.seq != _recvSeq[header.simId])
+        {
+            throw std::runtime_error("SimulationClient: Received the answer to an unexpected frame.");
+        }
+        ++_recvSeq[header.simId];
+        return header.simId;
+    }
+
+    bool SimulationClient::tryRecvOutputValues(const int & simId)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
+        }
+        if (getNumPendingSteps(simId) == 0)
+        {
+            throw std::runtime_error("SimulationClient: No outputs pending, sendInputValues() wasn't called.");
+        }
+        checkNoHeldAnswer();
+        if (_earlyAnswers[simId].num == 0 && (processIncoming() < 0 || _earlyAnswers[simId].num == 0))
+        {
+            return false;
+        }
+
+        FrameHeader header;
+        takeEarlyAnswer(simId, header);
+        if (header.seq != _recvSeq[simId])
+        {
+            throw std::runtime_error("SimulationClient: Received the answer to an unexpected frame.");
+        }
+        ++_recvSeq[simId];
+        return true;
+    }
+
+    int SimulationClient::processIncoming()
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
+        }
+        // with shared memory the socket only carries the wakeup signals of the server
+        if (_netClient.isSharedMemory() && !_netClient.drainWakeups())
+        {
+            return -1;
+        }
+        int numFrames = 0;
+        while (!_hasHeldAnswer)
+        {
+            int res = recvPartialFrame();
+            if (res < 0)
+            {
+                return -1;
+            }
+            if (res > 0)
+            {
+                ++numFrames;
+                if (_partialFrame.header.simId == FrameHeader::allSims)
+                {
+                    _heldAnswer = _partialFrame.header;
+                    _hasHeldAnswer = true;
+                }
+            }
+            // data written before the wakeup was armed doesn't signal the socket, so it's read right away
+            else if (_netClient.armWakeup())
+            {
+                break;
+            }
+        }
+        return numFrames;
+    }
+
+    SocketHandle SimulationClient::nativeHandle() const
+    {
+        return _netClient.nativeHandle();
+    }
+
     bool SimulationClient::sendInputValues(const int & simId, const double & time, const ValueContainer & vals)
     {
         if (_currentState < CurrentState::STARTED)
@@ -332,10 +945,137 @@ namespace NetOff
         {
             throw std::runtime_error("SimulationClient: The ValueContainer is collected via getValueContainerInput()");
         }
+        if (_pipelineDepth > 0 && getNumPendingSteps(simId) >= _pipelineDepth)
+        {
+            throw std::runtime_error("SimulationClient: The pipeline is full, receive outputs before sending inputs.");
+        }
 
         _inputMessages[simId].setSpecifyer(ClientMessageSpecifyer::INPUTS);
         _inputMessages[simId].setTime(time);
-        return send(simId);
+        // the inputs of a subscribed simulation are updates the server doesn't answer
+        return send(simId, !_isSubscribed[simId]);
+    }
+
+    bool SimulationClient::subscribe(const int & simId, const double & period)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error("ERROR: SimulationClient: It's not possible to subscribe before calling start().");
+        }
+        // the period is sent as time of the message, the inputs are applied like an update
+        _inputMessages[simId].setSpecifyer(ClientMessageSpecifyer::SUBSCRIBE);
+        _inputMessages[simId].setTime(period);
+        _isSubscribed[simId] = true;
+        return send(simId, false);
+    }
+
+    bool SimulationClient::unsubscribe(const int & simId)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to unsubscribe before calling start().");
+        }
+        _inputMessages[simId].setSpecifyer(ClientMessageSpecifyer::UNSUBSCRIBE);
+        _isSubscribed[simId] = false;
+        return send(simId, false);
+    }
+
+    bool SimulationClient::isSubscribed(const int & simId) const
+    {
+        return static_cast<size_t>(simId) < _isSubscribed.size() && _isSubscribed[simId];
+    }
+
+    ValueContainer & SimulationClient::pollLatestOutputs(const int & simId, bool * received, const int & timeoutMs)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
+        }
+        // every frame that arrived is taken, the newest output of a simulation overwrites the older ones
+        int waitMs = timeoutMs;
+        while (!_hasHeldAnswer && _netClient.waitReadable(waitMs))
+        {
+            waitMs = 0;
+            FrameHeader header;
+            if (!recvFrame(header, noSim))
+            {
+                break;
+            }
+            if (header.simId == FrameHeader::allSims)
+            {
+                _heldAnswer = header;
+                _hasHeldAnswer = true;
+            }
+        }
+        if (received != nullptr)
+        {
+            *received = _numPushed[simId] != _numPolled[simId];
+        }
+        _numPolled[simId] = _numPushed[simId];
+        return _outputMessages[simId].getContainer();
+    }
+
+    const double & SimulationClient::getOutputTime(const int & simId) const
+    {
+        return _outputMessages[simId].getTime();
+    }
+
+    bool SimulationClient::sendInputValuesAll(const double & time)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to send inputs before calling start().");
+        }
+        if (_pipelineDepth > 0 && getNumPendingBatches() >= _pipelineDepth)
+        {
+            throw std::runtime_error("SimulationClient: The pipeline is full, receive outputs before sending inputs.");
+        }
+
+        // the messages of all simulations lie in one arena and leave with the header in one gather write
+        for (ValueContainerMessage<ClientMessageSpecifyer> & message : _inputMessages)
+        {
+            message.setSpecifyer(ClientMessageSpecifyer::INPUTS);
+            message.setTime(time);
+        }
+        FrameHeader header = { static_cast<int>(_inputArena.size()), FrameHeader::allSims, _batchSendSeq++, 0 };
+        const NetworkBuffer parts[2] = { { reinterpret_cast<const char *>(&header), sizeof(header) },
+                                         { _inputArena.data(), static_cast<int>(_inputArena.size()) } };
+        _batchSendStamps[header.seq % numSendStamps] = SendStamp { header.seq, getMonotonicNs() };
+        _traffic.countSent(ClientMessageSpecifyer::INPUTS_ALL, sizeof(header) + header.numBytes);
+        return _netClient.sendv(parts, 2);
+    }
+
+    bool SimulationClient::recvOutputValuesAll(const double & /*time*/)
+    {
+        if (_currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error(
+                    "ERROR: SimulationClient: It's not possible to receive outputs before calling start().");
+        }
+        if (getNumPendingBatches() == 0)
+        {
+            throw std::runtime_error("SimulationClient: No outputs pending, sendInputValuesAll() wasn't called.");
+        }
+
+        FrameHeader header;
+        if (!recvAnswer(header, FrameHeader::allSims))
+        {
+            return false;
+        }
+        if (header.simId != FrameHeader::allSims || header.seq != _batchRecvSeq)
+        {
+            throw std::runtime_error("SimulationClient: Received the answer to an unexpected frame.");
+        }
+        ++_batchRecvSeq;
+        bool res = true;
+        for (const ValueContainerMessage<ServerMessageSpecifyer> & message : _outputMessages)
+        {
+            res = res && message.getSpecifyer() == ServerMessageSpecifyer::OUTPUTS;
+        }
+        return res;
     }
 
     ValueContainer & SimulationClient::getInputValueContainer(const int & simId)
@@ -8,22 +8,31 @@
 #include "SimulationServer.hpp"
 #include "messages/messages.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <thread>
+
 namespace NetOff
 {
 
+    /*! Receive timeout in milliseconds of a server with several clients, see setReceiveTimeout(). */
+    static const int multiClientReceiveTimeout = 10000;
+
     SimulationServer::SimulationServer()
             : SimulationServer(/* port */-1)
     {
     }
 
-    SimulationServer::SimulationServer(const int & port)
-            : _port(port),
-              _currentState(CurrentState::NONE),
+    SimulationServer::ClientSession::ClientSession()
+            : _currentState(CurrentState::INITED),
               _pathToId(),
-              _netServer(),
               _lastInitSpec(InitialClientMessageSpecifyer::CLIENT_INIT_ABORT),
               _lastSpec(ClientMessageSpecifyer::RESET),
               _lastReceivedTime(0.0),
+              _lastReceivedSeq(),
+              _lastBatchSeq(0),
+              _subscriptionPeriods(),
+              _nextPushTimes(),
               _lastSimId(-1),
               _lastSimulationFile(""),
               _lastAddedSim(nullptr),
@@ -34,10 +43,52 @@ namespace NetOff
               _selectedOutputVarNames(),
               _isInitialized(),
               _inputMessages(),
-              _outputMessages()
+              _outputMessages(),
+              _inputArena(),
+              _outputArena(),
+              _batchParts(),
+              _outputBufferIds(),
+              _stepCallbacks(),
+              _isStepping(),
+              _stepError(),
+              _traffic(),
+              _stepLatencies(),
+              _batchLatency(),
+              _computeTime(),
+              _waitTime(),
+              _headerNs(0),
+              _receivedNs(),
+              _batchReceivedNs(0)
+    {
+    }
+
+    SimulationServer::SimulationServer(const int & port)
+            : _port(port),
+              _socketPath(),
+              _currentState(CurrentState::NONE),
+              _netServer(),
+              _maxClients(1),
+              _clients(),
+              _currentClient(-1),
+              _numWorkers(std::max(std::thread::hardware_concurrency(), 1u)),
+              _stepPool(),
+              _realTimeProfile(),
+              _realTimeReport(),
+              _startUsage(),
+              _workersPinned(false),
+              _workerPrioritiesSet(false)
     {
     }
 
+    SimulationServer::SimulationServer(const std::string & address)
+            : SimulationServer(NetworkMember::isUnixSocketAddress(address) ? -1 : std::stoi(address))
+    {
+        if (NetworkMember::isUnixSocketAddress(address))
+        {
+            _socketPath = NetworkMember::getUnixSocketPath(address);
+        }
+    }
+
     SimulationServer::~SimulationServer()
     {
         deinitialize();
@@ -45,7 +96,7 @@ namespace NetOff
 
     bool SimulationServer::initializeConnection()
     {
-        if (_port < 1)
+        if (_port < 1 && _socketPath.empty())
         {
             std::cout << "SimulationServer: Port wasn't set.\n";
             return false;
@@ -55,33 +106,129 @@ namespace NetOff
             return true;
         }
 
-        if (_netServer.initialize(_port))
+        const bool listening = _socketPath.empty() ? _netServer.initialize(_port, _maxClients) :
+                _netServer.initialize(_socketPath, _maxClients);
+        if (!listening)
         {
-            _currentState = CurrentState::INITED;
-            return true;
+            return false;
         }
-
-        return false;
+        if (_maxClients == 1)
+        {
+            // a single client server waits for its client and refuses all further ones
+            int id = _netServer.acceptConnection();
+            _netServer.stopListening();
+            if (id < 0)
+            {
+                _netServer.deinitialize();
+                return false;
+            }
+            selectClient(openSession(id));
+        }
+        _currentState = CurrentState::INITED;
+        return true;
     }
 
     void SimulationServer::deinitialize()
     {
+        // the workers refer to the sessions
+        _stepPool.reset();
         _netServer.deinitialize();
+        _clients.clear();
+        _currentClient = -1;
         _currentState = CurrentState::NONE;
     }
 
+    void SimulationServer::setMaxClients(const size_t & maxClients)
+    {
+        if (_currentState > CurrentState::NONE)
+        {
+            throw std::runtime_error("SimulationServer: The number of clients can't be changed while running.");
+        }
+        _maxClients = std::max<size_t>(1, maxClients);
+        ConnectionOptions options = _netServer.getOptions();
+        if (_maxClients > 1 && options.recvTimeout < 0)
+        {
+            options.recvTimeout = multiClientReceiveTimeout;
+            _netServer.setOptions(options);
+        }
+    }
+
+    const size_t & SimulationServer::getMaxClients() const
+    {
+        return _maxClients;
+    }
+
+    int SimulationServer::waitForClientRequest(const int & timeoutMs)
+    {
+        if (_currentState < CurrentState::INITED)
+        {
+            throw std::runtime_error("SimulationServer: The server wasn't initiated.");
+        }
+        int id = _netServer.waitForData(timeoutMs);
+        if (id >= 0)
+        {
+            selectClient(openSession(id));
+        }
+        return id;
+    }
+
+    void SimulationServer::selectClient(const int & clientId)
+    {
+        if (!_netServer.isConnected(clientId) || static_cast<size_t>(clientId) >= _clients.size()
+                || _clients[clientId] == nullptr)
+        {
+            throw std::runtime_error("SimulationServer: Client " + std::to_string(clientId) + " isn't connected.");
+        }
+        _currentClient = clientId;
+    }
+
+    int SimulationServer::getLastClientId() const
+    {
+        return _currentClient;
+    }
+
+    bool SimulationServer::isClientStarted() const
+    {
+        return client()._currentState == CurrentState::STARTED;
+    }
+
+    void SimulationServer::disconnectClient()
+    {
+        ClientSession & c = client();
+        _netServer.closeConnection(_currentClient);
+        // the engine must not refer to the output messages once the session is gone
+        for (const int & bufferId : c._outputBufferIds)
+        {
+            _netServer.unregisterBuffer(bufferId);
+        }
+        _clients[_currentClient].reset();
+        _currentClient = -1;
+    }
+
+    size_t SimulationServer::getNumClients() const
+    {
+        return _netServer.getNumConnections();
+    }
+
     InitialClientMessageSpecifyer SimulationServer::getInitialClientRequest()
     {
-        if (!_handledLastRequest || _currentState < CurrentState::INITED)
+        ClientSession & c = client();
+        if (!c._handledLastRequest || _currentState < CurrentState::INITED)
         {
             throw std::runtime_error(
                     "SimulationServer: Last initial request wasn't handled or the server wasn't initiated.");
         }
-        _handledLastRequest = false;
+        c._handledLastRequest = false;
         std::shared_ptr<char> data = recvInitialMessage();
+        if (data == nullptr)
+        {
+            // the client vanished, which is handled like an abort
+            c._lastInitSpec = InitialClientMessageSpecifyer::CLIENT_INIT_ABORT;
+            return c._lastInitSpec;
+        }
         //start of message is always a InitialClientMessageSpecifyer
-        _lastInitSpec = *reinterpret_cast<InitialClientMessageSpecifyer *>(data.get());
-        switch (_lastInitSpec)
+        c._lastInitSpec = *reinterpret_cast<InitialClientMessageSpecifyer *>(data.get());
+        switch (c._lastInitSpec)
         {
             case InitialClientMessageSpecifyer::CLIENT_INIT_ABORT:
 
@@ -101,141 +248,157 @@ namespace NetOff
             default:
                 break;
         }
-        return _lastInitSpec;
+        return c._lastInitSpec;
     }
 
     std::tuple<std::string, int> SimulationServer::getAddedSimulation()
     {
-        if (_handledLastRequest || _currentState < CurrentState::INITED
-                || _lastInitSpec != InitialClientMessageSpecifyer::ADD_SIM)
+        ClientSession & c = client();
+        if (c._handledLastRequest || _currentState < CurrentState::INITED
+                || c._lastInitSpec != InitialClientMessageSpecifyer::ADD_SIM)
         {
             throw std::runtime_error("SimulationServer: Couldn't add FMU. Wrong function called.");
         }
-        if (_lastAddedSim == nullptr)
+        if (c._lastAddedSim == nullptr)
         {
             throw std::runtime_error("SimulationServer: No FMU added jet.");
         }
 
-        return *_lastAddedSim;
+        return *c._lastAddedSim;
     }
 
     int SimulationServer::getLastSimId() const
     {
-        return _lastSimId;
+        const ClientSession & c = client();
+        return c._lastSimId;
     }
 
     VariableList SimulationServer::getSelectedInputVariables(const int & simId) const
     {
-        if (_currentState < CurrentState::INITED || static_cast<size_t>(simId) >= _selectedInputVarNames.size())
+        const ClientSession & c = client();
+        if (_currentState < CurrentState::INITED || static_cast<size_t>(simId) >= c._selectedInputVarNames.size())
         {
             throw std::runtime_error(
                     std::string(__FILE__) + " " + std::to_string( __LINE__)
                             + "ERROR: SimulationServer: Input container can't be returned. The simulation hasn't been initialized.");
         }
-        return _selectedInputVarNames[simId];
+        return c._selectedInputVarNames[simId];
     }
 
     VariableList SimulationServer::getSelectedOutputVariables(const int & simId) const
     {
-        if (_currentState < CurrentState::INITED || static_cast<size_t>(simId) >= _selectedOutputVarNames.size())
+        const ClientSession & c = client();
+        if (_currentState < CurrentState::INITED || static_cast<size_t>(simId) >= c._selectedOutputVarNames.size())
         {
             throw std::runtime_error(
                     "ERROR: SimulationServer: Output container can't be returned. The simulation hasn't been initialized.");
         }
-        return _selectedOutputVarNames[simId];
+        return c._selectedOutputVarNames[simId];
     }
 
     bool SimulationServer::confirmSimulationAdd(const int & simId, const VariableList & varNamePossibleInputs,
                                                 const VariableList & varNamePossibleOutputs)
     {
-        if (_handledLastRequest || _currentState < CurrentState::INITED
-                || _lastInitSpec != InitialClientMessageSpecifyer::ADD_SIM)
+        ClientSession & c = client();
+        if (c._handledLastRequest || _currentState < CurrentState::INITED
+                || c._lastInitSpec != InitialClientMessageSpecifyer::ADD_SIM)
         {
             throw std::runtime_error("SimulationServer: Cannot send variable names.");
         }
 
-        _allInputVarNames[simId] = varNamePossibleInputs;
-        _allOutputVarNames[simId] = varNamePossibleOutputs;
+        c._allInputVarNames[simId] = varNamePossibleInputs;
+        c._allOutputVarNames[simId] = varNamePossibleOutputs;
 
         AddSimSuccessMessage answer(simId, varNamePossibleInputs, varNamePossibleOutputs);
         sendInitialRequest(answer);
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
         return true;
     }
 
     bool SimulationServer::confirmSimulationInit(const int & simId, const ValueContainer & initialOutputs)
     {
-        if (_handledLastRequest || _currentState < CurrentState::INITED
-                || _lastInitSpec != InitialClientMessageSpecifyer::INIT_SIM || initialOutputs.getSimId() != simId)
+        ClientSession & c = client();
+        if (c._handledLastRequest || _currentState < CurrentState::INITED
+                || c._lastInitSpec != InitialClientMessageSpecifyer::INIT_SIM || initialOutputs.getSimId() != simId)
         {
             throw std::runtime_error("SimulationServer: Cannot confirm simulation initialization.");
         }
-        _outputMessages[simId].setSpecifyer(ServerMessageSpecifyer::SUCCESS_SIM_INIT);
-        _outputMessages[simId].setTime(0.0);
-        _handledLastRequest = true;
+        c._outputMessages[simId].setSpecifyer(ServerMessageSpecifyer::SUCCESS_SIM_INIT);
+        c._outputMessages[simId].setTime(0.0);
+        c._handledLastRequest = true;
 
         return sendMessage(simId);
     }
 
     bool SimulationServer::confirmSimulationFile(const int & simId, const std::string & fileSrc)
     {
-        if (_handledLastRequest || _currentState < CurrentState::INITED
-                || _lastInitSpec != InitialClientMessageSpecifyer::GET_FILE)
+        ClientSession & c = client();
+        if (c._handledLastRequest || _currentState < CurrentState::INITED
+                || c._lastInitSpec != InitialClientMessageSpecifyer::GET_FILE)
         {
             throw std::runtime_error("SimulationServer: Cannot confirm simulation file.");
         }
         GetFileSuccessMessage message(simId, fileSrc);
         GetFileSuccessMessage test(message.dataSize(), message.shared(), "/home/hartung/test.txt");
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
         return sendInitialRequest(message);
     }
 
     void SimulationServer::confirmStart()
     {
-        if (_handledLastRequest || _currentState < CurrentState::INITED
-                || _lastInitSpec != InitialClientMessageSpecifyer::START)
+        ClientSession & c = client();
+        if (c._handledLastRequest || _currentState < CurrentState::INITED
+                || c._lastInitSpec != InitialClientMessageSpecifyer::START)
         {
             throw std::runtime_error("SimulationServer: Cannot confirm start.");
         }
+        packMessages(c);
+        if (_realTimeProfile.isEnabled())
+        {
+            applyRealTimeProfile(c);
+        }
         StartSuccessMessage answer;
         sendInitialRequest(answer);
-        _handledLastRequest = true;
-        _currentState = CurrentState::STARTED;
+        c._handledLastRequest = true;
+        c._currentState = CurrentState::STARTED;
     }
 
     void SimulationServer::confirmPause()
     {
-        if (_handledLastRequest || _currentState < CurrentState::STARTED || _lastSpec != ClientMessageSpecifyer::PAUSE)
+        ClientSession & c = client();
+        if (c._handledLastRequest || c._currentState < CurrentState::STARTED || c._lastSpec != ClientMessageSpecifyer::PAUSE)
         {
-            std::runtime_error("SimulationServer: Cannot confirm pause.");
+            throw std::runtime_error("SimulationServer: Cannot confirm pause.");
         }
 
-        _outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_PAUSE);
+        c._outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_PAUSE);
         sendMessage(0);
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
     }
 
     void SimulationServer::confirmUnpause()
     {
-        if (_handledLastRequest || _currentState < CurrentState::STARTED
-                || _lastSpec != ClientMessageSpecifyer::UNPAUSE)
+        ClientSession & c = client();
+        if (c._handledLastRequest || c._currentState < CurrentState::STARTED
+                || c._lastSpec != ClientMessageSpecifyer::UNPAUSE)
         {
-            std::runtime_error("SimulationServer: Cannot confirm unpause.");
+            throw std::runtime_error("SimulationServer: Cannot confirm unpause.");
         }
-        _outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_UNPAUSE);
+        c._outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_UNPAUSE);
         sendMessage(0);
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
     }
 
     void SimulationServer::confirmReset()
     {
-        if (_handledLastRequest || _currentState < CurrentState::STARTED || _lastSpec != ClientMessageSpecifyer::RESET)
+        ClientSession & c = client();
+        if (c._handledLastRequest || c._currentState < CurrentState::STARTED || c._lastSpec != ClientMessageSpecifyer::RESET)
         {
-            std::runtime_error("SimulationServer: Cannot confirm reset.");
+            throw std::runtime_error("SimulationServer: Cannot confirm reset.");
         }
-        _outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_RESET);
+        c._outputMessages[0].setSpecifyer(ServerMessageSpecifyer::SUCCESS_RESET);
         sendMessage(0);
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
     }
 
     const int & SimulationServer::getPort() const
@@ -248,8 +411,101 @@ namespace NetOff
         this->_port = port;
     }
 
+    void SimulationServer::setConnectionTimeout(const int & timeoutMs)
+    {
+        ConnectionOptions options = _netServer.getOptions();
+        options.connectionTimeout = timeoutMs;
+        _netServer.setOptions(options);
+    }
+
+    void SimulationServer::setHighWaterMark(const int & numBytes)
+    {
+        ConnectionOptions options = _netServer.getOptions();
+        options.highWaterMark = (numBytes < 1) ? std::numeric_limits<int>::max() : numBytes;
+        _netServer.setOptions(options);
+    }
+
+    void SimulationServer::setWaitPolicy(const WaitPolicy & policy, const int & spinUs)
+    {
+        ConnectionOptions options = _netServer.getOptions();
+        options.waitPolicy = policy;
+        options.spinUs = std::max(0, spinUs);
+        _netServer.setOptions(options);
+    }
+
+    void SimulationServer::setReceiveTimeout(const int & timeoutMs)
+    {
+        ConnectionOptions options = _netServer.getOptions();
+        options.recvTimeout = std::max(-1, timeoutMs);
+        _netServer.setOptions(options);
+    }
+
+    void SimulationServer::setIoUring(const bool & enable)
+    {
+        if (_currentState > CurrentState::NONE)
+        {
+            throw std::runtime_error("SimulationServer: The io_uring engine can't be changed while running.");
+        }
+        _netServer.setIoUring(enable);
+    }
+
+    bool SimulationServer::isIoUringActive() const
+    {
+        return _netServer.isIoUringActive();
+    }
+
+    NetworkCounters SimulationServer::getNetworkCounters() const
+    {
+        return _netServer.getCounters();
+    }
+
+    void SimulationServer::setSharedMemory(const bool & enable)
+    {
+        // the ring size is chosen by the client, the server only needs to know whether it accepts
+        ConnectionOptions options = _netServer.getOptions();
+        options.sharedMemoryBytes = enable ? ConnectionOptions().sharedMemoryBytes : 0;
+        _netServer.setOptions(options);
+    }
+
+    void SimulationServer::resetNetworkCounters()
+    {
+        _netServer.resetCounters();
+    }
+
+    SimulationStatistics SimulationServer::getStatistics(const int & clientId) const
+    {
+        const ClientSession & c = session(clientId);
+        SimulationStatistics res;
+        c._traffic.copyTo(res);
+        res.network = _netServer.getConnection(clientId).getCounters();
+        res.stepLatencies.reserve(c._stepLatencies.size());
+        for (const std::unique_ptr<LatencyHistogram> & latency : c._stepLatencies)
+        {
+            res.stepLatencies.push_back(latency->getSnapshot());
+        }
+        res.batchLatency = c._batchLatency.getSnapshot();
+        res.computeTime = c._computeTime.getSnapshot();
+        res.waitTime = c._waitTime.getSnapshot();
+        return res;
+    }
+
+    void SimulationServer::resetStatistics(const int & clientId)
+    {
+        ClientSession & c = session(clientId);
+        c._traffic.reset();
+        _netServer.getConnection(clientId).resetCounters();
+        for (std::unique_ptr<LatencyHistogram> & latency : c._stepLatencies)
+        {
+            latency->reset();
+        }
+        c._batchLatency.reset();
+        c._computeTime.reset();
+        c._waitTime.reset();
+    }
+
     void SimulationServer::prepareAddSim(std::shared_ptr<char> & data)
     {
+        ClientSession & c = client();
         AddSimRequestMessage message(data);
         if (!message.testRequest(InitialClientMessageSpecifyer::ADD_SIM))
         {
@@ -258,86 +514,491 @@ namespace NetOff
         int simId = message.getSimId();
         std::string fmuPath = message.getPath();
         std::cout << "Got the simulation path: " << fmuPath << std::endl;
-        auto it = _pathToId.insert(std::make_pair(fmuPath, simId));
+        auto it = c._pathToId.insert(std::make_pair(fmuPath, simId));
         if (!it.second)
         {
             throw std::runtime_error("SimulationServer: FMU already added.");
         }
-        _lastAddedSim = &(*it.first);
+        c._lastAddedSim = &(*it.first);
 
-        _allInputVarNames.resize(simId + 1);
-        _allOutputVarNames.resize(simId + 1);
-        _selectedInputVarNames.resize(simId + 1);
-        _selectedOutputVarNames.resize(simId + 1);
+        c._allInputVarNames.resize(simId + 1);
+        c._allOutputVarNames.resize(simId + 1);
+        c._selectedInputVarNames.resize(simId + 1);
+        c._selectedOutputVarNames.resize(simId + 1);
 
-        _lastReceivedTime.resize(simId + 1, -1.0);
-        _inputMessages.resize(simId + 1);
-        _outputMessages.resize(simId + 1);
-        _isInitialized.resize(simId + 1, false);
+        c._lastReceivedTime.resize(simId + 1, -1.0);
+        c._lastReceivedSeq.resize(simId + 1, 0);
+        c._subscriptionPeriods.resize(simId + 1, -1.0);
+        c._nextPushTimes.resize(simId + 1, 0.0);
+        c._inputMessages.resize(simId + 1);
+        c._outputMessages.resize(simId + 1);
+        c._outputBufferIds.resize(simId + 1, -1);
+        c._stepCallbacks.resize(simId + 1);
+        c._isStepping.resize(simId + 1, false);
+        c._isInitialized.resize(simId + 1, false);
+        c._receivedNs.resize(simId + 1, 0);
+        while (c._stepLatencies.size() < c._receivedNs.size())
+        {
+            c._stepLatencies.push_back(std::unique_ptr<LatencyHistogram>(new LatencyHistogram()));
+        }
     }
 
     void SimulationServer::prepareInitSim(std::shared_ptr<char> & data)
     {
+        ClientSession & c = client();
         InitSimulationMessage initMessage(data);
         std::cout << "Initialize" << std::endl;
 
-        _lastSimId = initMessage.getSimId();
-        _selectedInputVarNames[_lastSimId] = initMessage.getInputs();
-        _selectedOutputVarNames[_lastSimId] = initMessage.getOutputs();
+        c._lastSimId = initMessage.getSimId();
+        c._selectedInputVarNames[c._lastSimId] = initMessage.getInputs();
+        c._selectedOutputVarNames[c._lastSimId] = initMessage.getOutputs();
 
-        _inputMessages[_lastSimId] = ValueContainerMessage<ClientMessageSpecifyer>(_lastSimId,
-                                                                                   _selectedInputVarNames[_lastSimId],
-                                                                                   ClientMessageSpecifyer::INPUTS);
-        _outputMessages[_lastSimId] = ValueContainerMessage<ServerMessageSpecifyer>(_lastSimId,
-                                                                                    _selectedOutputVarNames[_lastSimId],
-                                                                                    ServerMessageSpecifyer::OUTPUTS);
+        c._inputMessages[c._lastSimId] = ValueContainerMessage<ClientMessageSpecifyer>(
+                c._lastSimId, c._selectedInputVarNames[c._lastSimId], ClientMessageSpecifyer::INPUTS);
+        _netServer.unregisterBuffer(c._outputBufferIds[c._lastSimId]);
+        c._outputMessages[c._lastSimId] = ValueContainerMessage<ServerMessageSpecifyer>(
+                c._lastSimId, c._selectedOutputVarNames[c._lastSimId], ServerMessageSpecifyer::OUTPUTS);
+        // the engine sends large outputs straight from the message
+        c._outputBufferIds[c._lastSimId] = _netServer.registerBuffer(c._outputMessages[c._lastSimId].data(),
+                                                                     c._outputMessages[c._lastSimId].dataSize());
 
-        if (_lastSimId != this->recvMessage())
+        const int simId = c._lastSimId;
+        if (!recvMessage() || c._lastSimId != simId)
         {
             throw std::runtime_error("SimulationServer: Internal error occurred. Received initial values invalid.");
         }
 
-        _isInitialized[_lastSimId] = true;
+        c._isInitialized[c._lastSimId] = true;
     }
 
-    bool SimulationServer::sendMessage(const int & simId)
+    bool SimulationServer::sendMessage(const int & simId, const uint32_t & flags)
     {
-        return _netServer.send(_outputMessages[simId].data(), _outputMessages[simId].dataSize());
+        ClientSession & c = client();
+        // header and message leave with one gather write, or with the next batch of the io_uring engine
+        FrameHeader header = { static_cast<int>(c._outputMessages[simId].dataSize()), simId,
+                c._lastReceivedSeq[simId], flags };
+        NetworkBuffer parts[2] = { { reinterpret_cast<const char *>(&header), sizeof(header) },
+                { c._outputMessages[simId].data(), static_cast<int>(c._outputMessages[simId].dataSize()) } };
+        // the answers of the handshake, of requests and pushed outputs aren't steps
+        const ServerMessageSpecifyer spec = c._outputMessages[simId].getSpecifyer();
+        c._traffic.countSent(spec, sizeof(header) + header.numBytes);
+        if (flags == 0 && spec == ServerMessageSpecifyer::OUTPUTS && c._receivedNs[simId] != 0)
+        {
+            c._stepLatencies[simId]->record(getMonotonicNs() - c._receivedNs[simId]);
+            c._receivedNs[simId] = 0;
+        }
+        return connection().queueSend(parts, 2);
     }
 
     bool SimulationServer::sendOutputValues(const int & simId, const double & /*time*/)
     {
-        if (_handledLastRequest || _currentState < CurrentState::STARTED || ClientMessageSpecifyer::INPUTS != _lastSpec
-                || _lastSimId != simId)
+        ClientSession & c = client();
+        // recvInputValues() marks the request as handled, so only the request itself is checked
+        if (c._currentState < CurrentState::STARTED || ClientMessageSpecifyer::INPUTS != c._lastSpec || c._lastSimId != simId)
         {
-            std::runtime_error("SimulationServer: Couldn't send output values");
+            throw std::runtime_error("SimulationServer: Couldn't send output values.");
         }
-        _handledLastRequest = true;
+        if (isSubscribed(simId))
+        {
+            throw std::runtime_error("SimulationServer: The inputs of a subscribed simulation aren't answered.");
+        }
+        c._handledLastRequest = true;
+        // the message still carries the specifier of confirmSimulationInit() or of the last push
+        _netServer.syncBuffer(c._outputBufferIds[simId]);
+        c._outputMessages[simId].setSpecifyer(ServerMessageSpecifyer::OUTPUTS);
         return sendMessage(simId);
     }
 
+    bool SimulationServer::isSubscribed(const int & simId) const
+    {
+        const ClientSession & c = client();
+        return static_cast<size_t>(simId) < c._subscriptionPeriods.size() && c._subscriptionPeriods[simId] >= 0.0;
+    }
+
+    bool SimulationServer::pushOutputValues(const int & simId, const double & time)
+    {
+        ClientSession & c = client();
+        if (!isSubscribed(simId) || time < c._nextPushTimes[simId])
+        {
+            return false;
+        }
+        // the next push is due one period after this one, a server that fell behind doesn't catch up
+        c._nextPushTimes[simId] = time + c._subscriptionPeriods[simId];
+        _netServer.syncBuffer(c._outputBufferIds[simId]);
+        c._outputMessages[simId].setSpecifyer(ServerMessageSpecifyer::OUTPUTS);
+        c._outputMessages[simId].setTime(time);
+        return sendMessage(simId, FrameHeader::pushed);
+    }
+
+    bool SimulationServer::sendOutputValuesAll(const double & time)
+    {
+        ClientSession & c = client();
+        if (c._handledLastRequest || c._currentState < CurrentState::STARTED
+                || ClientMessageSpecifyer::INPUTS_ALL != c._lastSpec)
+        {
+            throw std::runtime_error("SimulationServer: Couldn't send the output values of all simulations.");
+        }
+        c._handledLastRequest = true;
+        for (size_t simId = 0; simId < c._outputMessages.size(); ++simId)
+        {
+            _netServer.syncBuffer(c._outputBufferIds[simId]);
+            c._outputMessages[simId].setSpecifyer(ServerMessageSpecifyer::OUTPUTS);
+            c._outputMessages[simId].setTime(time);
+        }
+        return sendMessageAll();
+    }
+
+    bool SimulationServer::sendMessageAll()
+    {
+        ClientSession & c = client();
+        // the messages of all simulations lie in one arena and leave with the header in one gather write
+        FrameHeader header = { static_cast<int>(c._outputArena.size()), FrameHeader::allSims, c._lastBatchSeq, 0 };
+        c._traffic.countSent(ServerMessageSpecifyer::OUTPUTS, sizeof(header) + header.numBytes);
+        if (c._batchReceivedNs != 0)
+        {
+            c._batchLatency.record(getMonotonicNs() - c._batchReceivedNs);
+            c._batchReceivedNs = 0;
+        }
+        if (_netServer.isIoUringActive())
+        {
+            c._batchParts.resize(1);
+            for (const ValueContainerMessage<ServerMessageSpecifyer> & message : c._outputMessages)
+            {
+                c._batchParts.push_back(NetworkBuffer { message.data(), static_cast<int>(message.dataSize()) });
+            }
+            c._batchParts[0] = NetworkBuffer { reinterpret_cast<const char *>(&header), sizeof(header) };
+            return connection().queueSend(c._batchParts.data(), static_cast<int>(c._batchParts.size()));
+        }
+        const NetworkBuffer parts[2] = { { reinterpret_cast<const char *>(&header), sizeof(header) },
+                                         { c._outputArena.data(), static_cast<int>(c._outputArena.size()) } };
+        return connection().queueSend(parts, 2);
+    }
+
     ValueContainer& SimulationServer::recvInputValues(const int & simId)
     {
-        if (_handledLastRequest || _currentState < CurrentState::STARTED || ClientMessageSpecifyer::INPUTS != _lastSpec
-                || _lastSimId != simId)
+        ClientSession & c = client();
+        if (c._handledLastRequest || c._currentState < CurrentState::STARTED || ClientMessageSpecifyer::INPUTS != c._lastSpec
+                || c._lastSimId != simId)
         {
-            std::runtime_error("SimulationServer: Couldn't receive output values. Error occurred.");
+            throw std::runtime_error("SimulationServer: Couldn't receive input values.");
         }
-        _handledLastRequest = true;
+        c._handledLastRequest = true;
         return getInputValueContainer(simId);
     }
 
+    void SimulationServer::setNumWorkers(const size_t & numWorkers)
+    {
+        _numWorkers = std::max(numWorkers, static_cast<size_t>(1));
+        // the workers are started again with the next stepSimulations()
+        if (_stepPool != nullptr && _stepPool->getNumThreads() != _numWorkers)
+        {
+            _stepPool.reset();
+        }
+    }
+
+    size_t SimulationServer::getNumWorkers() const
+    {
+        return _numWorkers;
+    }
+
+    void SimulationServer::setStepCallback(const int & simId, const StepCallback & step)
+    {
+        ClientSession & c = client();
+        if (simId < 0 || static_cast<size_t>(simId) >= c._stepCallbacks.size())
+        {
+            throw std::runtime_error("SimulationServer: Cannot set the step of an unknown simulation.");
+        }
+        c._stepCallbacks[simId] = step;
+    }
+
+    ClientMessageSpecifyer SimulationServer::stepSimulations()
+    {
+        ClientSession & c = client();
+        if (!c._handledLastRequest || c._currentState < CurrentState::STARTED)
+        {
+            throw std::runtime_error("SimulationServer: Last request wasn't handled or the server wasn't started.");
+        }
+        if (_stepPool == nullptr)
+        {
+            startStepPool();
+        }
+        bool stepped = false;
+        FrameHeader header;
+        std::exception_ptr error;
+        while (true)
+        {
+            for (int simId = _stepPool->tryFinished(error); simId >= 0; simId = _stepPool->tryFinished(error))
+            {
+                answerStep(simId, error);
+            }
+            if (c._stepError)
+            {
+                return abortSteps();
+            }
+            // the first request is awaited, further ones are only served while they are available
+            if (stepped && !connection().waitReadable(0))
+            {
+                if (_stepPool->getNumPending() == 0)
+                {
+                    c._lastSpec = ClientMessageSpecifyer::STEPPED;
+                    return c._lastSpec;
+                }
+                // the io_uring engine would hold the answers back while the server waits for the workers
+                _netServer.flush();
+                const int simId = _stepPool->waitFinished(error);
+                answerStep(simId, error);
+                continue;
+            }
+
+            bool received = recvFrameHeader(header);
+            if (received)
+            {
+                // the inputs of a running step must not be overwritten
+                if (header.simId == FrameHeader::allSims)
+                {
+                    finishSteps(true);
+                }
+                else
+                {
+                    waitForStep(header.simId);
+                }
+                received = !c._stepError && recvPayload(header);
+            }
+            if (!received)
+            {
+                // the client vanished or a step failed, which is handled like an abort
+                return abortSteps();
+            }
+
+            const ClientMessageSpecifyer spec = evaluateRequest();
+            if (spec == ClientMessageSpecifyer::INPUTS && c._stepCallbacks[c._lastSimId] && !isSubscribed(c._lastSimId))
+            {
+                c._handledLastRequest = true;
+                _netServer.syncBuffer(c._outputBufferIds[c._lastSimId]);
+                c._isStepping[c._lastSimId] = true;
+                _stepPool->submit(c._lastSimId);
+                stepped = true;
+                continue;
+            }
+            bool allStepped = (spec == ClientMessageSpecifyer::INPUTS_ALL);
+            for (size_t simId = 0; allStepped && simId < c._stepCallbacks.size(); ++simId)
+            {
+                allStepped = static_cast<bool>(c._stepCallbacks[simId]);
+            }
+            if (allStepped)
+            {
+                c._handledLastRequest = true;
+                for (size_t simId = 0; simId < c._stepCallbacks.size(); ++simId)
+                {
+                    _netServer.syncBuffer(c._outputBufferIds[simId]);
+                    c._isStepping[simId] = true;
+                    _stepPool->submit(static_cast<int>(simId));
+                }
+                finishSteps(false);
+                if (c._stepError)
+                {
+                    return abortSteps();
+                }
+                sendMessageAll();
+                stepped = true;
+                continue;
+            }
+            finishSteps(true);
+            if (c._stepError)
+            {
+                return abortSteps();
+            }
+            return spec;
+        }
+    }
+
+    void SimulationServer::startStepPool()
+    {
+        StepPool::ThreadFunction onStart;
+        if (!_realTimeProfile.workerCpus.empty() || _realTimeProfile.workerPriority > 0)
+        {
+            _workersPinned = !_realTimeProfile.workerCpus.empty();
+            _workerPrioritiesSet = _realTimeProfile.workerPriority > 0;
+            onStart = std::bind(&SimulationServer::setUpWorker, this, std::placeholders::_1);
+        }
+        _stepPool.reset(new StepPool(_numWorkers, std::bind(&SimulationServer::runStep, this, std::placeholders::_1),
+                                     onStart));
+    }
+
+    void SimulationServer::setUpWorker(const size_t & index)
+    {
+        const std::vector<int> & cpus = _realTimeProfile.workerCpus;
+        if (!cpus.empty() && !pinCurrentThread(std::vector<int>(1, cpus[index % cpus.size()])))
+        {
+            _workersPinned = false;
+        }
+        if (_realTimeProfile.workerPriority > 0 && !setCurrentThreadPriority(_realTimeProfile.workerPriority))
+        {
+            _workerPrioritiesSet = false;
+        }
+        if (_realTimeProfile.lockMemory)
+        {
+            prefaultStack();
+        }
+    }
+
+    void SimulationServer::packMessages(ClientSession & c)
+    {
+        for (int & bufferId : c._outputBufferIds)
+        {
+            _netServer.unregisterBuffer(bufferId);
+        }
+        c._inputArena.pack(c._inputMessages);
+        c._outputArena.pack(c._outputMessages);
+        // every message keeps its own registration, so answering one simulation doesn't wait for the sends of others
+        for (size_t i = 0; i < c._outputMessages.size(); ++i)
+        {
+            c._outputBufferIds[i] = _netServer.registerBuffer(c._outputMessages[i].data(),
+                                                              c._outputMessages[i].dataSize());
+        }
+        // the header and the messages of an io_uring batch
+        c._batchParts.reserve(c._outputMessages.size() + 1);
+    }
+
+    void SimulationServer::applyRealTimeProfile(ClientSession & c)
+    {
+        const RealTimeProfile & profile = _realTimeProfile;
+        RealTimeReport & report = _realTimeReport;
+        if (profile.lockMemory)
+        {
+            report.memoryLocked = true;
+            for (size_t i = 0; i < c._inputMessages.size(); ++i)
+            {
+                report.memoryLocked &= lockBuffer(c._inputMessages[i].data(), c._inputMessages[i].dataSize());
+                report.memoryLocked &= lockBuffer(c._outputMessages[i].data(), c._outputMessages[i].dataSize());
+            }
+            report.memoryLocked &= lockAllMemory();
+            prefaultStack();
+        }
+        report.threadsPinned = profile.networkCpus.empty() || pinCurrentThread(profile.networkCpus);
+        report.prioritiesSet = profile.networkPriority <= 0 || setCurrentThreadPriority(profile.networkPriority);
+        // the workers exist before the simulations start, so starting them doesn't fault during the run
+        if (!profile.workerCpus.empty() || profile.workerPriority > 0)
+        {
+            if (_stepPool == nullptr)
+            {
+                startStepPool();
+            }
+            report.threadsPinned &= _workersPinned.load();
+            report.prioritiesSet &= _workerPrioritiesSet.load();
+        }
+        report.threadsPinned &= !profile.networkCpus.empty() || !profile.workerCpus.empty();
+        report.prioritiesSet &= profile.networkPriority > 0 || profile.workerPriority > 0;
+        _startUsage = getResourceUsage();
+    }
+
+    void SimulationServer::setRealTimeProfile(const RealTimeProfile & profile)
+    {
+        _realTimeProfile = profile;
+        // the workers are started again with the settings
+        _stepPool.reset();
+    }
+
+    RealTimeReport SimulationServer::getRealTimeReport() const
+    {
+        RealTimeReport res = _realTimeReport;
+        if (_realTimeProfile.isEnabled())
+        {
+            const ResourceUsage usage = getResourceUsage();
+            res.numPageFaults = usage.numPageFaults - _startUsage.numPageFaults;
+            res.heapGrowth = static_cast<int64_t>(usage.heapBytes) - static_cast<int64_t>(_startUsage.heapBytes);
+        }
+        return res;
+    }
+
+    void SimulationServer::runStep(const int & simId)
+    {
+        // the session isn't changed while stepSimulations() runs and every step only touches its own messages
+        ClientSession & c = *_clients[_currentClient];
+        const ValueContainerMessage<ClientMessageSpecifyer> & inputs = c._inputMessages[simId];
+        ValueContainerMessage<ServerMessageSpecifyer> & outputs = c._outputMessages[simId];
+        const uint64_t start = getMonotonicNs();
+        c._stepCallbacks[simId](inputs.getTime(), inputs.getContainer(), outputs.getContainer());
+        c._computeTime.record(getMonotonicNs() - start);
+        outputs.setSpecifyer(ServerMessageSpecifyer::OUTPUTS);
+        outputs.setTime(inputs.getTime());
+    }
+
+    void SimulationServer::answerStep(const int & simId, const std::exception_ptr & error, const bool & answer)
+    {
+        if (simId < 0)
+        {
+            return;
+        }
+        ClientSession & c = client();
+        c._isStepping[simId] = false;
+        if (error)
+        {
+            // the client is aborted after the running steps, a single failed step can't be answered
+            if (!c._stepError)
+            {
+                c._stepError = error;
+            }
+        }
+        else if (answer && !c._stepError)
+        {
+            sendMessage(simId);
+        }
+    }
+
+    void SimulationServer::waitForStep(const int & simId)
+    {
+        ClientSession & c = client();
+        std::exception_ptr error;
+        while (c._isStepping[simId])
+        {
+            _netServer.flush();
+            const int finished = _stepPool->waitFinished(error);
+            if (finished < 0)
+            {
+                break;
+            }
+            answerStep(finished, error);
+        }
+    }
+
+    void SimulationServer::finishSteps(const bool & answer)
+    {
+        _netServer.flush();
+        std::exception_ptr error;
+        for (int simId = _stepPool->waitFinished(error); simId >= 0; simId = _stepPool->waitFinished(error))
+        {
+            answerStep(simId, error, answer);
+        }
+    }
+
+    ClientMessageSpecifyer SimulationServer::abortSteps()
+    {
+        ClientSession & c = client();
+        finishSteps(false);
+        c._handledLastRequest = false;
+        c._lastSpec = ClientMessageSpecifyer::CLIENT_ABORT;
+        return c._lastSpec;
+    }
+
+    std::exception_ptr SimulationServer::getStepError() const
+    {
+        return client()._stepError;
+    }
+
     void SimulationServer::prepareSimulationFile(std::shared_ptr<char> & data)
     {
+        ClientSession & c = client();
         std::cout << "Prepare FMU " << std::endl;
         GetFileMessage message(data);
-        _lastSimulationFile = message.getFilePath();
-        _lastSimId = message.getSimId();
+        c._lastSimulationFile = message.getFilePath();
+        c._lastSimId = message.getSimId();
     }
 
     std::string SimulationServer::getSimulationFileName() const
     {
-        return _lastSimulationFile;
+        const ClientSession & c = client();
+        return c._lastSimulationFile;
     }
 
     void SimulationServer::prepareStart()
@@ -347,57 +1008,198 @@ namespace NetOff
 
     ClientMessageSpecifyer SimulationServer::getClientRequest()
     {
-        if (!_handledLastRequest || _currentState < CurrentState::STARTED)
+        ClientSession & c = client();
+        if (!c._handledLastRequest || c._currentState < CurrentState::STARTED)
         {
             throw std::runtime_error("SimulationServer: Last request wasn't handled or the server wasn't started.");
         }
-        _handledLastRequest = false;
-        int simId = recvMessage();  // sets id and data in _outputContainer[simId]
-        _lastSpec = _inputMessages[simId].getSpecifyer();
-        _lastReceivedTime[simId] = _inputMessages[simId].getTime();
-        std::cout << "Got SPEC = " << _lastSpec << '\n';
-        return _lastSpec;
+        c._handledLastRequest = false;
+        if (!recvMessage())  // sets id and data in _inputMessages[simId]
+        {
+            // the client vanished, which is handled like an abort
+            c._lastSpec = ClientMessageSpecifyer::CLIENT_ABORT;
+            return c._lastSpec;
+        }
+        return evaluateRequest();
+    }
+
+    ClientMessageSpecifyer SimulationServer::evaluateRequest()
+    {
+        ClientSession & c = client();
+        c._handledLastRequest = false;
+        if (c._lastSimId == FrameHeader::allSims)
+        {
+            for (size_t simId = 0; simId < c._inputMessages.size(); ++simId)
+            {
+                c._lastReceivedTime[simId] = c._inputMessages[simId].getTime();
+            }
+            c._lastSpec = ClientMessageSpecifyer::INPUTS_ALL;
+            return c._lastSpec;
+        }
+        c._lastSpec = c._inputMessages[c._lastSimId].getSpecifyer();
+        if (c._lastSpec == ClientMessageSpecifyer::SUBSCRIBE || c._lastSpec == ClientMessageSpecifyer::UNSUBSCRIBE)
+        {
+            // the time of a subscription is its period, the next step of the simulation is pushed
+            c._subscriptionPeriods[c._lastSimId] = (c._lastSpec == ClientMessageSpecifyer::SUBSCRIBE) ?
+                    std::max(0.0, c._inputMessages[c._lastSimId].getTime()) : -1.0;
+            c._nextPushTimes[c._lastSimId] = -std::numeric_limits<double>::max();
+            c._handledLastRequest = true;
+            return c._lastSpec;
+        }
+        c._lastReceivedTime[c._lastSimId] = c._inputMessages[c._lastSimId].getTime();
+        return c._lastSpec;
     }
 
     ValueContainer & SimulationServer::getInputValueContainer(const int & simId)
     {
-        if (!_isInitialized[_lastSimId] || _currentState < CurrentState::INITED)
+        ClientSession & c = client();
+        if (static_cast<size_t>(simId) >= c._isInitialized.size() || !c._isInitialized[simId]
+                || _currentState < CurrentState::INITED)
         {
             throw std::runtime_error("SimulationServer: Cannot create input container. Server not started.");
         }
-        return _inputMessages[simId].getContainer();
+        return c._inputMessages[simId].getContainer();
     }
 
     ValueContainer & SimulationServer::getOutputValueContainer(const int & simId)
     {
-        if (!_isInitialized[_lastSimId] || _currentState < CurrentState::INITED)
+        ClientSession & c = client();
+        if (static_cast<size_t>(simId) >= c._isInitialized.size() || !c._isInitialized[simId]
+                || _currentState < CurrentState::INITED)
         {
             throw std::runtime_error("SimulationServer: Cannot create input container. Server not started.");
         }
-        return _outputMessages[simId].getContainer();
+        // a queued output may still be sent from this container
+        _netServer.syncBuffer(c._outputBufferIds[simId]);
+        return c._outputMessages[simId].getContainer();
     }
 
     const double & SimulationServer::getLastReceivedTime(const int & simId) const
     {
-        return _lastReceivedTime[simId];
+        const ClientSession & c = client();
+        return c._lastReceivedTime[simId];
     }
 
     std::shared_ptr<char> SimulationServer::recvInitialMessage()
     {
-        return _netServer.variableRecv();
+        size_t numBytes = 0;
+        std::shared_ptr<char> res = connection().variableRecv(&numBytes);
+        if (res != nullptr)
+        {
+            // every message starts with its specifier, variableSend() prefixes the size
+            client()._traffic.countReceived(*reinterpret_cast<const InitialClientMessageSpecifyer *>(res.get()),
+                                            sizeof(int) + numBytes);
+        }
+        return res;
+    }
+
+    bool SimulationServer::recvFrameHeader(FrameHeader & header)
+    {
+        ClientSession & c = client();
+        const uint64_t start = getMonotonicNs();
+        if (!connection().recv(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            return false;
+        }
+        c._headerNs = getMonotonicNs();
+        c._waitTime.record(c._headerNs - start);
+        if (header.simId == FrameHeader::allSims)
+        {
+            int numBytes = 0;
+            for (const ValueContainerMessage<ClientMessageSpecifyer> & message : c._inputMessages)
+            {
+                numBytes += static_cast<int>(message.dataSize());
+            }
+            // a malformed frame of one client must not stop the server, the client is treated as lost
+            return header.numBytes == numBytes;
+        }
+        return header.simId >= 0 && static_cast<size_t>(header.simId) < c._inputMessages.size()
+                && header.numBytes == static_cast<int>(c._inputMessages[header.simId].dataSize());
+    }
+
+    bool SimulationServer::recvMessage()
+    {
+        FrameHeader header;
+        return recvFrameHeader(header) && recvPayload(header);
+    }
+
+    bool SimulationServer::recvPayload(const FrameHeader & header)
+    {
+        ClientSession & c = client();
+        c._lastSimId = header.simId;
+        if (header.simId != FrameHeader::allSims)
+        {
+            c._lastReceivedSeq[header.simId] = header.seq;
+            if (!connection().recv(c._inputMessages[header.simId].data(), c._inputMessages[header.simId].dataSize()))
+            {
+                return false;
+            }
+            c._traffic.countReceived(c._inputMessages[header.simId].getSpecifyer(), sizeof(header) + header.numBytes);
+            c._receivedNs[header.simId] = c._headerNs;
+            return true;
+        }
+        c._lastBatchSeq = header.seq;
+        if (!connection().recv(c._inputArena.data(), c._inputArena.size()))
+        {
+            return false;
+        }
+        c._traffic.countReceived(ClientMessageSpecifyer::INPUTS_ALL, sizeof(header) + header.numBytes);
+        c._batchReceivedNs = c._headerNs;
+        return true;
+    }
+
+    SimulationServer::ClientSession & SimulationServer::client()
+    {
+        if (_currentClient < 0)
+        {
+            throw std::runtime_error("SimulationServer: No client selected.");
+        }
+        return *_clients[_currentClient];
     }
 
-    int SimulationServer::recvSimulationId()
+    const SimulationServer::ClientSession & SimulationServer::client() const
     {
-        _netServer.recv(reinterpret_cast<char *>(&_lastSimId), sizeof(int));
-        return _lastSimId;
+        if (_currentClient < 0)
+        {
+            throw std::runtime_error("SimulationServer: No client selected.");
+        }
+        return *_clients[_currentClient];
     }
 
-    int SimulationServer::recvMessage()
+    SimulationServer::ClientSession & SimulationServer::session(const int & clientId)
     {
-        recvSimulationId();
-        _netServer.recv(_inputMessages[_lastSimId].data(), _inputMessages[_lastSimId].dataSize());
-        return _lastSimId;
+        if (clientId < 0 || static_cast<size_t>(clientId) >= _clients.size() || _clients[clientId] == nullptr)
+        {
+            throw std::runtime_error("SimulationServer: Client " + std::to_string(clientId) + " isn't connected.");
+        }
+        return *_clients[clientId];
+    }
+
+    const SimulationServer::ClientSession & SimulationServer::session(const int & clientId) const
+    {
+        if (clientId < 0 || static_cast<size_t>(clientId) >= _clients.size() || _clients[clientId] == nullptr)
+        {
+            throw std::runtime_error("SimulationServer: Client " + std::to_string(clientId) + " isn't connected.");
+        }
+        return *_clients[clientId];
+    }
+
+    NetworkConnection & SimulationServer::connection()
+    {
+        return _netServer.getConnection(_currentClient);
+    }
+
+    int SimulationServer::openSession(const int & clientId)
+    {
+        if (static_cast<size_t>(clientId) >= _clients.size())
+        {
+            _clients.resize(clientId + 1);
+        }
+        if (_clients[clientId] == nullptr)
+        {
+            _clients[clientId].reset(new ClientSession());
+        }
+        return clientId;
     }
 
     bool SimulationServer::isActive() const
@@ -0,0 +1,249 @@
+/*
+ * Statistics.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace NetOff
+{
+
+    namespace
+    {
+        /*! Every power of two is split into 2^subBits buckets. */
+        const unsigned subBits = 2;
+
+        const unsigned numSub = 1u << subBits;
+
+        /*! Durations up to 2^(maxExponent + 1) ns are told apart. */
+        const unsigned maxExponent = 41;
+
+        static_assert((maxExponent - subBits + 2) * numSub == LatencyHistogram::numBuckets,
+                "The number of buckets has to match the exponents.");
+
+        unsigned floorLog2(const uint64_t & value)
+        {
+#ifdef __GNUC__
+            return 63 - __builtin_clzll(value);
+#else
+            unsigned res = 0;
+            for (uint64_t v = value >> 1; v > 0; v >>= 1)
+            {
+                ++res;
+            }
+            return res;
+#endif
+        }
+
+        const char * const messageTypeNames[SimulationStatistics::numMessageTypes] = { "START", "ADD_SIM", "INIT_SIM",
+                "CLIENT_INIT_ABORT", "GET_FILE", "", "", "", "PAUSE", "UNPAUSE", "RESET", "INPUTS", "CLIENT_ABORT",
+                "SUCCESS_ADD_SIM", "SUCCESS_START", "SUCCESS_GET_FILE", "SERVER_INIT_ABORT", "SUCCESS_SIM_INIT",
+                "SUCCESS_PAUSE", "SUCCESS_UNPAUSE", "SUCCESS_RESET", "OUTPUTS", "SERVER_ABORT", "INPUTS_ALL", "SUBSCRIBE",
+                "UNSUBSCRIBE", "STEPPED" };
+    }
+
+    uint64_t getMonotonicNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    NetworkCounters LiveNetworkCounters::get() const
+    {
+        NetworkCounters res;
+        res.numSendCalls = numSendCalls.get();
+        res.numRecvCalls = numRecvCalls.get();
+        res.numBytesSent = numBytesSent.get();
+        res.numBytesReceived = numBytesReceived.get();
+        return res;
+    }
+
+    void LiveNetworkCounters::reset()
+    {
+        numSendCalls.reset();
+        numRecvCalls.reset();
+        numBytesSent.reset();
+        numBytesReceived.reset();
+    }
+
+    LatencyHistogram::Snapshot::Snapshot()
+            : buckets(),
+              count(0),
+              sumNs(0),
+              maxNs(0)
+    {
+    }
+
+    double LatencyHistogram::Snapshot::getMeanUs() const
+    {
+        return (count > 0) ? sumNs / 1e3 / count : 0.0;
+    }
+
+    double LatencyHistogram::Snapshot::getMaxUs() const
+    {
+        return maxNs / 1e3;
+    }
+
+    double LatencyHistogram::Snapshot::getPercentileUs(const double & quantile) const
+    {
+        if (count == 0)
+        {
+            return 0.0;
+        }
+        // the buckets are copied one after another, so their sum may differ from count
+        uint64_t total = 0;
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            total += buckets[i];
+        }
+        const double rank = std::max(1.0, quantile * total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i + 1 < numBuckets; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                return std::min(getBucketStart(i + 1), maxNs) / 1e3;
+            }
+        }
+        return getMaxUs();
+    }
+
+    LatencyHistogram::LatencyHistogram()
+            : _count(0),
+              _sumNs(0),
+              _maxNs(0)
+    {
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            _buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t LatencyHistogram::getBucket(const uint64_t & ns)
+    {
+        if (ns < numSub)
+        {
+            return static_cast<size_t>(ns);
+        }
+        const unsigned exponent = floorLog2(ns);
+        if (exponent > maxExponent)
+        {
+            return numBuckets - 1;
+        }
+        return (exponent - subBits + 1) * numSub + ((ns >> (exponent - subBits)) & (numSub - 1));
+    }
+
+    uint64_t LatencyHistogram::getBucketStart(const size_t & bucket)
+    {
+        if (bucket < numSub)
+        {
+            return bucket;
+        }
+        const unsigned exponent = static_cast<unsigned>(bucket / numSub) + subBits - 1;
+        return static_cast<uint64_t>(numSub + bucket % numSub) << (exponent - subBits);
+    }
+
+    void LatencyHistogram::record(const uint64_t & ns)
+    {
+        _buckets[getBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sumNs.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = _maxNs.load(std::memory_order_relaxed);
+        while (ns > max && !_maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const
+    {
+        Snapshot res;
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            res.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        }
+        res.count = _count.load(std::memory_order_relaxed);
+        res.sumNs = _sumNs.load(std::memory_order_relaxed);
+        res.maxNs = _maxNs.load(std::memory_order_relaxed);
+        return res;
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (size_t i = 0; i < numBuckets; ++i)
+        {
+            _buckets[i].store(0, std::memory_order_relaxed);
+        }
+        _count.store(0, std::memory_order_relaxed);
+        _sumNs.store(0, std::memory_order_relaxed);
+        _maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    SimulationStatistics::SimulationStatistics()
+            : messages(),
+              network(),
+              stepLatencies(),
+              batchLatency(),
+              computeTime(),
+              waitTime()
+    {
+    }
+
+    const char * SimulationStatistics::getMessageTypeName(const size_t & type)
+    {
+        return (type < numMessageTypes) ? messageTypeNames[type] : "";
+    }
+
+    MessageTraffic::MessageTraffic()
+            : _types()
+    {
+    }
+
+    void MessageTraffic::countSent(const int & type, const size_t & numBytes)
+    {
+        if (type < 0 || static_cast<size_t>(type) >= SimulationStatistics::numMessageTypes)
+        {
+            return;
+        }
+        _types[type].numSent.add(1);
+        _types[type].numBytesSent.add(numBytes);
+    }
+
+    void MessageTraffic::countReceived(const int & type, const size_t & numBytes)
+    {
+        if (type < 0 || static_cast<size_t>(type) >= SimulationStatistics::numMessageTypes)
+        {
+            return;
+        }
+        _types[type].numReceived.add(1);
+        _types[type].numBytesReceived.add(numBytes);
+    }
+
+    void MessageTraffic::copyTo(SimulationStatistics & statistics) const
+    {
+        for (size_t i = 0; i < SimulationStatistics::numMessageTypes; ++i)
+        {
+            statistics.messages[i].numSent = _types[i].numSent.get();
+            statistics.messages[i].numBytesSent = _types[i].numBytesSent.get();
+            statistics.messages[i].numReceived = _types[i].numReceived.get();
+            statistics.messages[i].numBytesReceived = _types[i].numBytesReceived.get();
+        }
+    }
+
+    void MessageTraffic::reset()
+    {
+        for (size_t i = 0; i < SimulationStatistics::numMessageTypes; ++i)
+        {
+            _types[i].numSent.reset();
+            _types[i].numBytesSent.reset();
+            _types[i].numReceived.reset();
+            _types[i].numBytesReceived.reset();
+        }
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,270 @@
+/*
+ * StepPool.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "StepPool.hpp"
+
+#include <algorithm>
+
+namespace NetOff
+{
+
+    namespace
+    {
+        /*! Pool and worker index of the calling thread, if it's a worker. */
+        thread_local StepPool * currentPool = nullptr;
+        thread_local size_t currentWorker = 0;
+    }
+
+    StepPool::StepPool(const size_t & numThreads, const StepFunction & step, const ThreadFunction & onStart)
+            : _step(step),
+              _onStart(onStart),
+              _workers(),
+              _nextWorker(0),
+              _numQueued(0),
+              _mutex(),
+              _workAvailable(),
+              _stepFinished(),
+              _finished(),
+              _numPending(0),
+              _numStarted(0),
+              _stop(false)
+    {
+        const size_t num = std::max(numThreads, static_cast<size_t>(1));
+        // all queues exist before the first worker looks for work to steal
+        for (size_t i = 0; i < num; ++i)
+        {
+            _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        }
+        for (size_t i = 0; i < num; ++i)
+        {
+            _workers[i]->thread = std::thread(&StepPool::run, this, i);
+        }
+        if (_onStart)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (_numStarted < num)
+            {
+                _stepFinished.wait(lock);
+            }
+        }
+    }
+
+    StepPool::~StepPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _workAvailable.notify_all();
+        for (std::unique_ptr<Worker> & worker : _workers)
+        {
+            worker->thread.join();
+        }
+    }
+
+    size_t StepPool::getNumThreads() const
+    {
+        return _workers.size();
+    }
+
+    void StepPool::submit(const int & id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_numPending;
+        }
+        push(_nextWorker, Task { id, nullptr, 0 });
+        _nextWorker = (_nextWorker + 1) % _workers.size();
+    }
+
+    int StepPool::waitFinished(std::exception_ptr & error)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_finished.empty() && _numPending > 0)
+        {
+            _stepFinished.wait(lock);
+        }
+        return popFinished(error);
+    }
+
+    int StepPool::tryFinished(std::exception_ptr & error)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return popFinished(error);
+    }
+
+    size_t StepPool::getNumPending() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numPending;
+    }
+
+    void StepPool::runSubTasks(const size_t & numTasks, const SubTaskFunction & task)
+    {
+        StepPool * pool = currentPool;
+        if (pool == nullptr || numTasks < 2)
+        {
+            for (size_t i = 0; i < numTasks; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+        SubTaskGroup group(&task, numTasks);
+        // the first task is run right away, the others wait for thieves or for the caller
+        for (size_t i = numTasks - 1; i > 0; --i)
+        {
+            pool->push(currentWorker, Task { -1, &group, i });
+        }
+        pool->execute(Task { -1, &group, 0 });
+        while (group.numRemaining.load(std::memory_order_acquire) > 0)
+        {
+            Task next;
+            if (pool->pop(currentWorker, next))
+            {
+                pool->execute(next);
+            }
+            else
+            {
+                // the last sub-tasks are running on other workers
+                std::this_thread::yield();
+            }
+        }
+        if (group.error)
+        {
+            std::rethrow_exception(group.error);
+        }
+    }
+
+    int StepPool::popFinished(std::exception_ptr & error)
+    {
+        error = nullptr;
+        if (_finished.empty())
+        {
+            return -1;
+        }
+        Finished & finished = _finished.front();
+        const int id = finished.id;
+        error.swap(finished.error);
+        _finished.popFront();
+        --_numPending;
+        return id;
+    }
+
+    void StepPool::push(const size_t & index, const Task & task)
+    {
+        // counted before it can be popped and before the idle workers check under _mutex, so no wakeup gets lost
+        _numQueued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(_workers[index]->mutex);
+            _workers[index]->tasks.pushBack(task);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+        }
+        _workAvailable.notify_one();
+    }
+
+    bool StepPool::pop(const size_t & index, Task & task)
+    {
+        {
+            Worker & own = *_workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = own.tasks.back();
+                own.tasks.popBack();
+                _numQueued.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t i = 1; i < _workers.size(); ++i)
+        {
+            Worker & victim = *_workers[(index + i) % _workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = victim.tasks.front();
+                victim.tasks.popFront();
+                _numQueued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void StepPool::execute(const Task & task)
+    {
+        std::exception_ptr error;
+        try
+        {
+            if (task.group != nullptr)
+            {
+                (*task.group->function)(task.index);
+            }
+            else
+            {
+                _step(task.id);
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        if (task.group != nullptr)
+        {
+            if (error)
+            {
+                std::lock_guard<std::mutex> lock(task.group->errorMutex);
+                if (!task.group->error)
+                {
+                    task.group->error = error;
+                }
+            }
+            // the group lives on the stack of runSubTasks(), it must not be touched after the last task is counted
+            task.group->numRemaining.fetch_sub(1, std::memory_order_acq_rel);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished.pushBack(Finished(task.id, error));
+        _stepFinished.notify_one();
+    }
+
+    void StepPool::run(const size_t & index)
+    {
+        currentPool = this;
+        currentWorker = index;
+        if (_onStart)
+        {
+            _onStart(index);
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_numStarted;
+            _stepFinished.notify_all();
+        }
+        while (true)
+        {
+            Task task;
+            if (pop(index, task))
+            {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stop && _numQueued.load() == 0)
+            {
+                _workAvailable.wait(lock);
+            }
+            // queued steps are finished before the pool stops, they refer to memory of their owner
+            if (_stop && _numQueued.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+} /* namespace NetOff */
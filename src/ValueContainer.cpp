@@ -6,6 +6,7 @@
  */
 
 #include "ValueContainer.hpp"
+#include "BufferPool.hpp"
 #include <algorithm>
 
 namespace NetOff
@@ -54,7 +55,7 @@ namespace NetOff
         std::swap(_numReal, vc._numReal);
         std::swap(_numInt, vc._numInt);
         std::swap(_numBool, vc._numBool);
-        std::swap(_data, vc._data);
+        std::swap(_dataPtr, vc._dataPtr);
         std::swap(_realData, vc._realData);
         std::swap(_intData, vc._intData);
         std::swap(_boolData, vc._boolData);
@@ -141,7 +142,8 @@ namespace NetOff
     {
         std::tie(_numReal, _numInt, _numBool) = std::tie(numReal, numInt, numBool);
         _dataSize = calcDataSize();
-        _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+        _data = BufferPool::allocate(_dataSize);
+        _dataPtr = _data.get();
         _id = -1;
         setPointers();
     }
@@ -6,6 +6,7 @@
  */
 
 #include "VariableList.hpp"
+#include "BufferPool.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
 
 #include <algorithm>
@@ -101,14 +102,14 @@ namespace NetOff
 
     std::shared_ptr<const char> VariableList::data() const
     {
-        std::shared_ptr<char> res(new char[dataSize()], std::default_delete<char[]>());
+        std::shared_ptr<char> res = BufferPool::allocate(dataSize());
         saveVariablesTo(res.get());
         return res;
     }
 
     std::shared_ptr<char> VariableList::data()
     {
-        std::shared_ptr<char> res(new char[dataSize()], std::default_delete<char[]>());
+        std::shared_ptr<char> res = BufferPool::allocate(dataSize());
         saveVariablesTo(res.get());
         return res;
     }
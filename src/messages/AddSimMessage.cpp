@@ -6,6 +6,7 @@
  */
 
 #include "messages/AddSimMessage.hpp"
+#include "BufferPool.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
 
 namespace NetOff
@@ -21,7 +22,7 @@ namespace NetOff
               _dataSize(0)
     {
         _dataSize = sizeof(InitialClientMessageSpecifyer) + sizeof(int) + getStringDataSize(path);
-        _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+        _data = BufferPool::allocate(_dataSize);
         char * p = _data.get();
         p = saveShiftIntegralInData(InitialClientMessageSpecifyer::ADD_SIM, p);
         p = saveShiftIntegralInData(id, p);
@@ -72,7 +73,7 @@ namespace NetOff
               _dataSize(0)
     {
         _dataSize = sizeof(InitialServerMessageSpecifyer) + sizeof(int) + inputs.dataSize() + outputs.dataSize();
-        _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+        _data = BufferPool::allocate(_dataSize);
         char * p = _data.get();
         p = saveShiftIntegralInData(InitialServerMessageSpecifyer::SUCCESS_ADD_SIM, p);
         p = saveShiftIntegralInData(id, p);
@@ -6,6 +6,7 @@
  */
 
 #include "messages/InitSimulationMessage.hpp"
+#include "BufferPool.hpp"
 #include "network_impl/SimNetworkFunctions.hpp"
 
 namespace NetOff
@@ -23,7 +24,7 @@ namespace NetOff
     {
         _dataSize = sizeof(InitialClientMessageSpecifyer) + sizeof(int) + 3 * sizeof(size_t) + inputs.dataSize()
                 + outputs.dataSize();
-        _data = std::shared_ptr<char>(new char[_dataSize], std::default_delete<char[]>());
+        _data = BufferPool::allocate(_dataSize);
         char * p = _data.get();
 
         // Data structure: [ Specifyer | id | inputs | outputs | numReals | reals | numInts | ints | numBools | bools ]
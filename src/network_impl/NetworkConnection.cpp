@@ -0,0 +1,110 @@
+/*
+ * NetworkConnection.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/NetworkConnection.hpp"
+#include "network_impl/UringEngine.hpp"
+
+namespace NetOff
+{
+
+    NetworkConnection::NetworkConnection(const SocketHandle & socket, const ConnectionOptions & options)
+            : NetworkMember(),
+              _negotiated(false),
+              _offer(sharedMemoryOfferSize),
+              _offerBytes(0)
+    {
+        _socket = socket;
+        setOptions(options);
+    }
+
+    NetworkConnection::~NetworkConnection()
+    {
+    }
+
+    bool NetworkConnection::negotiateTransport()
+    {
+        if (!recv(_offer.data() + _offerBytes, sharedMemoryOfferSize - _offerBytes))
+        {
+            _negotiated = true;
+            return false;
+        }
+        _offerBytes = sharedMemoryOfferSize;
+        return answerOffer();
+    }
+
+    bool NetworkConnection::continueNegotiation()
+    {
+        const int numBytes = recvAvailable(_offer.data() + _offerBytes, sharedMemoryOfferSize - _offerBytes);
+        if (numBytes < 0)
+        {
+            _negotiated = true;
+            return false;
+        }
+        _offerBytes += numBytes;
+        return _offerBytes < sharedMemoryOfferSize || answerOffer();
+    }
+
+    bool NetworkConnection::answerOffer()
+    {
+        _negotiated = true;
+        return answerSharedMemoryOffer(_offer.data());
+    }
+
+    bool NetworkConnection::isNegotiated() const
+    {
+        return _negotiated;
+    }
+
+    bool NetworkConnection::attachEngine(UringEngine & engine, const int & tag)
+    {
+        if (_shm != nullptr || !engine.addConnection(tag, _socket))
+        {
+            return false;
+        }
+        _uring = &engine;
+        _uringTag = tag;
+        return true;
+    }
+
+    bool NetworkConnection::isAttached() const
+    {
+        return _uring != nullptr;
+    }
+
+    bool NetworkConnection::queueSend(const NetworkBuffer * parts, const int & numParts)
+    {
+        if (_uring == nullptr)
+        {
+            return sendv(parts, numParts);
+        }
+        // a closed connection is seen by the next receive
+        _uring->queueSend(_uringTag, parts, numParts);
+        for (int i = 0; i < numParts; ++i)
+        {
+            _counters.numBytesSent.add(parts[i].size);
+        }
+        return true;
+    }
+
+    void NetworkConnection::deinitialize()
+    {
+        if (_uring != nullptr)
+        {
+            _uring->removeConnection(_uringTag);
+            _uring = nullptr;
+        }
+        closeSharedMemory();
+        killSocket(_socket);
+        resetRecvBuffer();
+    }
+
+    char NetworkConnection::getChar() const
+    {
+        return 'S';
+    }
+
+} /* namespace NetOff */
@@ -1,89 +1,256 @@
 /*
- * NetworkClient.cpp
+ * NetworkMember.cpp
  *
  *  Created on: 07.04.2016
  *      Author: Marc Hartung
  */
 
 #include "network_impl/NetworkMember.hpp"
+#include "network_impl/UringEngine.hpp"
+#include "BufferPool.hpp"
 
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
 namespace NetOff
 {
 
-    NetworkMember::NetworkMember()
-            : _socket(nullptr),
-              _maxBuffer(1024),
-              _sleepTime(1000),
-              _numMaxSleeps(100)
-    {
+    // Backend independent parts of NetworkMember. The socket primitives are implemented in posix/ and sdl/.
 
+    ConnectionOptions::ConnectionOptions()
+            : highWaterMark(std::numeric_limits<int>::max()),
+              connectionTimeout(100000),
+              initialBackoff(10),
+              maxBackoff(100000),
+              sendBufferSize(0),
+              recvBufferSize(0),
+              noDelay(true),
+              sharedMemoryBytes(1 << 20),
+              waitPolicy(WaitPolicy::BLOCK),
+              spinUs(50),
+              recvTimeout(-1)
+    {
     }
 
-    NetworkMember::~NetworkMember()
+    /*! \brief First message on a new connection: the shared memory segment a client offers. */
+    struct SharedMemoryOffer
     {
-        killSocket(_socket);
-    }
+        /*! Ring size per direction, 0 for an empty offer. */
+        uint64_t ringBytes;
+        uint64_t token;
+        char name[48];
+    };
+
+    const int NetworkMember::sharedMemoryOfferSize = sizeof(SharedMemoryOffer);
 
     bool NetworkMember::send(const char* buffer, const int & num)
     {
-        int numBits = -1;
-        int i = 0;
-        while (i < num)
+        NetworkBuffer part = { buffer, num };
+        return sendv(&part, 1);
+    }
+
+    bool NetworkMember::sendv(const NetworkBuffer * parts, const int & numParts)
+    {
+        // frames queued in the engine were sent earlier and have to leave first
+        if (_uring != nullptr)
         {
-            int partNum = std::min(num, i + _maxBuffer) - i;
-            numBits = SDLNet_TCP_Send(_socket, static_cast<const void *>(&buffer[i]), partNum);
+            _uring->flush();
+        }
+        int curPart = 0, offset = 0;
+        while (true)
+        {
+            // skip everything that's already sent, the first remaining part is advanced by offset
+            while (curPart < numParts && offset >= parts[curPart].size)
+            {
+                offset -= parts[curPart].size;
+                ++curPart;
+            }
+            if (curPart == numParts)
+            {
+                return true;
+            }
 
-            if (numBits > 0)
-                i += numBits;
-            else if (i == numBits && i < num)
+            int numBytes = sendSome(parts + curPart, numParts - curPart, offset);
+            _counters.numSendCalls.add(1);
+            if (numBytes < 0)
             {
                 std::cout << "Connection send fail.\n";
                 return false;
             }
+            _counters.numBytesSent.add(numBytes);
+            offset += numBytes;
         }
-
-        //std::cout << getChar() << " sending " << num << " bytes\n";
-        return true;
     }
 
     bool NetworkMember::recv(char* buffer, const int & num)
     {
-        int numBytes = -1;
-        int i = 0;
+        // serve from the read ahead buffer first
+        int i = std::min(static_cast<int>(_recvEnd - _recvBegin), num);
+        std::copy(_recvBuffer.data() + _recvBegin, _recvBuffer.data() + _recvBegin + i, buffer);
+        _recvBegin += i;
+
         while (i < num)
         {
-            unsigned partNum = std::min(num, i + _maxBuffer) - i;
-            numBytes = SDLNet_TCP_Recv(_socket, &buffer[i], partNum);
-            if (numBytes > 0)
-                i += numBytes;
-            else if (i == 0 && i < num)
+            // the read ahead buffer is empty here, so the missing bytes go straight to the destination and
+            // whatever follows them is kept for the next call
+            int numBytes = recvSome(&buffer[i], num - i, _recvBuffer.data(), _recvBuffer.size());
+            _counters.numRecvCalls.add(1);
+            if (numBytes <= 0)
             {
-                std::cout << "Connection recv fail.\n";
+                std::cout << "Connection recv fail" << ((numBytes == 0) ? ": Connection closed." : "") << "\n";
                 return false;
             }
+            _counters.numBytesReceived.add(numBytes);
+            int direct = std::min(numBytes, num - i);
+            i += direct;
+            _recvBegin = 0;
+            _recvEnd = numBytes - direct;
+        }
+        return true;
+    }
+
+    int NetworkMember::recvAvailable(char * buffer, const int & num)
+    {
+        int i = std::min(static_cast<int>(_recvEnd - _recvBegin), num);
+        std::copy(_recvBuffer.data() + _recvBegin, _recvBuffer.data() + _recvBegin + i, buffer);
+        _recvBegin += i;
+        if (i == num || !waitReadable(0))
+        {
+            return i;
+        }
+
+        // a readable connection returns at least one byte or reports the closed connection right away
+        int numBytes = recvSome(&buffer[i], num - i, _recvBuffer.data(), _recvBuffer.size());
+        _counters.numRecvCalls.add(1);
+        if (numBytes <= 0)
+        {
+            std::cout << "Connection recv fail" << ((numBytes == 0) ? ": Connection closed." : "") << "\n";
+            return -1;
+        }
+        _counters.numBytesReceived.add(numBytes);
+        int direct = std::min(numBytes, num - i);
+        _recvBegin = 0;
+        _recvEnd = numBytes - direct;
+        return i + direct;
+    }
+
+    SocketHandle NetworkMember::nativeHandle() const
+    {
+        return _socket;
+    }
+
+    bool NetworkMember::hasBufferedData() const
+    {
+        return _recvBegin < _recvEnd || (_shm != nullptr && _shm->hasData())
+                || (_uring != nullptr && _uring->isReadable(_uringTag));
+    }
+
+    /*! Prefix of Unix domain socket addresses. */
+    static const std::string unixSocketPrefix = "unix:";
+
+    bool NetworkMember::isUnixSocketAddress(const std::string & address)
+    {
+        return address.compare(0, unixSocketPrefix.size(), unixSocketPrefix) == 0;
+    }
+
+    std::string NetworkMember::getUnixSocketPath(const std::string & address)
+    {
+        return address.substr(unixSocketPrefix.size());
+    }
+
+    bool NetworkMember::isSharedMemory() const
+    {
+        return _shm != nullptr;
+    }
+
+    bool NetworkMember::armWakeup()
+    {
+        return _shm == nullptr || _shm->requestWakeup();
+    }
+
+    bool NetworkMember::offerSharedMemory()
+    {
+        SharedMemoryOffer offer = SharedMemoryOffer();
+        std::unique_ptr<ShmChannel> shm(new ShmChannel());
+        if (_options.sharedMemoryBytes > 0 && shm->create(_options.sharedMemoryBytes)
+                && shm->getName().size() < sizeof(offer.name))
+        {
+            offer.ringBytes = shm->getRingBytes();
+            offer.token = shm->getToken();
+            std::copy(shm->getName().begin(), shm->getName().end(), offer.name);
+        }
+        int accepted = 0;
+        if (!send(reinterpret_cast<const char *>(&offer), sizeof(offer))
+                || !recv(reinterpret_cast<char *>(&accepted), sizeof(accepted)))
+        {
+            return false;
+        }
+        // both sides have mapped the segment now or never will
+        shm->unlink();
+        if (accepted == 1 && offer.ringBytes > 0)
+        {
+            useSharedMemory(std::move(shm));
+        }
+        return true;
+    }
 
+    bool NetworkMember::answerSharedMemoryOffer(const char * offerData)
+    {
+        SharedMemoryOffer offer;
+        std::copy(offerData, offerData + sizeof(offer), reinterpret_cast<char *>(&offer));
+        offer.name[sizeof(offer.name) - 1] = '\0';
+        // the segment can only be opened, if the client runs on the same host
+        std::unique_ptr<ShmChannel> shm(new ShmChannel());
+        int accepted = (offer.ringBytes > 0 && _options.sharedMemoryBytes > 0
+                && shm->open(offer.name, offer.token, offer.ringBytes)) ? 1 : 0;
+        if (!send(reinterpret_cast<const char *>(&accepted), sizeof(accepted)))
+        {
+            return false;
+        }
+        if (accepted == 1)
+        {
+            shm->unlink();
+            useSharedMemory(std::move(shm));
         }
-        //std::cout << getChar() << " receiving " << num << " bytes\n";
         return true;
     }
 
+    void NetworkMember::closeSharedMemory()
+    {
+        if (_shm != nullptr)
+        {
+            _shm->close();
+            _shm.reset();
+        }
+    }
+
+    void NetworkMember::resetRecvBuffer()
+    {
+        _recvBegin = 0;
+        _recvEnd = 0;
+    }
+
     bool NetworkMember::variableSend(const char* buffer, const int & num)
     {
         int numCopy = num;
-        if (!send(reinterpret_cast<char *>(&numCopy), sizeof(numCopy))) // Send size
-            return false;
-        return send(buffer, num);                                       // Send buffer
+        NetworkBuffer parts[2] = { { reinterpret_cast<char *>(&numCopy), sizeof(numCopy) },  // size
+                { buffer, num } };                                                          // buffer
+        return sendv(parts, 2);
     }
 
     std::shared_ptr<char> NetworkMember::variableRecv(size_t * numBytes)
     {
         int num = 0;
-        recv(reinterpret_cast<char*>(&num), sizeof(num));
-        std::shared_ptr<char> res(new char[num], std::default_delete<char[]>());
-        recv(res.get(), num);
+        if (!recv(reinterpret_cast<char*>(&num), sizeof(num)) || num < 0)
+        {
+            return std::shared_ptr<char>();
+        }
+        std::shared_ptr<char> res = BufferPool::allocate(num);
+        if (!recv(res.get(), num))
+        {
+            return std::shared_ptr<char>();
+        }
         if (numBytes != nullptr)
         {
             *numBytes = num;
@@ -91,16 +258,85 @@ namespace NetOff
         return res;
     }
 
-    void NetworkMember::killSocket(TCPsocket& socket)
+    void NetworkMember::setSocketBufferSizes(const int & sendBytes, const int & recvBytes)
+    {
+        _options.sendBufferSize = sendBytes;
+        _options.recvBufferSize = recvBytes;
+        applySocketOptions();
+    }
+
+    void NetworkMember::setNoDelay(const bool & noDelay)
     {
+        _options.noDelay = noDelay;
+        applySocketOptions();
+    }
+
+    void NetworkMember::setHighWaterMark(const int & numBytes)
+    {
+        _options.highWaterMark = (numBytes < 1) ? std::numeric_limits<int>::max() : numBytes;
+    }
+
+    int NetworkMember::getHighWaterMark() const
+    {
+        return _options.highWaterMark;
+    }
+
+    void NetworkMember::setWaitPolicy(const WaitPolicy & policy, const int & spinUs)
+    {
+        _options.waitPolicy = policy;
+        _options.spinUs = std::max(0, spinUs);
+        applySocketOptions();
+    }
+
+    const WaitPolicy & NetworkMember::getWaitPolicy() const
+    {
+        return _options.waitPolicy;
+    }
+
+    int NetworkMember::getShmSpinUs() const
+    {
+        switch (_options.waitPolicy)
         {
-            if (socket != nullptr)
-            {
-                SDLNet_TCP_Close(socket);
-                socket = nullptr;
-            }
+            case WaitPolicy::BUSY_POLL:
+                return -1;
+            case WaitPolicy::SPIN_THEN_BLOCK:
+                return _options.spinUs;
+            default:
+                return 0;
         }
     }
 
+    void NetworkMember::setConnectionTimeout(const int & timeoutMs)
+    {
+        _options.connectionTimeout = timeoutMs;
+    }
+
+    void NetworkMember::setRetryBackoff(const unsigned & initialUs, const unsigned & maxUs)
+    {
+        _options.initialBackoff = std::max(1u, initialUs);
+        _options.maxBackoff = std::max(_options.initialBackoff, maxUs);
+    }
+
+    NetworkCounters NetworkMember::getCounters() const
+    {
+        return _counters.get();
+    }
+
+    void NetworkMember::resetCounters()
+    {
+        _counters.reset();
+    }
+
+    void NetworkMember::setOptions(const ConnectionOptions & options)
+    {
+        _options = options;
+        applySocketOptions();
+    }
+
+    const ConnectionOptions & NetworkMember::getOptions() const
+    {
+        return _options;
+    }
+
 } /* namespace NetOff */
 
@@ -1,69 +1,185 @@
 /*
  * NetworkServer.cpp
  *
- *  Created on: 07.04.2016
- *      Author: Marc Hartung
+ *  Created on: 17.10.2026
+ *      Author: agent
  */
 
-#include "../../include/network_impl/NetworkServer.hpp"
+#include "network_impl/NetworkServer.hpp"
+
 #include <iostream>
+#include <stdexcept>
 
 namespace NetOff
 {
 
-    NetworkServer::NetworkServer()
-            : NetworkMember(),
-              _tcpsock(nullptr)
+    /*! Size of the submission queue of the io_uring engine. */
+    static const unsigned uringEntries = 1024;
+
+    // Backend independent parts of NetworkServer. Listening and the event set are implemented in posix/ and sdl/.
+
+    NetworkConnection & NetworkServer::getConnection(const int & id)
     {
+        if (!isConnected(id))
+        {
+            throw std::runtime_error("NetworkServer: Connection " + std::to_string(id) + " isn't open.");
+        }
+        return *_connections[id];
+    }
 
+    const NetworkConnection & NetworkServer::getConnection(const int & id) const
+    {
+        if (!isConnected(id))
+        {
+            throw std::runtime_error("NetworkServer: Connection " + std::to_string(id) + " isn't open.");
+        }
+        return *_connections[id];
     }
 
-    NetworkServer::~NetworkServer()
+    bool NetworkServer::isConnected(const int & id) const
     {
-        killSocket(_tcpsock);
+        return id >= 0 && static_cast<size_t>(id) < _connections.size() && _connections[id] != nullptr;
     }
 
-    bool NetworkServer::initialize(const int & port)
+    size_t NetworkServer::getNumConnections() const
     {
-        IPaddress ip;
-        SDLNet_Init();
+        size_t res = 0;
+        for (const auto & connection : _connections)
+        {
+            if (connection != nullptr)
+            {
+                ++res;
+            }
+        }
+        return res;
+    }
+
+    size_t NetworkServer::getConnectionIdBound() const
+    {
+        return _connections.size();
+    }
 
-        if (SDLNet_ResolveHost(&ip, nullptr, port) == -1)
+    void NetworkServer::setOptions(const ConnectionOptions & options)
+    {
+        _options = options;
+        for (auto & connection : _connections)
         {
-            std::cout << "SDLNet_ResolveHost: " << SDLNet_GetError() << std::endl;
-            return false;
+            if (connection != nullptr)
+            {
+                connection->setOptions(options);
+            }
         }
+    }
+
+    const ConnectionOptions & NetworkServer::getOptions() const
+    {
+        return _options;
+    }
 
-        _tcpsock = SDLNet_TCP_Open(&ip);
-        if (_tcpsock == nullptr)
+    NetworkCounters NetworkServer::getCounters() const
+    {
+        NetworkCounters res = _closedCounters;
+        for (const auto & connection : _connections)
         {
-            std::cout << "SDLNet_TCP_Open: " << SDLNet_GetError() << std::endl;
-            return false;
+            if (connection != nullptr)
+            {
+                const NetworkCounters & c = connection->getCounters();
+                res.numSendCalls += c.numSendCalls;
+                res.numRecvCalls += c.numRecvCalls;
+                res.numBytesSent += c.numBytesSent;
+                res.numBytesReceived += c.numBytesReceived;
+            }
         }
+        return res;
+    }
 
-        _socket = SDLNet_TCP_Accept(_tcpsock);
-        unsigned times = 0;
-        while (_socket == nullptr && times++ <= _numMaxSleeps)
+    int NetworkServer::takeBuffered()
+    {
+        for (size_t n = 0; n < _connections.size(); ++n)
         {
-            SDL_Delay(_sleepTime);
-            std::cout << "Waiting for client on host " << ip.host << " and port " << port << " ..." << std::endl;
-            _socket = SDLNet_TCP_Accept(_tcpsock);
+            size_t id = (_nextBuffered + n) % _connections.size();
+            if (_connections[id] != nullptr && _connections[id]->hasBufferedData())
+            {
+                _nextBuffered = id + 1;
+                return static_cast<int>(id);
+            }
         }
+        return -1;
+    }
 
-        return (_socket != nullptr);
+    void NetworkServer::addClosedCounters(const NetworkCounters & counters)
+    {
+        _closedCounters.numSendCalls += counters.numSendCalls;
+        _closedCounters.numRecvCalls += counters.numRecvCalls;
+        _closedCounters.numBytesSent += counters.numBytesSent;
+        _closedCounters.numBytesReceived += counters.numBytesReceived;
     }
 
-    void NetworkServer::deinitialize()
+    void NetworkServer::setIoUring(const bool & enable)
     {
-        killSocket(_tcpsock);
-        killSocket(_socket);
+        _useUring = enable;
     }
 
-    char NetworkServer::getChar() const
+    bool NetworkServer::isIoUringActive() const
     {
-        return 'S';
+        return _uring != nullptr;
     }
 
+    int NetworkServer::registerBuffer(const char * data, const size_t & size)
+    {
+        return (_uring != nullptr) ? _uring->registerBuffer(data, size) : -1;
+    }
 
-} /* namespace NetOff */
+    void NetworkServer::unregisterBuffer(const int & index)
+    {
+        if (_uring != nullptr)
+        {
+            _uring->unregisterBuffer(index);
+        }
+    }
 
+    void NetworkServer::syncBuffer(const int & index)
+    {
+        if (_uring != nullptr && _uring->isBufferQueued(index))
+        {
+            _uring->flush();
+        }
+    }
+
+    void NetworkServer::flush()
+    {
+        if (_uring != nullptr)
+        {
+            _uring->flush();
+        }
+    }
+
+    bool NetworkServer::startEngine()
+    {
+        if (!_useUring || _uring != nullptr)
+        {
+            return false;
+        }
+        _uring.reset(new UringEngine());
+        if (!_uring->initialize(uringEntries))
+        {
+            std::cout << "NetworkServer: io_uring isn't available, using the event set." << std::endl;
+            _uring.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void NetworkServer::resetCounters()
+    {
+        _closedCounters = NetworkCounters();
+        for (auto & connection : _connections)
+        {
+            if (connection != nullptr)
+            {
+                connection->resetCounters();
+            }
+        }
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,36 @@
+/*
+ * RealTime.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/RealTime.hpp"
+
+namespace NetOff
+{
+
+    RealTimeProfile::RealTimeProfile()
+            : lockMemory(false),
+              networkCpus(),
+              workerCpus(),
+              networkPriority(0),
+              workerPriority(0)
+    {
+    }
+
+    bool RealTimeProfile::isEnabled() const
+    {
+        return lockMemory || !networkCpus.empty() || !workerCpus.empty() || networkPriority > 0 || workerPriority > 0;
+    }
+
+    RealTimeReport::RealTimeReport()
+            : memoryLocked(false),
+              threadsPinned(false),
+              prioritiesSet(false),
+              numPageFaults(0),
+              heapGrowth(0)
+    {
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,188 @@
+/*
+ * NetworkClient.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! \brief Connects to the given address and returns the blocking socket or -1.
+     *
+     * The connect is done non-blocking and waited for with the epoll instance socketSet, so a host that doesn't
+     * answer can't block beyond the deadline.
+     */
+    static int connectTo(const addrinfo * ai, const std::chrono::steady_clock::time_point & deadline, int & socketSet)
+    {
+        int sock = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+        if (sock < 0)
+        {
+            return -1;
+        }
+        if (connect(sock, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            if (errno != EINPROGRESS)
+            {
+                ::close(sock);
+                return -1;
+            }
+            if (socketSet < 0)
+            {
+                socketSet = epoll_create1(EPOLL_CLOEXEC);
+            }
+            epoll_event event;
+            event.events = EPOLLOUT;
+            event.data.fd = sock;
+            epoll_ctl(socketSet, EPOLL_CTL_ADD, sock, &event);
+            int numReady;
+            do
+            {
+                int timeoutMs = -1;
+                if (deadline != std::chrono::steady_clock::time_point::max())
+                {
+                    timeoutMs = std::max<int>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                            deadline - std::chrono::steady_clock::now()).count());
+                }
+                numReady = epoll_wait(socketSet, &event, 1, timeoutMs);
+            }
+            while (numReady < 0 && errno == EINTR);
+            epoll_ctl(socketSet, EPOLL_CTL_DEL, sock, &event);
+
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (numReady <= 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0)
+            {
+                ::close(sock);
+                return -1;
+            }
+        }
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+        return sock;
+    }
+
+    NetworkClient::NetworkClient()
+            : NetworkMember()
+    {
+    }
+
+    bool NetworkClient::initialize(const std::string & host, const int & port)
+    {
+        addrinfo * addresses = nullptr;
+        // a Unix domain socket is a single address, that doesn't need to be resolved
+        sockaddr_un unixAddr;
+        addrinfo unixInfo = addrinfo();
+        const bool isUnix = isUnixSocketAddress(host);
+        if (isUnix)
+        {
+            const std::string path = getUnixSocketPath(host);
+            std::memset(&unixAddr, 0, sizeof(unixAddr));
+            unixAddr.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(unixAddr.sun_path))
+            {
+                std::cout << "NetworkClient: Invalid socket path " << path << std::endl;
+                return false;
+            }
+            std::copy(path.begin(), path.end(), unixAddr.sun_path);
+            unixInfo.ai_family = AF_UNIX;
+            unixInfo.ai_socktype = SOCK_STREAM;
+            unixInfo.ai_addr = reinterpret_cast<sockaddr *>(&unixAddr);
+            unixInfo.ai_addrlen = sizeof(unixAddr);
+            addresses = &unixInfo;
+        }
+        else
+        {
+            addrinfo hints = addrinfo();
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            int res = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+            if (res != 0)
+            {
+                std::cout << "getaddrinfo: " << gai_strerror(res) << std::endl;
+                return false;
+            }
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = (_options.connectionTimeout < 0) ? Clock::time_point::max() :
+                Clock::now() + std::chrono::milliseconds(_options.connectionTimeout);
+        std::chrono::microseconds backoff(_options.initialBackoff);
+        bool printed = false;
+        while (true)
+        {
+            for (addrinfo * ai = addresses; ai != nullptr && _socket < 0; ai = ai->ai_next)
+            {
+                _socket = connectTo(ai, deadline, _socketSet);
+            }
+            Clock::time_point now = Clock::now();
+            if (_socket >= 0 || now >= deadline)
+            {
+                break;
+            }
+            if (!printed)
+            {
+                if (isUnix)
+                {
+                    std::cout << "Waiting for server on socket " << getUnixSocketPath(host) << " ..." << std::endl;
+                }
+                else
+                {
+                    std::cout << "Waiting for server on host " << host << " and port " << port << " ..." << std::endl;
+                }
+                printed = true;
+            }
+            // retry with exponential backoff, starting in the microsecond range
+            std::this_thread::sleep_for(
+                    std::min<Clock::duration>(backoff, std::chrono::duration_cast<Clock::duration>(deadline - now)));
+            backoff = std::min(2 * backoff, std::chrono::microseconds(_options.maxBackoff));
+        }
+        if (!isUnix)
+        {
+            freeaddrinfo(addresses);
+        }
+
+        if (_socket < 0)
+        {
+            std::cout << "no socket" << std::endl;
+            return false;
+        }
+        applySocketOptions();
+        // the first message decides whether the data is exchanged over shared memory
+        if (!offerSharedMemory())
+        {
+            killSocket(_socket);
+            return false;
+        }
+        return true;
+    }
+
+    void NetworkClient::deinitialize()
+    {
+        closeSharedMemory();
+        killSocket(_socket);
+        resetRecvBuffer();
+    }
+
+    char NetworkClient::getChar() const
+    {
+        return 'C';
+    }
+
+} /* namespace NetOff */
+
@@ -0,0 +1,281 @@
+/*
+ * NetworkMember.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkMember.hpp"
+#include "network_impl/UringEngine.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! Maximal number of buffers passed to one sendmsg() call, IOV_MAX of Linux. A batch of all simulations
+     * leaves with one call. */
+    static const int maxGatherParts = 1024;
+
+    NetworkMember::NetworkMember()
+            : _socket(-1),
+              _socketSet(-1),
+              _options(),
+              _counters(),
+              _shm(),
+              _uring(nullptr),
+              _uringTag(-1),
+              _recvBuffer(1 << 16),
+              _recvBegin(0),
+              _recvEnd(0)
+    {
+
+    }
+
+    NetworkMember::~NetworkMember()
+    {
+        killSocket(_socket);
+        killSocket(_socketSet);
+    }
+
+    int NetworkMember::sendSome(const NetworkBuffer * parts, const int & numParts, const int & offset)
+    {
+        if (_shm != nullptr)
+        {
+            int res = _shm->write(parts, numParts, offset, _options.highWaterMark);
+            if (res > 0 && _shm->takeWakeupRequest())
+            {
+                sendWakeup();
+            }
+            return res;
+        }
+
+        // the gather write is limited to _options.highWaterMark bytes per call
+        iovec iov[maxGatherParts];
+        int numIov = 0, numBytes = 0;
+        for (int i = 0; i < numParts && numIov < maxGatherParts && numBytes < _options.highWaterMark; ++i)
+        {
+            int skip = (i == 0) ? offset : 0;
+            int len = std::min(parts[i].size - skip, _options.highWaterMark - numBytes);
+            if (len <= 0)
+            {
+                continue;
+            }
+            iov[numIov].iov_base = const_cast<char *>(parts[i].data + skip);
+            iov[numIov].iov_len = len;
+            numBytes += len;
+            ++numIov;
+        }
+
+        msghdr msg = msghdr();
+        msg.msg_iov = iov;
+        msg.msg_iovlen = numIov;
+        ssize_t res;
+        do
+        {
+            res = sendmsg(_socket, &msg, MSG_NOSIGNAL);
+        }
+        while (res < 0 && errno == EINTR);
+        if (res < 0)
+        {
+            std::cout << "sendmsg: " << std::strerror(errno) << "\n";
+        }
+        return static_cast<int>(res);
+    }
+
+    int NetworkMember::recvSome(char * first, const int & firstNum, char * second, const int & secondNum)
+    {
+        // sockets time out by SO_RCVTIMEO, the shared memory ring and the engine are checked before they block
+        if (_shm != nullptr)
+        {
+            if (_options.recvTimeout >= 0 && !_shm->waitData(_options.recvTimeout))
+            {
+                return -1;
+            }
+            int num = std::min(firstNum, _options.highWaterMark);
+            return _shm->read(first, num, second, std::min(secondNum, _options.highWaterMark - num));
+        }
+        if (_uring != nullptr)
+        {
+            if (_options.recvTimeout >= 0 && !_uring->waitData(_uringTag, _options.recvTimeout))
+            {
+                return -1;
+            }
+            int num = std::min(firstNum, _options.highWaterMark);
+            return _uring->recv(_uringTag, first, num, second, std::min(secondNum, _options.highWaterMark - num));
+        }
+
+        if (_options.waitPolicy != WaitPolicy::BLOCK)
+        {
+            spinReadable();
+        }
+
+        iovec iov[2];
+        iov[0].iov_base = first;
+        iov[0].iov_len = std::min(firstNum, _options.highWaterMark);
+        iov[1].iov_base = second;
+        iov[1].iov_len = std::min(secondNum, _options.highWaterMark - static_cast<int>(iov[0].iov_len));
+        ssize_t res;
+        do
+        {
+            res = readv(_socket, iov, (iov[1].iov_len > 0) ? 2 : 1);
+        }
+        while (res < 0 && errno == EINTR);
+        return static_cast<int>(res);
+    }
+
+    bool NetworkMember::waitReadable(const int & timeoutMs)
+    {
+        if (_recvBegin < _recvEnd)
+        {
+            return true;
+        }
+        if (_shm != nullptr)
+        {
+            return _shm->waitData(timeoutMs);
+        }
+        if (_uring != nullptr)
+        {
+            return _uring->waitData(_uringTag, timeoutMs);
+        }
+        if (_socket < 0 || _socketSet < 0)
+        {
+            return false;
+        }
+        epoll_event event;
+        int numReady;
+        do
+        {
+            numReady = epoll_wait(_socketSet, &event, 1, timeoutMs);
+        }
+        while (numReady < 0 && errno == EINTR);
+        return numReady > 0;
+    }
+
+    void NetworkMember::spinReadable()
+    {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(_options.spinUs);
+        // busy polling ends with the receive timeout, the blocking receive then reports it
+        const Clock::time_point busyDeadline = Clock::now() + std::chrono::milliseconds(_options.recvTimeout);
+        char c;
+        do
+        {
+            // data or a closed connection end the polling, the receive then returns right away
+            ssize_t res = ::recv(_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (res >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                return;
+            }
+        }
+        while (_options.waitPolicy == WaitPolicy::BUSY_POLL ?
+                (_options.recvTimeout < 0 || Clock::now() < busyDeadline) : Clock::now() < deadline);
+    }
+
+    void NetworkMember::applySocketOptions()
+    {
+        if (_shm != nullptr)
+        {
+            _shm->setSpin(getShmSpinUs());
+        }
+        if (_socket < 0)
+        {
+            return;
+        }
+
+        int flag = _options.noDelay ? 1 : 0;
+        setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        if (_options.sendBufferSize > 0)
+        {
+            setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &_options.sendBufferSize, sizeof(_options.sendBufferSize));
+        }
+        if (_options.recvBufferSize > 0)
+        {
+            setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, &_options.recvBufferSize, sizeof(_options.recvBufferSize));
+        }
+        // failures are ignored: raising the budget above net.core.busy_read needs CAP_NET_ADMIN and Unix domain
+        // sockets have no device queue to poll
+        int busyPollUs = (_options.waitPolicy == WaitPolicy::BLOCK) ? 0 : _options.spinUs;
+        setsockopt(_socket, SOL_SOCKET, SO_BUSY_POLL, &busyPollUs, sizeof(busyPollUs));
+        // a zero timeval blocks infinitely
+        timeval recvTimeout = timeval();
+        if (_options.recvTimeout >= 0)
+        {
+            recvTimeout.tv_sec = _options.recvTimeout / 1000;
+            recvTimeout.tv_usec = (_options.recvTimeout % 1000) * 1000;
+            if (_options.recvTimeout == 0)
+            {
+                recvTimeout.tv_usec = 1;
+            }
+        }
+        setsockopt(_socket, SOL_SOCKET, SO_RCVTIMEO, &recvTimeout, sizeof(recvTimeout));
+
+        if (_socketSet < 0)
+        {
+            _socketSet = epoll_create1(EPOLL_CLOEXEC);
+        }
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = _socket;
+        // closing the socket removes it from the epoll instance automatically
+        if (epoll_ctl(_socketSet, EPOLL_CTL_ADD, _socket, &event) != 0 && errno != EEXIST)
+        {
+            std::cout << "epoll_ctl: " << std::strerror(errno) << "\n";
+        }
+    }
+
+    bool NetworkMember::drainWakeups()
+    {
+        char buffer[64];
+        while (true)
+        {
+            ssize_t res = ::recv(_socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (res == 0)
+            {
+                return false;
+            }
+            if (res < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+        }
+    }
+
+    void NetworkMember::useSharedMemory(std::unique_ptr<ShmChannel> && shm)
+    {
+        shm->setPeerSocket(_socket);
+        shm->setSpin(getShmSpinUs());
+        _shm = std::move(shm);
+    }
+
+    void NetworkMember::sendWakeup()
+    {
+        // one byte is enough to make the socket readable, a full socket buffer already is
+        char signal = 0;
+        ::send(_socket, &signal, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    void NetworkMember::killSocket(SocketHandle & socket)
+    {
+        if (socket >= 0)
+        {
+            ::close(socket);
+            socket = -1;
+        }
+    }
+
+} /* namespace NetOff */
+
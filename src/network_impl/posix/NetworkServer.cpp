@@ -0,0 +1,416 @@
+/*
+ * NetworkServer.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkServer.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <limits>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! Event data of the listening socket, connections are tagged with their id. */
+    static const uint64_t listenerTag = std::numeric_limits<uint64_t>::max();
+
+    NetworkServer::NetworkServer()
+            : _listenSocket(-1),
+              _socketPath(),
+              _socketSet(-1),
+              _listenerWatched(false),
+              _maxConnections(1),
+              _nextBuffered(0),
+              _options(),
+              _closedCounters(),
+              _connections(),
+              _useUring(false),
+              _uring(),
+              _eventSetReady(false)
+    {
+
+    }
+
+    NetworkServer::~NetworkServer()
+    {
+        deinitialize();
+    }
+
+    /*! \brief Creates a non-blocking socket listening at the address or returns -1. */
+    static int openListener(const int & family, const sockaddr * addr, const socklen_t & addrLen)
+    {
+        // non-blocking, so a client that gave up between epoll_wait and accept can't block the server
+        int sock = socket(family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (sock < 0)
+        {
+            std::cout << "socket: " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        int reuse = 1;
+        if (family == AF_INET)
+        {
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (bind(sock, addr, addrLen) != 0 || listen(sock, SOMAXCONN) != 0)
+        {
+            std::cout << "bind/listen: " << std::strerror(errno) << std::endl;
+            ::close(sock);
+            return -1;
+        }
+        return sock;
+    }
+
+    bool NetworkServer::initialize(const int & port, const size_t & maxClients)
+    {
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        _listenSocket = openListener(AF_INET, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        if (_listenSocket < 0)
+        {
+            return false;
+        }
+
+        _maxConnections = std::max<size_t>(1, maxClients);
+        if (_socketSet < 0)
+        {
+            _socketSet = epoll_create1(EPOLL_CLOEXEC);
+        }
+        // the engine watches the event set, which keeps the listener and the shared memory connections
+        if (startEngine())
+        {
+            _uring->watchPoll(_socketSet);
+        }
+        updateListener();
+        std::cout << "Waiting for client on port " << port << " ..." << std::endl;
+        return true;
+    }
+
+    bool NetworkServer::initialize(const std::string & socketPath, const size_t & maxClients)
+    {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+        {
+            std::cout << "NetworkServer: Invalid socket path " << socketPath << std::endl;
+            return false;
+        }
+        std::copy(socketPath.begin(), socketPath.end(), addr.sun_path);
+
+        // a socket file nobody listens on anymore is left over by a crashed server and replaced
+        struct stat info;
+        if (stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        {
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (connect(probe, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 && errno == ECONNREFUSED)
+            {
+                ::unlink(socketPath.c_str());
+            }
+            ::close(probe);
+        }
+        _listenSocket = openListener(AF_UNIX, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        if (_listenSocket < 0)
+        {
+            return false;
+        }
+        _socketPath = socketPath;
+
+        _maxConnections = std::max<size_t>(1, maxClients);
+        if (_socketSet < 0)
+        {
+            _socketSet = epoll_create1(EPOLL_CLOEXEC);
+        }
+        // the engine watches the event set, which keeps the listener and the shared memory connections
+        if (startEngine())
+        {
+            _uring->watchPoll(_socketSet);
+        }
+        updateListener();
+        std::cout << "Waiting for client on socket " << socketPath << " ..." << std::endl;
+        return true;
+    }
+
+    int NetworkServer::acceptConnection()
+    {
+        if (_listenSocket < 0)
+        {
+            return -1;
+        }
+        pollfd pfd;
+        pfd.fd = _listenSocket;
+        pfd.events = POLLIN;
+        int numReady;
+        do
+        {
+            numReady = poll(&pfd, 1, _options.connectionTimeout);
+        }
+        while (numReady < 0 && errno == EINTR);
+        int id = (numReady > 0) ? acceptPending() : -1;
+        if (id >= 0 && !_connections[id]->negotiateTransport())
+        {
+            closeConnection(id);
+            return -1;
+        }
+        if (id >= 0)
+        {
+            attachConnection(id);
+        }
+        return id;
+    }
+
+    int NetworkServer::waitForData(const int & timeoutMs)
+    {
+        // read ahead data isn't reported by epoll, so these connections are served first
+        int buffered = takeBuffered();
+        if (buffered >= 0)
+        {
+            return buffered;
+        }
+        if (_socketSet < 0)
+        {
+            return -1;
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        if (_uring == nullptr && _options.waitPolicy != WaitPolicy::BLOCK && timeoutMs != 0)
+        {
+            // shared memory rings are polled directly, so their clients aren't asked for wakeups while spinning;
+            // a socket event ends the spinning and is handled by the loop below
+            Clock::time_point spinDeadline = Clock::now() + std::chrono::microseconds(_options.spinUs);
+            if (timeoutMs >= 0)
+            {
+                spinDeadline = std::min(spinDeadline, deadline);
+            }
+            epoll_event event;
+            while (epoll_wait(_socketSet, &event, 1, 0) == 0)
+            {
+                buffered = takeBuffered();
+                if (buffered >= 0)
+                {
+                    return buffered;
+                }
+                const Clock::time_point now = Clock::now();
+                if (_options.waitPolicy == WaitPolicy::BUSY_POLL ? (timeoutMs >= 0 && now >= deadline)
+                                                                 : now >= spinDeadline)
+                {
+                    break;
+                }
+            }
+        }
+        while (true)
+        {
+            // clients on shared memory signal their next message on the socket, if data arrived meanwhile it's served
+            for (size_t id = 0; id < _connections.size(); ++id)
+            {
+                if (_connections[id] != nullptr && !_connections[id]->armWakeup())
+                {
+                    return static_cast<int>(id);
+                }
+            }
+            int waitMs = timeoutMs;
+            if (timeoutMs >= 0)
+            {
+                waitMs = std::max<int>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count());
+            }
+            // level triggered epoll re-queues a reported socket at the end of its ready list, so asking for a
+            // single event hands out ready connections round robin
+            epoll_event event;
+            int numReady;
+            if (_uring != nullptr)
+            {
+                // the engine reports its connections directly and the event set once it becomes readable, which
+                // is then drained without waiting
+                if (!_eventSetReady)
+                {
+                    int tag = _uring->waitForEvent(waitMs);
+                    if (tag != UringEngine::pollTag)
+                    {
+                        return tag;
+                    }
+                    _eventSetReady = true;
+                }
+                numReady = epoll_wait(_socketSet, &event, 1, 0);
+                if (numReady <= 0)
+                {
+                    _eventSetReady = false;
+                    continue;
+                }
+            }
+            else
+            {
+                numReady = epoll_wait(_socketSet, &event, 1, waitMs);
+                if (numReady < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (numReady <= 0)
+                {
+                    return -1;
+                }
+            }
+            if (event.data.u64 == listenerTag)
+            {
+                acceptPending();
+                continue;
+            }
+            const int id = static_cast<int>(event.data.u64);
+            NetworkConnection & connection = *_connections[id];
+            // the first message of a client is its transport offer, which may arrive in parts; a broken connection
+            // is reported to the caller
+            if (!connection.isNegotiated())
+            {
+                if (!connection.continueNegotiation())
+                {
+                    return id;
+                }
+                if (connection.isNegotiated())
+                {
+                    attachConnection(id);
+                }
+                continue;
+            }
+            if (connection.isSharedMemory() && connection.drainWakeups() && !connection.hasBufferedData())
+            {
+                continue;
+            }
+            return id;
+        }
+    }
+
+    void NetworkServer::stopListening()
+    {
+        if (_listenerWatched)
+        {
+            epoll_event event;
+            epoll_ctl(_socketSet, EPOLL_CTL_DEL, _listenSocket, &event);
+            _listenerWatched = false;
+        }
+        if (_listenSocket >= 0)
+        {
+            ::close(_listenSocket);
+            _listenSocket = -1;
+        }
+        if (!_socketPath.empty())
+        {
+            ::unlink(_socketPath.c_str());
+            _socketPath.clear();
+        }
+    }
+
+    bool NetworkServer::isListening() const
+    {
+        return _listenSocket >= 0;
+    }
+
+    void NetworkServer::closeConnection(const int & id)
+    {
+        if (!isConnected(id))
+        {
+            return;
+        }
+        addClosedCounters(_connections[id]->getCounters());
+        // closing the socket removes it from the epoll instance
+        _connections[id]->deinitialize();
+        _connections[id].reset();
+        updateListener();
+    }
+
+    void NetworkServer::deinitialize()
+    {
+        for (size_t id = 0; id < _connections.size(); ++id)
+        {
+            closeConnection(static_cast<int>(id));
+        }
+        _connections.clear();
+        stopListening();
+        _uring.reset();
+        _eventSetReady = false;
+        if (_socketSet >= 0)
+        {
+            ::close(_socketSet);
+            _socketSet = -1;
+        }
+    }
+
+    int NetworkServer::acceptPending()
+    {
+        int sock = accept4(_listenSocket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (sock < 0)
+        {
+            return -1;
+        }
+        size_t id = 0;
+        while (id < _connections.size() && _connections[id] != nullptr)
+        {
+            ++id;
+        }
+        if (id == _connections.size())
+        {
+            _connections.emplace_back();
+        }
+        _connections[id].reset(new NetworkConnection(sock, _options));
+        watchConnection(static_cast<int>(id));
+        updateListener();
+        return static_cast<int>(id);
+    }
+
+    void NetworkServer::watchConnection(const int & id)
+    {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = static_cast<uint64_t>(id);
+        if (epoll_ctl(_socketSet, EPOLL_CTL_ADD, _connections[id]->nativeHandle(), &event) != 0)
+        {
+            std::cout << "epoll_ctl: " << std::strerror(errno) << "\n";
+        }
+    }
+
+    void NetworkServer::attachConnection(const int & id)
+    {
+        if (_uring == nullptr || _connections[id]->isSharedMemory())
+        {
+            return;
+        }
+        epoll_event event;
+        epoll_ctl(_socketSet, EPOLL_CTL_DEL, _connections[id]->nativeHandle(), &event);
+        if (!_connections[id]->attachEngine(*_uring, id))
+        {
+            watchConnection(id);
+        }
+    }
+
+    void NetworkServer::updateListener()
+    {
+        // a full server stops accepting, further clients wait in the backlog until a connection is closed
+        bool watch = _listenSocket >= 0 && _socketSet >= 0 && getNumConnections() < _maxConnections;
+        if (watch == _listenerWatched)
+        {
+            return;
+        }
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = listenerTag;
+        epoll_ctl(_socketSet, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, _listenSocket, &event);
+        _listenerWatched = watch;
+    }
+
+} /* namespace NetOff */
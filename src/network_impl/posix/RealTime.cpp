@@ -0,0 +1,93 @@
+/*
+ * RealTime.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/RealTime.hpp"
+
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! Bytes of the stack touched by prefaultStack(). */
+    static const size_t prefaultStackBytes = 64 * 1024;
+
+    ResourceUsage getResourceUsage()
+    {
+        ResourceUsage res = ResourceUsage();
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+            res.numPageFaults = usage.ru_minflt + usage.ru_majflt;
+        }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        res.heapBytes = info.uordblks + info.hblkhd;
+#endif
+        return res;
+    }
+
+    bool lockBuffer(const char * data, const size_t & size)
+    {
+        if (data == nullptr || size == 0)
+        {
+            return true;
+        }
+        // writing makes the kernel map a private page, a read could map the shared zero page
+        const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        volatile char * bytes = const_cast<volatile char *>(data);
+        for (size_t i = 0; i < size; i += pageSize)
+        {
+            bytes[i] = bytes[i];
+        }
+        bytes[size - 1] = bytes[size - 1];
+        return mlock(data, size) == 0;
+    }
+
+    bool lockAllMemory()
+    {
+        return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    }
+
+    void prefaultStack()
+    {
+        const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        volatile char stack[prefaultStackBytes];
+        for (size_t i = 0; i < prefaultStackBytes; i += pageSize)
+        {
+            stack[i] = 0;
+        }
+        static_cast<void>(stack[0]);
+    }
+
+    bool pinCurrentThread(const std::vector<int> & cpus)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int & cpu : cpus)
+        {
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
+            {
+                return false;
+            }
+            CPU_SET(cpu, &set);
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    bool setCurrentThreadPriority(const int & priority)
+    {
+        sched_param param = sched_param();
+        param.sched_priority = priority;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,507 @@
+/*
+ * ShmChannel.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/ShmChannel.hpp"
+#include "network_impl/NetworkMember.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <random>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! Identifies a netoff segment, "NETOFFSH" */
+    static const uint64_t segmentMagic = 0x4e45544f46465348ull;
+
+    /*! While waiting for the peer, it's checked this often whether its socket was closed. */
+    static const int peerCheckMs = 100;
+
+    /*! Tells the core, that this is a polling loop. Saves power and frees resources for a sibling hyperthread. */
+    static inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    /*! \brief State of one direction. Producer and consumer fields are on different cache lines. */
+    struct ShmChannel::Ring
+    {
+        // written by the producer: bytes written in total, doorbell of the consumer, producer waits for space
+        alignas(64) std::atomic<uint64_t> head;
+        std::atomic<uint32_t> dataSeq;
+        std::atomic<uint32_t> producerWaiting;
+
+        // written by the consumer: bytes read in total, doorbell of the producer, consumer waits for data
+        alignas(64) std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> spaceSeq;
+        std::atomic<uint32_t> consumerWaiting;
+        std::atomic<uint32_t> wakeupRequested;
+    };
+
+    /*! \brief Header at the start of the segment, the ring data follows. */
+    struct ShmChannel::Segment
+    {
+        uint64_t magic;
+        uint64_t token;
+        uint64_t ringBytes;
+        std::atomic<uint32_t> closed[2];
+        Ring rings[2];
+    };
+
+    ShmChannel::ShmChannel()
+            : _segment(nullptr),
+              _mappedBytes(0),
+              _ringBytes(0),
+              _name(),
+              _peerSocket(-1),
+              _spinUs(0),
+              _side(0)
+    {
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+        close();
+        unlink();
+    }
+
+    bool ShmChannel::create(const size_t & ringBytes)
+    {
+        // rings are a power of two, so positions wrap with a mask
+        size_t size = 4096;
+        while (size < ringBytes)
+        {
+            size *= 2;
+        }
+
+        static std::atomic<unsigned> counter(0);
+        std::random_device random;
+        uint64_t token = (static_cast<uint64_t>(random()) << 32) ^ random()
+                ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        std::string name = "/netoff-" + std::to_string(getpid()) + "-" + std::to_string(counter++) + "-"
+                + std::to_string(token & 0xffff);
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            return false;
+        }
+        const size_t total = dataOffset() + 2 * size;
+        void * addr = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(total)) == 0)
+        {
+            addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        _segment = new (addr) Segment();
+        _segment->magic = segmentMagic;
+        _segment->token = token;
+        _segment->ringBytes = size;
+        for (int i = 0; i < 2; ++i)
+        {
+            _segment->closed[i].store(0);
+            Ring & ring = _segment->rings[i];
+            ring.head.store(0);
+            ring.dataSeq.store(0);
+            ring.producerWaiting.store(0);
+            ring.tail.store(0);
+            ring.spaceSeq.store(0);
+            ring.consumerWaiting.store(0);
+            ring.wakeupRequested.store(0);
+        }
+        _mappedBytes = total;
+        _ringBytes = size;
+        _name = name;
+        _side = 0;
+        return true;
+    }
+
+    bool ShmChannel::open(const std::string & name, const uint64_t & token, const size_t & ringBytes)
+    {
+        // the size comes from the peer, positions only wrap with a mask in a ring of a power of two
+        if (ringBytes == 0 || (ringBytes & (ringBytes - 1)) != 0
+                || ringBytes > (std::numeric_limits<size_t>::max() - dataOffset()) / 2)
+        {
+            return false;
+        }
+        int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            return false;
+        }
+        const size_t total = dataOffset() + 2 * ringBytes;
+        struct stat info;
+        void * addr = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == total)
+        {
+            addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            return false;
+        }
+
+        Segment * segment = static_cast<Segment *>(addr);
+        if (segment->magic != segmentMagic || segment->token != token || segment->ringBytes != ringBytes)
+        {
+            munmap(addr, total);
+            return false;
+        }
+        _segment = segment;
+        _mappedBytes = total;
+        _ringBytes = ringBytes;
+        _name = name;
+        _side = 1;
+        return true;
+    }
+
+    void ShmChannel::unlink()
+    {
+        if (!_name.empty())
+        {
+            shm_unlink(_name.c_str());
+            _name.clear();
+        }
+    }
+
+    void ShmChannel::close()
+    {
+        if (_segment == nullptr)
+        {
+            return;
+        }
+        // wake the peer wherever it waits, it sees the closed flag afterwards
+        _segment->closed[_side].store(1);
+        for (Ring & ring : _segment->rings)
+        {
+            ring.dataSeq.fetch_add(1);
+            wake(ring.dataSeq);
+            ring.spaceSeq.fetch_add(1);
+            wake(ring.spaceSeq);
+        }
+        munmap(_segment, _mappedBytes);
+        _segment = nullptr;
+        _mappedBytes = 0;
+        _ringBytes = 0;
+        _peerSocket = -1;
+    }
+
+    bool ShmChannel::isOpen() const
+    {
+        return _segment != nullptr;
+    }
+
+    const std::string & ShmChannel::getName() const
+    {
+        return _name;
+    }
+
+    uint64_t ShmChannel::getToken() const
+    {
+        return (_segment != nullptr) ? _segment->token : 0;
+    }
+
+    size_t ShmChannel::getRingBytes() const
+    {
+        return _ringBytes;
+    }
+
+    void ShmChannel::setPeerSocket(const int & socket)
+    {
+        _peerSocket = socket;
+    }
+
+    void ShmChannel::setSpin(const int & spinUs)
+    {
+        _spinUs = spinUs;
+    }
+
+    int ShmChannel::write(const NetworkBuffer * parts, const int & numParts, const int & offset, const int & maxBytes)
+    {
+        Ring & ring = outRing();
+        const uint64_t size = _ringBytes;
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t used;
+        while ((used = head - ring.tail.load(std::memory_order_acquire)) >= size)
+        {
+            // the tail is written by the peer, a tail ahead of the head means it's broken
+            if (used > size)
+            {
+                return -1;
+            }
+            // ring is full, sleep until the consumer made space
+            uint32_t seq = ring.spaceSeq.load();
+            ring.producerWaiting.store(1);
+            bool timedOut = false;
+            if (head - ring.tail.load() == size)
+            {
+                timedOut = !waitFor(ring.spaceSeq, seq, peerCheckMs);
+            }
+            ring.producerWaiting.store(0);
+            if (_segment->closed[1 - _side].load() || (timedOut && !isPeerAlive()))
+            {
+                return -1;
+            }
+        }
+        const uint64_t space = size - used;
+
+        char * data = ringData(_side);
+        const uint64_t mask = size - 1;
+        const uint64_t limit = std::min<uint64_t>(space, static_cast<uint64_t>(maxBytes));
+        uint64_t num = 0;
+        for (int i = 0; i < numParts && num < limit; ++i)
+        {
+            const int skip = (i == 0) ? offset : 0;
+            uint64_t len = std::min<uint64_t>(parts[i].size - skip, limit - num);
+            const char * src = parts[i].data + skip;
+            // the copy is split, if it wraps around the end of the ring
+            uint64_t pos = (head + num) & mask;
+            uint64_t first = std::min(len, size - pos);
+            std::memcpy(data + pos, src, first);
+            std::memcpy(data, src + first, len - first);
+            num += len;
+        }
+        ring.head.store(head + num, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring.consumerWaiting.load())
+        {
+            ring.dataSeq.fetch_add(1);
+            wake(ring.dataSeq);
+        }
+        return static_cast<int>(num);
+    }
+
+    int ShmChannel::read(char * first, const int & firstNum, char * second, const int & secondNum)
+    {
+        if (!waitData(-1))
+        {
+            return 0;
+        }
+        Ring & ring = inRing();
+        const uint64_t size = _ringBytes;
+        const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        const uint64_t avail = ring.head.load(std::memory_order_acquire) - tail;
+        // the head is written by the peer, more data than fits into the ring means it's broken
+        if (avail > size)
+        {
+            return 0;
+        }
+
+        const char * data = ringData(1 - _side);
+        const uint64_t mask = size - 1;
+        uint64_t num = 0;
+        char * dest[2] = { first, second };
+        const int destNum[2] = { firstNum, secondNum };
+        for (int i = 0; i < 2 && num < avail; ++i)
+        {
+            uint64_t len = std::min<uint64_t>(avail - num, static_cast<uint64_t>(std::max(0, destNum[i])));
+            uint64_t pos = (tail + num) & mask;
+            uint64_t part = std::min(len, size - pos);
+            std::memcpy(dest[i], data + pos, part);
+            std::memcpy(dest[i] + part, data, len - part);
+            num += len;
+        }
+        ring.tail.store(tail + num, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring.producerWaiting.load())
+        {
+            ring.spaceSeq.fetch_add(1);
+            wake(ring.spaceSeq);
+        }
+        return static_cast<int>(num);
+    }
+
+    bool ShmChannel::waitData(const int & timeoutMs)
+    {
+        if (_segment == nullptr)
+        {
+            return false;
+        }
+        if (_spinUs != 0 && timeoutMs != 0 && spinData(_spinUs, timeoutMs))
+        {
+            return true;
+        }
+        Ring & ring = inRing();
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        while (!hasData())
+        {
+            if (_segment->closed[1 - _side].load())
+            {
+                return false;
+            }
+            int waitMs = peerCheckMs;
+            if (timeoutMs >= 0)
+            {
+                waitMs = std::min<int>(waitMs, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count());
+                if (waitMs <= 0)
+                {
+                    return false;
+                }
+            }
+            // announce the wait before the last check, so the producer can't miss it
+            uint32_t seq = ring.dataSeq.load();
+            ring.consumerWaiting.store(1);
+            bool timedOut = false;
+            if (ring.head.load() == ring.tail.load(std::memory_order_relaxed))
+            {
+                timedOut = !waitFor(ring.dataSeq, seq, waitMs);
+            }
+            ring.consumerWaiting.store(0);
+            if (timedOut && !hasData() && !isPeerAlive())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ShmChannel::spinData(const int & spinUs, const int & timeoutMs)
+    {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point start = Clock::now();
+        Clock::time_point deadline = Clock::time_point::max();
+        if (spinUs > 0)
+        {
+            deadline = start + std::chrono::microseconds(spinUs);
+        }
+        if (timeoutMs >= 0)
+        {
+            deadline = std::min(deadline, start + std::chrono::milliseconds(timeoutMs));
+        }
+        Clock::time_point nextPeerCheck = start + std::chrono::milliseconds(peerCheckMs);
+        unsigned numPolls = 0;
+        while (!hasData())
+        {
+            cpuRelax();
+            // reading the clock costs more than a poll of the ring
+            if ((++numPolls & 63) != 0)
+            {
+                continue;
+            }
+            if (_segment->closed[1 - _side].load())
+            {
+                return false;
+            }
+            Clock::time_point now = Clock::now();
+            if (now >= deadline)
+            {
+                return false;
+            }
+            if (now >= nextPeerCheck)
+            {
+                if (!isPeerAlive())
+                {
+                    return false;
+                }
+                nextPeerCheck = now + std::chrono::milliseconds(peerCheckMs);
+            }
+        }
+        return true;
+    }
+
+    bool ShmChannel::hasData() const
+    {
+        const Ring & ring = inRing();
+        return ring.head.load(std::memory_order_acquire) != ring.tail.load(std::memory_order_relaxed);
+    }
+
+    bool ShmChannel::requestWakeup()
+    {
+        Ring & ring = inRing();
+        ring.wakeupRequested.store(1);
+        return ring.head.load() == ring.tail.load(std::memory_order_relaxed);
+    }
+
+    bool ShmChannel::takeWakeupRequest()
+    {
+        // called after write(), whose fence orders the published data before this check
+        Ring & ring = outRing();
+        return ring.wakeupRequested.load() != 0 && ring.wakeupRequested.exchange(0) != 0;
+    }
+
+    size_t ShmChannel::dataOffset()
+    {
+        return (sizeof(Segment) + 63) & ~size_t(63);
+    }
+
+    ShmChannel::Ring & ShmChannel::outRing() const
+    {
+        return _segment->rings[_side];
+    }
+
+    ShmChannel::Ring & ShmChannel::inRing() const
+    {
+        return _segment->rings[1 - _side];
+    }
+
+    char * ShmChannel::ringData(const int & ringId) const
+    {
+        return reinterpret_cast<char *>(_segment) + dataOffset() + ringId * _ringBytes;
+    }
+
+    bool ShmChannel::waitFor(std::atomic<uint32_t> & word, const uint32_t & value, const int & timeoutMs)
+    {
+        timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000l;
+        // the segment is shared between processes, so the non-private futex operations are needed
+        long res = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, value,
+                           (timeoutMs < 0) ? nullptr : &timeout, nullptr, 0);
+        return !(res != 0 && errno == ETIMEDOUT);
+    }
+
+    void ShmChannel::wake(std::atomic<uint32_t> & word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    bool ShmChannel::isPeerAlive() const
+    {
+        if (_segment->closed[1 - _side].load())
+        {
+            return false;
+        }
+        if (_peerSocket < 0)
+        {
+            return true;
+        }
+        char c;
+        ssize_t res = ::recv(_peerSocket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return res > 0 || (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+    }
+
+} /* namespace NetOff */
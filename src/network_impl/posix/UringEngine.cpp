@@ -0,0 +1,951 @@
+/*
+ * UringEngine.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/UringEngine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace NetOff
+{
+
+    /*! Number of provided buffers of the multishot receives, a power of two. */
+    static const unsigned numRecvBuffers = 64;
+
+    static const unsigned recvBufferBytes = 1 << 14;
+
+    static const uint16_t recvBufferGroup = 0;
+
+    /*! Size of the sparse table of registerBuffer(). */
+    static const unsigned maxRegisteredBuffers = 1024;
+
+    /*! Smaller payloads are copied, pinning pages and waiting for the zero copy notification costs more. */
+    static const int zeroCopyBytes = 1 << 14;
+
+    /*! Parts of the queued frames of a connection, the memory of a connection is reserved for. */
+    static const size_t numReservedParts = 64;
+
+    /*! Tags are stored with 16 bits in the user data of a request. */
+    static const int maxTags = 1 << 16;
+
+    /*! Kind of a request, stored in the upper byte of its user data. */
+    enum RequestType : uint64_t
+    {
+        RECV_REQUEST = 1,
+        SEND_REQUEST = 2,
+        POLL_REQUEST = 3,
+        CANCEL_REQUEST = 4
+    };
+
+    /*! User data layout: type (8 bit) | generation (16 bit) | tag (16 bit) | index (24 bit). */
+    static uint64_t makeUserData(const RequestType & type, const uint16_t & generation, const int & tag,
+                                 const size_t & index)
+    {
+        return (static_cast<uint64_t>(type) << 56) | (static_cast<uint64_t>(generation) << 40)
+                | (static_cast<uint64_t>(tag & 0xffff) << 24) | (static_cast<uint64_t>(index) & 0xffffff);
+    }
+
+    static int uringSetup(const unsigned & entries, io_uring_params * params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    static int uringEnter(const int & fd, const unsigned & toSubmit, const unsigned & minComplete,
+                          const unsigned & flags, void * arg, const size_t & argSize)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+    }
+
+    static int uringRegister(const int & fd, const unsigned & opcode, void * arg, const unsigned & numArgs)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, numArgs));
+    }
+
+    /*! \brief Returns true, if the kernel of the ring supports the request opcode. */
+    static bool uringSupports(const int & fd, const unsigned & opcode)
+    {
+        // the ops follow the probe, the flexible array of the kernel header is misplaced in C++
+        std::vector<char> memory(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op), 0);
+        io_uring_probe * probe = reinterpret_cast<io_uring_probe *>(memory.data());
+        if (uringRegister(fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) != 0 || opcode > probe->last_op)
+        {
+            return false;
+        }
+        const io_uring_probe_op * ops = reinterpret_cast<const io_uring_probe_op *>(probe + 1);
+        return (ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    /*! \brief The memory shared with the kernel: submission and completion queue and the provided buffers. */
+    struct UringEngine::Rings
+    {
+        void * sqRing;
+        size_t sqRingBytes;
+        void * cqRing;
+        size_t cqRingBytes;
+        io_uring_sqe * sqes;
+        size_t sqesBytes;
+
+        unsigned * sqHead;
+        unsigned * sqTail;
+        unsigned sqMask;
+        unsigned sqEntries;
+        /*! Tail including the prepared, not yet published entries. */
+        unsigned localTail;
+        unsigned submittedTail;
+
+        unsigned * cqHead;
+        unsigned * cqTail;
+        unsigned cqMask;
+        io_uring_cqe * cqes;
+
+        io_uring_buf_ring * bufRing;
+        size_t bufRingBytes;
+        char * bufData;
+        uint16_t bufTail;
+
+        Rings()
+                : sqRing(MAP_FAILED),
+                  sqRingBytes(0),
+                  cqRing(MAP_FAILED),
+                  cqRingBytes(0),
+                  sqes(nullptr),
+                  sqesBytes(0),
+                  sqHead(nullptr),
+                  sqTail(nullptr),
+                  sqMask(0),
+                  sqEntries(0),
+                  localTail(0),
+                  submittedTail(0),
+                  cqHead(nullptr),
+                  cqTail(nullptr),
+                  cqMask(0),
+                  cqes(nullptr),
+                  bufRing(nullptr),
+                  bufRingBytes(0),
+                  bufData(nullptr),
+                  bufTail(0)
+        {
+        }
+
+        Rings(const Rings &) = delete;
+
+        Rings & operator=(const Rings &) = delete;
+
+        ~Rings()
+        {
+            if (cqRing != MAP_FAILED && cqRing != sqRing)
+            {
+                munmap(cqRing, cqRingBytes);
+            }
+            if (sqRing != MAP_FAILED)
+            {
+                munmap(sqRing, sqRingBytes);
+            }
+            if (sqes != nullptr)
+            {
+                munmap(sqes, sqesBytes);
+            }
+            if (bufRing != nullptr)
+            {
+                munmap(bufRing, bufRingBytes);
+            }
+            delete[] bufData;
+        }
+
+        unsigned numFreeSqes() const
+        {
+            return sqEntries - (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+        }
+
+        /*! Hands a provided buffer back to the kernel. */
+        void recycle(const uint16_t & bufferId)
+        {
+            // the entries start at the ring itself, the flexible array of the kernel header is misplaced in C++
+            io_uring_buf * buf = reinterpret_cast<io_uring_buf *>(bufRing) + (bufTail & (numRecvBuffers - 1));
+            buf->addr = reinterpret_cast<uint64_t>(bufData + static_cast<size_t>(bufferId) * recvBufferBytes);
+            buf->len = recvBufferBytes;
+            buf->bid = bufferId;
+            ++bufTail;
+            __atomic_store_n(&bufRing->tail, bufTail, __ATOMIC_RELEASE);
+        }
+    };
+
+    UringEngine::Connection::Connection()
+            : socket(-1),
+              generation(0),
+              active(false),
+              closed(false),
+              zeroCopy(true),
+              pending(),
+              pendingBegin(0),
+              staging(),
+              queued()
+    {
+    }
+
+    UringEngine::UringEngine()
+            : _ringFd(-1),
+              _rings(nullptr),
+              _connections(),
+              _queuedTags(),
+              _sendOps(),
+              _sendsInFlight(0),
+              _registered(),
+              _registeredByAddress(),
+              _pollFd(-1),
+              _pollReady(false)
+    {
+    }
+
+    UringEngine::~UringEngine()
+    {
+        close();
+    }
+
+    bool UringEngine::initialize(const unsigned & entries)
+    {
+        close();
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = uringSetup(entries, &params);
+        if (fd < 0)
+        {
+            return false;
+        }
+        // waiting with a timeout needs EXT_ARG. Zero copy sends appeared together with multishot receives in Linux
+        // 6.0, an older kernel would fail every send and close all connections.
+        const unsigned needed = IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+        if ((params.features & needed) != needed || !uringSupports(fd, IORING_OP_SEND_ZC))
+        {
+            ::close(fd);
+            return false;
+        }
+        _ringFd = fd;
+        _rings = new Rings();
+        Rings & r = *_rings;
+
+        r.sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        r.cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            r.sqRingBytes = r.cqRingBytes = std::max(r.sqRingBytes, r.cqRingBytes);
+        }
+        r.sqRing = mmap(nullptr, r.sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                        IORING_OFF_SQ_RING);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            r.cqRing = r.sqRing;
+        }
+        else
+        {
+            r.cqRing = mmap(nullptr, r.cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                            IORING_OFF_CQ_RING);
+        }
+        r.sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void * sqes = mmap(nullptr, r.sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQES);
+        r.sqes = (sqes == MAP_FAILED) ? nullptr : static_cast<io_uring_sqe *>(sqes);
+        if (r.sqRing == MAP_FAILED || r.cqRing == MAP_FAILED || r.sqes == nullptr)
+        {
+            close();
+            return false;
+        }
+
+        char * sq = static_cast<char *>(r.sqRing);
+        r.sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        r.sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        r.sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        r.sqEntries = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+        unsigned * sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < r.sqEntries; ++i)
+        {
+            sqArray[i] = i;
+        }
+        r.localTail = r.submittedTail = *r.sqTail;
+
+        char * cq = static_cast<char *>(r.cqRing);
+        r.cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        r.cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        r.cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        r.cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        // the multishot receives pick their memory from a ring of provided buffers
+        r.bufRingBytes = numRecvBuffers * sizeof(io_uring_buf);
+        void * bufRing = mmap(nullptr, r.bufRingBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufRing == MAP_FAILED)
+        {
+            close();
+            return false;
+        }
+        r.bufRing = static_cast<io_uring_buf_ring *>(bufRing);
+        r.bufData = new char[static_cast<size_t>(numRecvBuffers) * recvBufferBytes];
+        io_uring_buf_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(r.bufRing);
+        reg.ring_entries = numRecvBuffers;
+        reg.bgid = recvBufferGroup;
+        if (uringRegister(_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+        {
+            close();
+            return false;
+        }
+        for (unsigned i = 0; i < numRecvBuffers; ++i)
+        {
+            r.recycle(static_cast<uint16_t>(i));
+        }
+
+        // slots for registerBuffer(), without them all payloads are copied
+        io_uring_rsrc_register table;
+        std::memset(&table, 0, sizeof(table));
+        table.nr = maxRegisteredBuffers;
+        table.flags = IORING_RSRC_REGISTER_SPARSE;
+        if (uringRegister(_ringFd, IORING_REGISTER_BUFFERS2, &table, sizeof(table)) == 0)
+        {
+            _registered.assign(maxRegisteredBuffers, RegisteredBuffer { nullptr, 0, 0 });
+        }
+        return true;
+    }
+
+    void UringEngine::close()
+    {
+        // the provided buffers are freed below, so no receive may be pending when the ring goes away
+        for (size_t tag = 0; tag < _connections.size(); ++tag)
+        {
+            removeConnection(static_cast<int>(tag));
+        }
+        if (_ringFd >= 0)
+        {
+            ::close(_ringFd);
+            _ringFd = -1;
+        }
+        delete _rings;
+        _rings = nullptr;
+        _connections.clear();
+        _queuedTags.clear();
+        _sendOps.clear();
+        _sendsInFlight = 0;
+        _registered.clear();
+        _registeredByAddress.clear();
+        _pollFd = -1;
+        _pollReady = false;
+    }
+
+    bool UringEngine::isActive() const
+    {
+        return _ringFd >= 0 && _rings != nullptr;
+    }
+
+    bool UringEngine::watchPoll(const int & fd)
+    {
+        if (!isActive())
+        {
+            return false;
+        }
+        _pollFd = fd;
+        return postPoll();
+    }
+
+    bool UringEngine::addConnection(const int & tag, const SocketHandle & socket)
+    {
+        if (!isActive() || tag < 0 || tag >= maxTags)
+        {
+            return false;
+        }
+        if (static_cast<size_t>(tag) >= _connections.size())
+        {
+            _connections.resize(tag + 1);
+        }
+        Connection & c = _connections[tag];
+        c.socket = socket;
+        c.active = true;
+        c.closed = false;
+        c.zeroCopy = true;
+        c.pending.clear();
+        c.pendingBegin = 0;
+        // the buffers grow on the first use otherwise, the steps of a started connection shouldn't allocate
+        c.pending.reserve(recvBufferBytes);
+        c.staging.reserve(zeroCopyBytes);
+        c.queued.reserve(numReservedParts);
+        _queuedTags.reserve(_connections.size());
+        _sendOps.reserve(_connections.size() * numReservedParts);
+        return postRecv(tag);
+    }
+
+    void UringEngine::removeConnection(const int & tag)
+    {
+        if (!isActive() || tag < 0 || static_cast<size_t>(tag) >= _connections.size() || !_connections[tag].active)
+        {
+            return;
+        }
+        // the last answers leave before the connection is closed
+        flush();
+        Connection & c = _connections[tag];
+        io_uring_sqe * sqe = prepareSqe();
+        if (sqe != nullptr)
+        {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = makeUserData(RECV_REQUEST, c.generation, tag, 0);
+            sqe->user_data = makeUserData(CANCEL_REQUEST, 0, tag, 0);
+        }
+        // completions of the old receive are recognized by the generation and dropped
+        c.active = false;
+        ++c.generation;
+        c.pending.clear();
+        c.pendingBegin = 0;
+        enter(0, 0);
+    }
+
+    bool UringEngine::isReadable(const int & tag) const
+    {
+        if (tag < 0 || static_cast<size_t>(tag) >= _connections.size())
+        {
+            return false;
+        }
+        const Connection & c = _connections[tag];
+        return c.active && (c.pendingBegin < c.pending.size() || c.closed);
+    }
+
+    int UringEngine::recv(const int & tag, char * first, const int & firstNum, char * second, const int & secondNum)
+    {
+        if (!isActive() || tag < 0 || static_cast<size_t>(tag) >= _connections.size() || !_connections[tag].active)
+        {
+            return -1;
+        }
+        while (!isReadable(tag))
+        {
+            // queued frames only leave when there is nothing left to read, so they are batched
+            reap();
+            if (!isReadable(tag))
+            {
+                flush();
+            }
+            if (!isReadable(tag) && !enter(1, -1))
+            {
+                return -1;
+            }
+        }
+        Connection & c = _connections[tag];
+        const size_t available = c.pending.size() - c.pendingBegin;
+        const size_t numFirst = std::min(available, static_cast<size_t>(std::max(0, firstNum)));
+        const size_t numSecond = std::min(available - numFirst, static_cast<size_t>(std::max(0, secondNum)));
+        const char * data = c.pending.data() + c.pendingBegin;
+        std::copy(data, data + numFirst, first);
+        std::copy(data + numFirst, data + numFirst + numSecond, second);
+        c.pendingBegin += numFirst + numSecond;
+        if (c.pendingBegin == c.pending.size())
+        {
+            c.pending.clear();
+            c.pendingBegin = 0;
+        }
+        return static_cast<int>(numFirst + numSecond);
+    }
+
+    bool UringEngine::waitData(const int & tag, const int & timeoutMs)
+    {
+        if (!isActive())
+        {
+            return false;
+        }
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        while (!isReadable(tag))
+        {
+            reap();
+            if (!isReadable(tag))
+            {
+                flush();
+            }
+            if (isReadable(tag))
+            {
+                break;
+            }
+            int waitMs = timeoutMs;
+            if (timeoutMs >= 0)
+            {
+                waitMs = std::max<int>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count());
+            }
+            if (!enter(1, waitMs))
+            {
+                reap();
+                return isReadable(tag);
+            }
+        }
+        return true;
+    }
+
+    int UringEngine::waitForEvent(const int & timeoutMs)
+    {
+        if (!isActive())
+        {
+            return -1;
+        }
+        flush();
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        bool timedOut = false;
+        while (true)
+        {
+            reap();
+            if (_pollReady)
+            {
+                _pollReady = false;
+                return pollTag;
+            }
+            for (size_t tag = 0; tag < _connections.size(); ++tag)
+            {
+                if (isReadable(static_cast<int>(tag)))
+                {
+                    return static_cast<int>(tag);
+                }
+            }
+            if (timedOut)
+            {
+                return -1;
+            }
+            int waitMs = timeoutMs;
+            if (timeoutMs >= 0)
+            {
+                waitMs = std::max<int>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - Clock::now()).count());
+            }
+            timedOut = !enter(1, waitMs);
+        }
+    }
+
+    int UringEngine::registerBuffer(const char * data, const size_t & size)
+    {
+        if (!isActive() || data == nullptr || size == 0)
+        {
+            return -1;
+        }
+        size_t index = 0;
+        while (index < _registered.size() && _registered[index].data != nullptr)
+        {
+            ++index;
+        }
+        if (index == _registered.size())
+        {
+            return -1;
+        }
+        iovec iov;
+        iov.iov_base = const_cast<char *>(data);
+        iov.iov_len = size;
+        io_uring_rsrc_update2 update;
+        std::memset(&update, 0, sizeof(update));
+        update.offset = static_cast<uint32_t>(index);
+        update.data = reinterpret_cast<uint64_t>(&iov);
+        update.nr = 1;
+        // fails e.g. if pinning the pages exceeds RLIMIT_MEMLOCK, the payloads are copied then
+        if (uringRegister(_ringFd, IORING_REGISTER_BUFFERS_UPDATE, &update, sizeof(update)) < 1)
+        {
+            return -1;
+        }
+        _registered[index] = RegisteredBuffer { data, size, 0 };
+        _registeredByAddress[data] = static_cast<int>(index);
+        return static_cast<int>(index);
+    }
+
+    void UringEngine::unregisterBuffer(const int & index)
+    {
+        if (!isActive() || index < 0 || static_cast<size_t>(index) >= _registered.size()
+                || _registered[index].data == nullptr)
+        {
+            return;
+        }
+        if (_registered[index].queuedRefs > 0)
+        {
+            flush();
+        }
+        iovec iov;
+        iov.iov_base = nullptr;
+        iov.iov_len = 0;
+        io_uring_rsrc_update2 update;
+        std::memset(&update, 0, sizeof(update));
+        update.offset = static_cast<uint32_t>(index);
+        update.data = reinterpret_cast<uint64_t>(&iov);
+        update.nr = 1;
+        uringRegister(_ringFd, IORING_REGISTER_BUFFERS_UPDATE, &update, sizeof(update));
+        _registeredByAddress.erase(_registered[index].data);
+        _registered[index] = RegisteredBuffer { nullptr, 0, 0 };
+    }
+
+    bool UringEngine::isBufferQueued(const int & index) const
+    {
+        return index >= 0 && static_cast<size_t>(index) < _registered.size() && _registered[index].queuedRefs > 0;
+    }
+
+    void UringEngine::queueSend(const int & tag, const NetworkBuffer * parts, const int & numParts)
+    {
+        if (tag < 0 || static_cast<size_t>(tag) >= _connections.size() || !_connections[tag].active)
+        {
+            return;
+        }
+        Connection & c = _connections[tag];
+        if (c.queued.empty())
+        {
+            _queuedTags.push_back(tag);
+        }
+        for (int i = 0; i < numParts; ++i)
+        {
+            const NetworkBuffer & part = parts[i];
+            if (part.size <= 0)
+            {
+                continue;
+            }
+            int index = (c.zeroCopy && part.size >= zeroCopyBytes) ? findRegistered(part.data, part.size) : -1;
+            if (index >= 0)
+            {
+                c.queued.push_back(QueuedPart { part.data, 0, part.size, index });
+                ++_registered[index].queuedRefs;
+                continue;
+            }
+            // consecutive copied parts form one request
+            if (!c.queued.empty() && c.queued.back().bufferIndex < 0)
+            {
+                c.queued.back().size += part.size;
+            }
+            else
+            {
+                c.queued.push_back(QueuedPart { nullptr, c.staging.size(), part.size, -1 });
+            }
+            c.staging.insert(c.staging.end(), part.data, part.data + part.size);
+        }
+    }
+
+    bool UringEngine::hasQueuedSends() const
+    {
+        return !_queuedTags.empty();
+    }
+
+    void UringEngine::flush()
+    {
+        if (_queuedTags.empty() || !isActive())
+        {
+            return;
+        }
+        _sendOps.clear();
+        for (const int & tag : _queuedTags)
+        {
+            submitQueued(tag);
+        }
+        while (_sendsInFlight > 0)
+        {
+            reap();
+            if (_sendsInFlight > 0 && !enter(1, -1))
+            {
+                std::cout << "io_uring_enter: " << std::strerror(errno) << "\n";
+                break;
+            }
+        }
+
+        // the requests of one connection are consecutive, the first one that didn't send everything broke the link
+        size_t begin = 0;
+        while (begin < _sendOps.size())
+        {
+            size_t end = begin;
+            while (end < _sendOps.size() && _sendOps[end].tag == _sendOps[begin].tag)
+            {
+                ++end;
+            }
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (_sendOps[i].result != _sendOps[i].size)
+                {
+                    completeSends(_sendOps[begin].tag, i, end);
+                    break;
+                }
+            }
+            begin = end;
+        }
+
+        for (const int & tag : _queuedTags)
+        {
+            Connection & c = _connections[tag];
+            for (const QueuedPart & part : c.queued)
+            {
+                if (part.bufferIndex >= 0)
+                {
+                    --_registered[part.bufferIndex].queuedRefs;
+                }
+            }
+            c.queued.clear();
+            c.staging.clear();
+        }
+        _queuedTags.clear();
+    }
+
+    io_uring_sqe * UringEngine::prepareSqe()
+    {
+        Rings & r = *_rings;
+        if (r.numFreeSqes() == 0)
+        {
+            enter(0, 0);
+            if (r.numFreeSqes() == 0)
+            {
+                return nullptr;
+            }
+        }
+        io_uring_sqe * sqe = &r.sqes[r.localTail & r.sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++r.localTail;
+        return sqe;
+    }
+
+    void UringEngine::handleCompletion(const io_uring_cqe & cqe)
+    {
+        const RequestType type = static_cast<RequestType>(cqe.user_data >> 56);
+        const int tag = static_cast<int>((cqe.user_data >> 24) & 0xffff);
+        if (type == RECV_REQUEST)
+        {
+            const uint16_t generation = static_cast<uint16_t>(cqe.user_data >> 40);
+            const bool hasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+            const uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (static_cast<size_t>(tag) < _connections.size() && _connections[tag].active
+                    && _connections[tag].generation == generation)
+            {
+                Connection & c = _connections[tag];
+                if (cqe.res > 0 && hasBuffer)
+                {
+                    // drop the consumed front once it dominates, the vector keeps its capacity
+                    if (c.pendingBegin > 0 && 2 * c.pendingBegin >= c.pending.size())
+                    {
+                        c.pending.erase(c.pending.begin(), c.pending.begin() + c.pendingBegin);
+                        c.pendingBegin = 0;
+                    }
+                    const char * data = _rings->bufData + static_cast<size_t>(bufferId) * recvBufferBytes;
+                    c.pending.insert(c.pending.end(), data, data + cqe.res);
+                }
+                else if (cqe.res != -ENOBUFS)
+                {
+                    // 0 is the end of the stream, everything else an error
+                    c.closed = true;
+                }
+                // the receive stops, if it ran out of provided buffers
+                if ((cqe.flags & IORING_CQE_F_MORE) == 0 && !c.closed)
+                {
+                    postRecv(tag);
+                }
+            }
+            if (hasBuffer)
+            {
+                _rings->recycle(bufferId);
+            }
+        }
+        else if (type == SEND_REQUEST)
+        {
+            SendOp & op = _sendOps[cqe.user_data & 0xffffff];
+            if ((cqe.flags & IORING_CQE_F_NOTIF) == 0)
+            {
+                op.result = cqe.res;
+            }
+            // a zero copy send completes twice, the buffer is free with the notification
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+            {
+                --_sendsInFlight;
+            }
+        }
+        else if (type == POLL_REQUEST)
+        {
+            _pollReady = true;
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+            {
+                postPoll();
+            }
+        }
+    }
+
+    bool UringEngine::postRecv(const int & tag)
+    {
+        io_uring_sqe * sqe = prepareSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        const Connection & c = _connections[tag];
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = c.socket;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = recvBufferGroup;
+        sqe->user_data = makeUserData(RECV_REQUEST, c.generation, tag, 0);
+        return true;
+    }
+
+    bool UringEngine::postPoll()
+    {
+        io_uring_sqe * sqe = prepareSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = _pollFd;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = makeUserData(POLL_REQUEST, 0, 0, 0);
+        return true;
+    }
+
+    void UringEngine::submitQueued(const int & tag)
+    {
+        Connection & c = _connections[tag];
+        const size_t firstOp = _sendOps.size();
+        for (const QueuedPart & part : c.queued)
+        {
+            const char * data = (part.bufferIndex >= 0) ? part.data : c.staging.data() + part.stagingOffset;
+            _sendOps.push_back(SendOp { tag, data, part.size, -ECANCELED, part.bufferIndex >= 0 });
+        }
+        const size_t numOps = _sendOps.size() - firstOp;
+        // a link can't span two submissions, so all requests of the connection have to fit into the queue
+        Rings & r = *_rings;
+        if (r.numFreeSqes() < numOps)
+        {
+            enter(0, 0);
+        }
+        if (r.numFreeSqes() < numOps)
+        {
+            return;  // flush() sends them with blocking calls
+        }
+
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            const QueuedPart & part = c.queued[i];
+            const SendOp & op = _sendOps[firstOp + i];
+            io_uring_sqe * sqe = prepareSqe();
+            sqe->opcode = op.zeroCopy ? IORING_OP_SEND_ZC : IORING_OP_SEND;
+            sqe->fd = c.socket;
+            sqe->addr = reinterpret_cast<uint64_t>(op.data);
+            sqe->len = static_cast<uint32_t>(op.size);
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+            if (op.zeroCopy)
+            {
+                sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+                sqe->buf_index = static_cast<uint16_t>(part.bufferIndex);
+            }
+            if (i + 1 < numOps)
+            {
+                sqe->flags = IOSQE_IO_LINK;
+            }
+            sqe->user_data = makeUserData(SEND_REQUEST, 0, tag, firstOp + i);
+            ++_sendsInFlight;
+        }
+    }
+
+    void UringEngine::completeSends(const int & tag, const size_t & firstOp, const size_t & endOp)
+    {
+        Connection & c = _connections[tag];
+        for (size_t i = firstOp; i < endOp && !c.closed; ++i)
+        {
+            const SendOp & op = _sendOps[i];
+            // e.g. Unix domain sockets don't support zero copy, the payloads are copied from now on
+            if (op.zeroCopy && (op.result == -EOPNOTSUPP || op.result == -EINVAL))
+            {
+                c.zeroCopy = false;
+            }
+            const char * data = op.data + std::max(0, op.result);
+            size_t numLeft = op.size - std::max(0, op.result);
+            while (numLeft > 0)
+            {
+                ssize_t res = ::send(c.socket, data, numLeft, MSG_NOSIGNAL);
+                if (res < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (res <= 0)
+                {
+                    std::cout << "send: " << std::strerror(errno) << "\n";
+                    c.closed = true;
+                    break;
+                }
+                data += res;
+                numLeft -= res;
+            }
+        }
+    }
+
+    void UringEngine::reap()
+    {
+        Rings & r = *_rings;
+        unsigned head = *r.cqHead;
+        unsigned tail = __atomic_load_n(r.cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            handleCompletion(r.cqes[head & r.cqMask]);
+            ++head;
+            if (head == tail)
+            {
+                // let the kernel reuse the entries, then look for completions that arrived meanwhile
+                __atomic_store_n(r.cqHead, head, __ATOMIC_RELEASE);
+                tail = __atomic_load_n(r.cqTail, __ATOMIC_ACQUIRE);
+            }
+        }
+        __atomic_store_n(r.cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    bool UringEngine::enter(const unsigned & minComplete, const int & timeoutMs)
+    {
+        Rings & r = *_rings;
+        __atomic_store_n(r.sqTail, r.localTail, __ATOMIC_RELEASE);
+        unsigned flags = 0;
+        io_uring_getevents_arg arg;
+        __kernel_timespec ts;
+        void * argPtr = nullptr;
+        size_t argSize = 0;
+        if (minComplete > 0)
+        {
+            flags |= IORING_ENTER_GETEVENTS;
+            if (timeoutMs >= 0)
+            {
+                ts.tv_sec = timeoutMs / 1000;
+                ts.tv_nsec = (timeoutMs % 1000) * 1000000ll;
+                std::memset(&arg, 0, sizeof(arg));
+                arg.ts = reinterpret_cast<uint64_t>(&ts);
+                flags |= IORING_ENTER_EXT_ARG;
+                argPtr = &arg;
+                argSize = sizeof(arg);
+            }
+        }
+        while (true)
+        {
+            int res = uringEnter(_ringFd, r.localTail - r.submittedTail, minComplete, flags, argPtr, argSize);
+            if (res >= 0)
+            {
+                r.submittedTail += res;
+                return true;
+            }
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+    }
+
+    int UringEngine::findRegistered(const char * data, const int & size) const
+    {
+        auto it = _registeredByAddress.upper_bound(data);
+        if (it == _registeredByAddress.begin())
+        {
+            return -1;
+        }
+        --it;
+        const RegisteredBuffer & buffer = _registered[it->second];
+        return (data + size <= buffer.data + buffer.size) ? it->second : -1;
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,90 @@
+/*
+ * NetworkClient.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkClient.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace NetOff
+{
+
+    NetworkClient::NetworkClient()
+            : NetworkMember()
+    {
+    }
+
+    bool NetworkClient::initialize(const std::string & host, const int & port)
+    {
+        if (isUnixSocketAddress(host))
+        {
+            std::cout << "NetworkClient: Unix domain sockets like " << host << " need the POSIX backend." << std::endl;
+            return false;
+        }
+        IPaddress ip;
+        SDLNet_Init();
+
+        if (SDLNet_ResolveHost(&ip, host.c_str(), port) == -1)
+        {
+            std::cout << "SDLNet_ResolveHost: " << SDLNet_GetError() << std::endl;
+            return false;
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = (_options.connectionTimeout < 0) ? Clock::time_point::max() :
+                Clock::now() + std::chrono::milliseconds(_options.connectionTimeout);
+        std::chrono::microseconds backoff(_options.initialBackoff);
+        bool printed = false;
+        while (true)
+        {
+            _socket = SDLNet_TCP_Open(&ip);
+            Clock::time_point now = Clock::now();
+            if (_socket != nullptr || now >= deadline)
+            {
+                break;
+            }
+            if (!printed)
+            {
+                std::cout << "Waiting for server on host " << host << " and port " << port << " ..." << std::endl;
+                printed = true;
+            }
+            // retry with exponential backoff, starting in the microsecond range
+            std::this_thread::sleep_for(
+                    std::min<Clock::duration>(backoff, std::chrono::duration_cast<Clock::duration>(deadline - now)));
+            backoff = std::min(2 * backoff, std::chrono::microseconds(_options.maxBackoff));
+        }
+
+        if (_socket == nullptr)
+        {
+            std::cout << "no socket" << std::endl;
+            return false;
+        }
+        applySocketOptions();
+        // the first message decides whether the data is exchanged over shared memory
+        if (!offerSharedMemory())
+        {
+            killSocket(_socket);
+            return false;
+        }
+        return true;
+    }
+
+    void NetworkClient::deinitialize()
+    {
+        closeSharedMemory();
+        killSocket(_socket);
+        resetRecvBuffer();
+    }
+
+    char NetworkClient::getChar() const
+    {
+        return 'C';
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,118 @@
+/*
+ * NetworkMember.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkMember.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+
+namespace NetOff
+{
+
+    NetworkMember::NetworkMember()
+            : _socket(nullptr),
+              _socketSet(SDLNet_AllocSocketSet(1)),
+              _options(),
+              _counters(),
+              _shm(),
+              _uring(nullptr),
+              _uringTag(-1),
+              _recvBuffer(1 << 16),
+              _recvBegin(0),
+              _recvEnd(0)
+    {
+
+    }
+
+    NetworkMember::~NetworkMember()
+    {
+        killSocket(_socket);
+        if (_socketSet != nullptr)
+        {
+            SDLNet_FreeSocketSet(_socketSet);
+            _socketSet = nullptr;
+        }
+    }
+
+    int NetworkMember::sendSome(const NetworkBuffer * parts, const int & /*numParts*/, const int & offset)
+    {
+        // SDL_net has no gather write, so the buffers are sent one after another
+        int partNum = std::min(parts[0].size - offset, _options.highWaterMark);
+        int numBytes = SDLNet_TCP_Send(_socket, static_cast<const void *>(parts[0].data + offset), partNum);
+        if (numBytes < partNum)
+        {
+            std::cout << "SDLNet_TCP_Send: " << SDLNet_GetError() << "\n";
+            return -1;
+        }
+        return numBytes;
+    }
+
+    int NetworkMember::recvSome(char * first, const int & firstNum, char * /*second*/, const int & /*secondNum*/)
+    {
+        // SDL_net has no receive timeout, so the socket is checked before it blocks
+        if (_options.recvTimeout >= 0 && !waitReadable(_options.recvTimeout))
+        {
+            return -1;
+        }
+        return SDLNet_TCP_Recv(_socket, first, std::min(firstNum, _options.highWaterMark));
+    }
+
+    bool NetworkMember::waitReadable(const int & timeoutMs)
+    {
+        if (_recvBegin < _recvEnd)
+        {
+            return true;
+        }
+        if (_socket == nullptr || _socketSet == nullptr)
+        {
+            return false;
+        }
+        // the socket is only part of the set while waiting, so the set never holds a closed socket
+        SDLNet_TCP_AddSocket(_socketSet, _socket);
+        int numReady = SDLNet_CheckSockets(_socketSet, (timeoutMs < 0) ? ~0u : static_cast<Uint32>(timeoutMs));
+        SDLNet_TCP_DelSocket(_socketSet, _socket);
+        return numReady > 0 && SDLNet_SocketReady(_socket);
+    }
+
+    void NetworkMember::applySocketOptions()
+    {
+        // SDL_net always opens its sockets with TCP_NODELAY and doesn't expose the kernel buffer sizes.
+    }
+
+    void NetworkMember::spinReadable()
+    {
+        // SDL_net has no non-blocking receive, it always blocks
+    }
+
+    bool NetworkMember::drainWakeups()
+    {
+        // shared memory isn't available with SDL_net, so there are no wakeups
+        return true;
+    }
+
+    void NetworkMember::useSharedMemory(std::unique_ptr<ShmChannel> && /*shm*/)
+    {
+    }
+
+    void NetworkMember::sendWakeup()
+    {
+    }
+
+    void NetworkMember::killSocket(SocketHandle & socket)
+    {
+        {
+            if (socket != nullptr)
+            {
+                SDLNet_TCP_Close(socket);
+                socket = nullptr;
+            }
+        }
+    }
+
+} /* namespace NetOff */
+
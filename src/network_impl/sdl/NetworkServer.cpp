@@ -0,0 +1,247 @@
+/*
+ * NetworkServer.cpp
+ *
+ *  Created on: 07.04.2016
+ *      Author: Marc Hartung
+ */
+
+#include "network_impl/NetworkServer.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+namespace NetOff
+{
+
+    NetworkServer::NetworkServer()
+            : _listenSocket(nullptr),
+              _socketPath(),
+              _socketSet(nullptr),
+              _listenerWatched(false),
+              _maxConnections(1),
+              _nextBuffered(0),
+              _options(),
+              _closedCounters(),
+              _connections(),
+              _useUring(false),
+              _uring(),
+              _eventSetReady(false)
+    {
+
+    }
+
+    NetworkServer::~NetworkServer()
+    {
+        deinitialize();
+    }
+
+    bool NetworkServer::initialize(const int & port, const size_t & maxClients)
+    {
+        IPaddress ip;
+        SDLNet_Init();
+        _maxConnections = std::max<size_t>(1, maxClients);
+
+        if (SDLNet_ResolveHost(&ip, nullptr, port) == -1)
+        {
+            std::cout << "SDLNet_ResolveHost: " << SDLNet_GetError() << std::endl;
+            return false;
+        }
+
+        _listenSocket = SDLNet_TCP_Open(&ip);
+        if (_listenSocket == nullptr)
+        {
+            std::cout << "SDLNet_TCP_Open: " << SDLNet_GetError() << std::endl;
+            return false;
+        }
+
+        // SDL_net socket sets have a fixed capacity: all connections plus the listening socket
+        if (_socketSet == nullptr)
+        {
+            _socketSet = SDLNet_AllocSocketSet(static_cast<int>(_maxConnections) + 1);
+        }
+        startEngine();
+        updateListener();
+        std::cout << "Waiting for client on port " << port << " ..." << std::endl;
+        return true;
+    }
+
+    bool NetworkServer::initialize(const std::string & socketPath, const size_t & /*maxClients*/)
+    {
+        std::cout << "NetworkServer: Unix domain sockets like " << socketPath << " need the POSIX backend." << std::endl;
+        return false;
+    }
+
+    int NetworkServer::acceptConnection()
+    {
+        if (_listenSocket == nullptr)
+        {
+            return -1;
+        }
+        const int & timeoutMs = _options.connectionTimeout;
+        SDLNet_SocketSet set = SDLNet_AllocSocketSet(1);
+        SDLNet_TCP_AddSocket(set, _listenSocket);
+        int numReady = SDLNet_CheckSockets(set, (timeoutMs < 0) ? ~0u : static_cast<Uint32>(timeoutMs));
+        SDLNet_FreeSocketSet(set);
+        int id = (numReady > 0) ? acceptPending() : -1;
+        if (id >= 0 && !_connections[id]->negotiateTransport())
+        {
+            closeConnection(id);
+            return -1;
+        }
+        return id;
+    }
+
+    int NetworkServer::waitForData(const int & timeoutMs)
+    {
+        // read ahead data isn't reported by the socket set, so these connections are served first
+        int buffered = takeBuffered();
+        if (buffered >= 0)
+        {
+            return buffered;
+        }
+        if (_socketSet == nullptr)
+        {
+            return -1;
+        }
+
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+        while (true)
+        {
+            Uint32 waitMs = ~0u;
+            if (timeoutMs >= 0)
+            {
+                waitMs = static_cast<Uint32>(std::max<long long>(
+                        0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count()));
+            }
+            if (SDLNet_CheckSockets(_socketSet, waitMs) <= 0)
+            {
+                return -1;
+            }
+            if (_listenerWatched && SDLNet_SocketReady(_listenSocket))
+            {
+                acceptPending();
+            }
+            // SDL_net doesn't rotate its ready sockets, so the search starts behind the last served connection
+            for (size_t n = 0; n < _connections.size(); ++n)
+            {
+                size_t id = (_nextBuffered + n) % _connections.size();
+                if (_connections[id] != nullptr && SDLNet_SocketReady(_connections[id]->nativeHandle()))
+                {
+                    _nextBuffered = id + 1;
+                    // the first message of a client is its transport offer, which may arrive in parts; a broken
+                    // connection is reported
+                    if (!_connections[id]->isNegotiated() && _connections[id]->continueNegotiation())
+                    {
+                        break;
+                    }
+                    return static_cast<int>(id);
+                }
+            }
+        }
+    }
+
+    void NetworkServer::stopListening()
+    {
+        if (_listenerWatched)
+        {
+            SDLNet_TCP_DelSocket(_socketSet, _listenSocket);
+            _listenerWatched = false;
+        }
+        if (_listenSocket != nullptr)
+        {
+            SDLNet_TCP_Close(_listenSocket);
+            _listenSocket = nullptr;
+        }
+    }
+
+    bool NetworkServer::isListening() const
+    {
+        return _listenSocket != nullptr;
+    }
+
+    void NetworkServer::closeConnection(const int & id)
+    {
+        if (!isConnected(id))
+        {
+            return;
+        }
+        addClosedCounters(_connections[id]->getCounters());
+        SDLNet_TCP_DelSocket(_socketSet, _connections[id]->nativeHandle());
+        _connections[id]->deinitialize();
+        _connections[id].reset();
+        updateListener();
+    }
+
+    void NetworkServer::deinitialize()
+    {
+        for (size_t id = 0; id < _connections.size(); ++id)
+        {
+            closeConnection(static_cast<int>(id));
+        }
+        _connections.clear();
+        stopListening();
+        _uring.reset();
+        if (_socketSet != nullptr)
+        {
+            SDLNet_FreeSocketSet(_socketSet);
+            _socketSet = nullptr;
+        }
+    }
+
+    int NetworkServer::acceptPending()
+    {
+        TCPsocket sock = SDLNet_TCP_Accept(_listenSocket);
+        if (sock == nullptr)
+        {
+            return -1;
+        }
+        size_t id = 0;
+        while (id < _connections.size() && _connections[id] != nullptr)
+        {
+            ++id;
+        }
+        if (id == _connections.size())
+        {
+            _connections.emplace_back();
+        }
+        _connections[id].reset(new NetworkConnection(sock, _options));
+        watchConnection(static_cast<int>(id));
+        updateListener();
+        return static_cast<int>(id);
+    }
+
+    void NetworkServer::watchConnection(const int & id)
+    {
+        if (_socketSet != nullptr)
+        {
+            SDLNet_TCP_AddSocket(_socketSet, _connections[id]->nativeHandle());
+        }
+    }
+
+    void NetworkServer::attachConnection(const int & /*id*/)
+    {
+        // startEngine() always fails with SDL_net, the socket set serves all connections
+    }
+
+    void NetworkServer::updateListener()
+    {
+        // a full server stops accepting, further clients wait in the backlog until a connection is closed
+        bool watch = _listenSocket != nullptr && _socketSet != nullptr && getNumConnections() < _maxConnections;
+        if (watch == _listenerWatched)
+        {
+            return;
+        }
+        if (watch)
+        {
+            SDLNet_TCP_AddSocket(_socketSet, _listenSocket);
+        }
+        else
+        {
+            SDLNet_TCP_DelSocket(_socketSet, _listenSocket);
+        }
+        _listenerWatched = watch;
+    }
+
+} /* namespace NetOff */
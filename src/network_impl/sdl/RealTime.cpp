@@ -0,0 +1,44 @@
+/*
+ * RealTime.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/RealTime.hpp"
+
+namespace NetOff
+{
+
+    // Locking, pinning and scheduling are OS specific, the SDL_net backend reports every setting as failed.
+
+    ResourceUsage getResourceUsage()
+    {
+        return ResourceUsage();
+    }
+
+    bool lockBuffer(const char * /*data*/, const size_t & /*size*/)
+    {
+        return false;
+    }
+
+    bool lockAllMemory()
+    {
+        return false;
+    }
+
+    void prefaultStack()
+    {
+    }
+
+    bool pinCurrentThread(const std::vector<int> & /*cpus*/)
+    {
+        return false;
+    }
+
+    bool setCurrentThreadPriority(const int & /*priority*/)
+    {
+        return false;
+    }
+
+} /* namespace NetOff */
@@ -0,0 +1,110 @@
+/*
+ * ShmChannel.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/ShmChannel.hpp"
+
+namespace NetOff
+{
+
+    // The SDL_net backend has no shared memory transport: no segment can be created or opened, so the negotiation
+    // always keeps the socket.
+
+    ShmChannel::ShmChannel()
+            : _segment(nullptr),
+              _mappedBytes(0),
+              _ringBytes(0),
+              _name(),
+              _peerSocket(-1),
+              _spinUs(0),
+              _side(0)
+    {
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+    }
+
+    bool ShmChannel::create(const size_t & /*ringBytes*/)
+    {
+        return false;
+    }
+
+    bool ShmChannel::open(const std::string & /*name*/, const uint64_t & /*token*/, const size_t & /*ringBytes*/)
+    {
+        return false;
+    }
+
+    void ShmChannel::unlink()
+    {
+    }
+
+    void ShmChannel::close()
+    {
+    }
+
+    bool ShmChannel::isOpen() const
+    {
+        return false;
+    }
+
+    const std::string & ShmChannel::getName() const
+    {
+        return _name;
+    }
+
+    uint64_t ShmChannel::getToken() const
+    {
+        return 0;
+    }
+
+    size_t ShmChannel::getRingBytes() const
+    {
+        return 0;
+    }
+
+    void ShmChannel::setPeerSocket(const int & socket)
+    {
+        _peerSocket = socket;
+    }
+
+    void ShmChannel::setSpin(const int & spinUs)
+    {
+        _spinUs = spinUs;
+    }
+
+    int ShmChannel::write(const NetworkBuffer * /*parts*/, const int & /*numParts*/, const int & /*offset*/,
+                          const int & /*maxBytes*/)
+    {
+        return -1;
+    }
+
+    int ShmChannel::read(char * /*first*/, const int & /*firstNum*/, char * /*second*/, const int & /*secondNum*/)
+    {
+        return 0;
+    }
+
+    bool ShmChannel::waitData(const int & /*timeoutMs*/)
+    {
+        return false;
+    }
+
+    bool ShmChannel::hasData() const
+    {
+        return false;
+    }
+
+    bool ShmChannel::requestWakeup()
+    {
+        return true;
+    }
+
+    bool ShmChannel::takeWakeupRequest()
+    {
+        return false;
+    }
+
+} /* namespace NetOff */
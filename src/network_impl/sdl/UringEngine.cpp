@@ -0,0 +1,122 @@
+/*
+ * UringEngine.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "network_impl/UringEngine.hpp"
+
+namespace NetOff
+{
+
+    // io_uring is Linux specific, with the SDL_net backend initialize() fails and NetworkServer keeps its socket set.
+
+    UringEngine::Connection::Connection()
+            : socket(nullptr),
+              generation(0),
+              active(false),
+              closed(false),
+              zeroCopy(false),
+              pending(),
+              pendingBegin(0),
+              staging(),
+              queued()
+    {
+    }
+
+    UringEngine::UringEngine()
+            : _ringFd(-1),
+              _rings(nullptr),
+              _connections(),
+              _queuedTags(),
+              _sendOps(),
+              _sendsInFlight(0),
+              _registered(),
+              _registeredByAddress(),
+              _pollFd(-1),
+              _pollReady(false)
+    {
+    }
+
+    UringEngine::~UringEngine()
+    {
+    }
+
+    bool UringEngine::initialize(const unsigned & /*entries*/)
+    {
+        return false;
+    }
+
+    void UringEngine::close()
+    {
+    }
+
+    bool UringEngine::isActive() const
+    {
+        return false;
+    }
+
+    bool UringEngine::watchPoll(const int & /*fd*/)
+    {
+        return false;
+    }
+
+    bool UringEngine::addConnection(const int & /*tag*/, const SocketHandle & /*socket*/)
+    {
+        return false;
+    }
+
+    void UringEngine::removeConnection(const int & /*tag*/)
+    {
+    }
+
+    bool UringEngine::isReadable(const int & /*tag*/) const
+    {
+        return false;
+    }
+
+    int UringEngine::recv(const int & /*tag*/, char * /*first*/, const int & /*firstNum*/, char * /*second*/,
+                          const int & /*secondNum*/)
+    {
+        return -1;
+    }
+
+    bool UringEngine::waitData(const int & /*tag*/, const int & /*timeoutMs*/)
+    {
+        return false;
+    }
+
+    int UringEngine::waitForEvent(const int & /*timeoutMs*/)
+    {
+        return -1;
+    }
+
+    int UringEngine::registerBuffer(const char * /*data*/, const size_t & /*size*/)
+    {
+        return -1;
+    }
+
+    void UringEngine::unregisterBuffer(const int & /*index*/)
+    {
+    }
+
+    bool UringEngine::isBufferQueued(const int & /*index*/) const
+    {
+        return false;
+    }
+
+    void UringEngine::queueSend(const int & /*tag*/, const NetworkBuffer * /*parts*/, const int & /*numParts*/)
+    {
+    }
+
+    bool UringEngine::hasQueuedSends() const
+    {
+        return false;
+    }
+
+    void UringEngine::flush()
+    {
+    }
+
+} /* namespace NetOff */
@@ -7,8 +7,117 @@
 
 #include "../include/SimulationClient.hpp"
 #include "../include/SimulationServer.hpp"
+#include "../include/AsyncSimulationClient.hpp"
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#ifndef NETOFF_USE_SDL_NET
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/*! Heap allocations of the calling thread, counted by the replaced allocation functions below. Client and server of
+ * the local harness run on threads of their own, so they count apart. */
+thread_local size_t numHeapAllocs = 0;
+
+size_t countHeapAllocs()
+{
+	return numHeapAllocs;
+}
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+// glibc allows to replace malloc, the originals stay reachable under their internal names. operator new of libstdc++
+// allocates with malloc, so this counts the allocations of both and of the C libraries.
+extern "C"
+{
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t num, size_t size);
+void * __libc_realloc(void * data, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void * data);
+
+void * malloc(size_t size) noexcept
+{
+	++numHeapAllocs;
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t num, size_t size) noexcept
+{
+	++numHeapAllocs;
+	return __libc_calloc(num, size);
+}
+
+void * realloc(void * data, size_t size) noexcept
+{
+	++numHeapAllocs;
+	return __libc_realloc(data, size);
+}
+
+void * memalign(size_t alignment, size_t size) noexcept
+{
+	++numHeapAllocs;
+	return __libc_memalign(alignment, size);
+}
+
+void * aligned_alloc(size_t alignment, size_t size) noexcept
+{
+	return memalign(alignment, size);
+}
+
+int posix_memalign(void ** data, size_t alignment, size_t size) noexcept
+{
+	*data = memalign(alignment, size);
+	return (*data == nullptr) ? ENOMEM : 0;
+}
+
+void free(void * data) noexcept
+{
+	__libc_free(data);
+}
+}
+#else
+// elsewhere, and with the sanitizers intercepting malloc, only operator new is counted
+void * operator new(size_t size)
+{
+	++numHeapAllocs;
+	void * res = std::malloc((size == 0) ? 1 : size);
+	if (res == nullptr)
+		throw std::bad_alloc();
+	return res;
+}
+
+void * operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void * data) noexcept
+{
+	std::free(data);
+}
+
+void operator delete[](void * data) noexcept
+{
+	std::free(data);
+}
+#endif
+
+/*! Iterations per state a sub-task of a parallel step should at least compute. */
+const size_t subTaskWork = 1 << 16;
 
 struct BenchSim
 {
@@ -16,11 +125,13 @@ struct BenchSim
 	size_t _numInputs;
 	std::shared_ptr<double> _states;
 	double _currentTime;
+	/*! Compute load of a step in iterations per state. */
+	size_t _work;
 
 	NetOff::VariableList _vars;
 
 	BenchSim(const size_t & numStates) :
-			_numStates(numStates), _numInputs(0), _states(std::shared_ptr<double>(new double[_numStates])), _currentTime(0)
+			_numStates(numStates), _numInputs(0), _states(new double[_numStates], std::default_delete<double[]>()), _currentTime(0), _work(0), _vars()
 	{
 		for (size_t i = 0; i < _numStates; ++i)
 		{
@@ -28,31 +139,434 @@ struct BenchSim
 		}
 	}
 
+	/*! The inputs are the first _numInputs states. */
 	void init(const double * in)
 	{
 		if (_numInputs == 0)
 			throw std::runtime_error("BenchSim: No inputs set.");
-		std::copy(in, in + _numStates, _states.get());
+		std::copy(in, in + _numInputs, _states.get());
 	}
 
 	const double * solve(const double * in, const double & time)
 	{
-		std::copy(in, in + _numStates, _states.get());
+		std::copy(in, in + _numInputs, _states.get());
+		work(0, _numStates);
 		_currentTime = time;
 		return _states.get();
 	}
+
+	/*! Same as solve(), but an expensive step is split into sub-tasks, which idle workers of the server steal. */
+	const double * solveSplit(const double * in, const double & time)
+	{
+		const size_t numTasks = std::max(std::min(_numStates, _numStates * _work / subTaskWork), static_cast<size_t>(1));
+		std::copy(in, in + _numInputs, _states.get());
+		NetOff::StepPool::runSubTasks(numTasks, [this, numTasks](const size_t & task)
+		{
+			work(task * _numStates / numTasks, (task + 1) * _numStates / numTasks);
+		});
+		_currentTime = time;
+		return _states.get();
+	}
+
+	/*! Computes the load of the states [begin, end), independent of the other states. */
+	void work(const size_t & begin, const size_t & end)
+	{
+		double * states = _states.get();
+		for (size_t i = begin; i < end; ++i)
+			for (size_t k = 0; k < _work; ++k)
+				states[i] = 0.5 * states[i] + 1.0;
+	}
 };
 
-int BenchServer(const int & port, const size_t & numStates)
+/*! Compute load per simulation in iterations per state, drawn from a distribution with the given mean:
+ * uniform: all simulations cost the mean.
+ * exponential: exponentially distributed costs.
+ * lognormal: heavy tailed costs, a few simulations dominate.
+ * stiff: one simulation costs as much as all others together.
+ * The costs are seeded, so every run of a workload is the same. */
+std::vector<size_t> benchWorkload(const std::string & distribution, const size_t & numSims, const size_t & meanWork)
 {
-	NetOff::SimulationServer noFS(port);
-	// open server
-	if (!noFS.initializeConnection())
-		throw std::runtime_error("Couldn't open server.");
+	std::vector<size_t> res(numSims, meanWork);
+	std::mt19937 generator(42);
+	if (distribution == "exponential")
+	{
+		std::exponential_distribution<double> costs(1.0 / meanWork);
+		for (size_t & work : res)
+			work = static_cast<size_t>(costs(generator));
+	}
+	else if (distribution == "lognormal")
+	{
+		// the mean of a lognormal distribution is exp(mu + sigma^2 / 2)
+		const double sigma = 1.5;
+		std::lognormal_distribution<double> costs(std::log(static_cast<double>(meanWork)) - sigma * sigma / 2.0, sigma);
+		for (size_t & work : res)
+			work = static_cast<size_t>(costs(generator));
+	}
+	else if (distribution == "stiff")
+	{
+		std::fill(res.begin(), res.end(), (numSims > 1) ? meanWork * numSims / (2 * (numSims - 1)) : meanWork);
+		res[0] = meanWork * numSims / 2;
+	}
+	else if (distribution != "uniform")
+		throw std::runtime_error("Unknown workload " + distribution);
+	return res;
+}
 
-	std::vector<BenchSim> fmus;
+/*! Parses a comma separated list like "uniform,stiff". */
+std::vector<std::string> parseWorkloads(const std::string & list)
+{
+	std::vector<std::string> res;
+	std::stringstream stream(list);
+	std::string name;
+	while (std::getline(stream, name, ','))
+	{
+		benchWorkload(name, 1, 1);
+		res.push_back(name);
+	}
+	return res;
+}
 
-	// now wait for initialization requests of a client:
+/*! Transport between client and server of a benchmark run. SHM uses TCP to connect and negotiates the shared memory
+ * transport, which falls back to TCP on different hosts. URING is TCP with the io_uring engine on the server, which
+ * falls back to epoll without io_uring. */
+enum class Transport
+{
+	TCP,
+	UNIX,
+	SHM,
+	URING
+};
+
+/*! The multi client servers accept clients until their last session is finished, so every transport gets its own port.
+ * Otherwise the first client of the next transport could be accepted by the previous server. */
+int multiPort(const int & port, const Transport & transport)
+{
+	return port + 1 + static_cast<int>(transport);
+}
+
+const char * transportName(const Transport & transport)
+{
+	switch (transport)
+	{
+	case Transport::TCP:
+		return "tcp";
+	case Transport::UNIX:
+		return "unix";
+	case Transport::URING:
+		return "uring";
+	default:
+		return "shm";
+	}
+}
+
+/*! Microseconds the spin-then-block policy polls, before it sleeps. */
+const int latencySpinUs = 50;
+
+/*! The compared wait policies. Busy polling client and server on a single hardware thread only hand over the core
+ * every scheduler tick, so it's skipped there. */
+std::vector<NetOff::WaitPolicy> benchWaitPolicies()
+{
+	std::vector<NetOff::WaitPolicy> res = { NetOff::WaitPolicy::BLOCK, NetOff::WaitPolicy::SPIN_THEN_BLOCK };
+	if (std::thread::hardware_concurrency() > 1)
+		res.push_back(NetOff::WaitPolicy::BUSY_POLL);
+	return res;
+}
+
+const char * waitPolicyName(const NetOff::WaitPolicy & policy)
+{
+	switch (policy)
+	{
+	case NetOff::WaitPolicy::BUSY_POLL:
+		return "poll";
+	case NetOff::WaitPolicy::SPIN_THEN_BLOCK:
+		return "spin";
+	default:
+		return "block";
+	}
+}
+
+/*! Parses a comma separated list like "tcp,unix,shm,uring". */
+std::vector<Transport> parseTransports(const std::string & list)
+{
+	std::vector<Transport> res;
+	std::stringstream stream(list);
+	std::string name;
+	while (std::getline(stream, name, ','))
+	{
+		if (name == "tcp")
+			res.push_back(Transport::TCP);
+		else if (name == "unix")
+			res.push_back(Transport::UNIX);
+		else if (name == "shm")
+			res.push_back(Transport::SHM);
+		else if (name == "uring")
+			res.push_back(Transport::URING);
+		else
+			throw std::runtime_error("Unknown transport " + name);
+	}
+	return res;
+}
+
+/*! Path of the benchmark simulation, the i-th simulation of a client is named Fmu<i>.fmu for i > 0. */
+const std::string benchSimPath = "/home/of/very/funny/Fmu.fmu";
+
+std::string benchSimPathOf(const size_t & i)
+{
+	return (i == 0) ? benchSimPath : benchSimPath.substr(0, benchSimPath.size() - 4) + std::to_string(i) + ".fmu";
+}
+
+/*! The Unix domain socket of the benchmark is derived from the port, so server and client agree on it. */
+std::string benchSocketAddress(const int & port)
+{
+	return "unix:/tmp/netoff-bench-" + std::to_string(port) + ".sock";
+}
+
+/*! Command line options of the suites, given as --name=value behind the positional arguments. The sweeps have to be
+ * given to the client and the server alike. */
+struct BenchOptions
+{
+	/*! States of the states sweep. */
+	std::vector<size_t> states;
+	/*! Inputs of the inputs sweep. */
+	std::vector<size_t> inputs;
+	/*! Simulations of the simulation sweeps. */
+	std::vector<size_t> sims;
+	/*! Rounds of a run of the sweeps. */
+	size_t rounds;
+	/*! Prints JSON lines instead of CSV. */
+	bool json;
+	/*! Prefix of the HDR histogram files of the runs, empty writes none. */
+	std::string hdrPrefix;
+	/*! CPUs of the server and the client thread of the local harness, empty keeps the affinity. */
+	std::vector<int> serverCpus;
+	std::vector<int> clientCpus;
+
+	BenchOptions() :
+			states(), inputs(), sims(), rounds(0), json(false), hdrPrefix(), serverCpus(), clientCpus()
+	{
+	}
+};
+
+BenchOptions benchOptions;
+
+/*! Parses a comma separated list like "16,64,256". */
+std::vector<size_t> parseSizes(const std::string & list)
+{
+	std::vector<size_t> res;
+	std::stringstream stream(list);
+	std::string value;
+	while (std::getline(stream, value, ','))
+		res.push_back(std::stoul(value));
+	if (res.empty())
+		throw std::runtime_error("Empty sweep " + list);
+	return res;
+}
+
+/*! Moves the options out of argv and stores them in benchOptions. The mode in argv[2] may start with -- as well. */
+void parseBenchOptions(int & argc, char ** & argv, std::vector<char *> & args)
+{
+	for (int i = 0; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (i < 3 || arg.compare(0, 2, "--") != 0)
+		{
+			args.push_back(argv[i]);
+			continue;
+		}
+		const size_t split = arg.find('=');
+		const std::string name = arg.substr(2, split - 2);
+		const std::string value = (split == std::string::npos) ? std::string() : arg.substr(split + 1);
+		if (name == "states")
+			benchOptions.states = parseSizes(value);
+		else if (name == "inputs")
+			benchOptions.inputs = parseSizes(value);
+		else if (name == "sims")
+			benchOptions.sims = parseSizes(value);
+		else if (name == "rounds")
+		{
+			benchOptions.rounds = std::stoul(value);
+			if (benchOptions.rounds == 0)
+				throw std::runtime_error("At least one round is needed " + arg);
+		}
+		else if (name == "format" && (value == "csv" || value == "json"))
+			benchOptions.json = value == "json";
+		else if (name == "hdr" && !value.empty())
+			benchOptions.hdrPrefix = value;
+		else if (name == "server-cpus" || name == "client-cpus")
+		{
+			const std::vector<size_t> cpus = parseSizes(value);
+			(name == "server-cpus" ? benchOptions.serverCpus : benchOptions.clientCpus).assign(cpus.begin(), cpus.end());
+		}
+		else
+			throw std::runtime_error("Unknown option " + arg);
+	}
+	args.push_back(nullptr);
+	argc = static_cast<int>(args.size()) - 1;
+	argv = args.data();
+}
+
+/*! Returns the value below which the fraction p of the sorted samples lies. */
+double percentile(const std::vector<double> & sorted, const double & p)
+{
+	return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+/*! Writes the sorted samples in the percentile distribution format of HdrHistogram, which its plotter reads. Like
+ * HdrHistogram every halving of the distance to the 100th percentile is reported with five values. */
+void writeHdrHistogram(const std::string & path, const std::vector<double> & sorted)
+{
+	std::ofstream file(path);
+	if (!file)
+		throw std::runtime_error("Couldn't write " + path);
+	const size_t numTicks = 5;
+	file << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n" << std::fixed;
+	size_t index = 0;
+	for (int halving = 0; index + 1 < sorted.size(); ++halving)
+	{
+		const double begin = 1.0 - std::ldexp(1.0, -halving);
+		for (size_t tick = 0; tick < numTicks && index + 1 < sorted.size(); ++tick)
+		{
+			const double p = begin + std::ldexp(1.0, -halving - 1) * tick / numTicks;
+			index = std::max(index, std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size())));
+			file << std::setw(12) << std::setprecision(3) << sorted[index] << " " << std::setprecision(12) << p << " " << std::setw(10) << index + 1 << " "
+					<< std::setw(14) << std::setprecision(2) << 1.0 / (1.0 - p) << "\n";
+		}
+	}
+	file << std::setw(12) << std::setprecision(3) << sorted.back() << " " << std::setprecision(12) << 1.0 << " " << std::setw(10) << sorted.size() << "\n";
+
+	double mean = 0.0, deviation = 0.0;
+	for (const double & value : sorted)
+		mean += value / sorted.size();
+	for (const double & value : sorted)
+		deviation += (value - mean) * (value - mean) / sorted.size();
+	file << std::setprecision(3) << "#[Mean    = " << std::setw(12) << mean << ", StdDeviation   = " << std::setw(12) << std::sqrt(deviation) << "]\n";
+	file << "#[Max     = " << std::setw(12) << sorted.back() << ", Total count    = " << std::setw(12) << sorted.size() << "]\n";
+}
+
+/*! Name of the running suite, its CSV columns are printed before its first record. */
+std::string benchSuiteName;
+bool benchColumnsPrinted = false;
+
+/*! Starts a suite of runs, whose title is printed in CSV. */
+void benchSuite(const std::string & name, const std::string & title)
+{
+	benchSuiteName = name;
+	benchColumnsPrinted = false;
+	if (!benchOptions.json)
+		std::cout << "\n" << title << ":\n";
+}
+
+/*! One run of a suite, printed as CSV row or JSON object with the fields in the order they were added. */
+struct BenchRecord
+{
+	struct Field
+	{
+		std::string name;
+		std::string value;
+		bool isNumber;
+		/*! Set by the run, not measured. */
+		bool isParameter;
+	};
+
+	std::vector<Field> _fields;
+
+	BenchRecord() :
+			_fields()
+	{
+	}
+
+	template<typename T>
+	BenchRecord & add(const std::string & name, const T & value, const bool & isParameter = false)
+	{
+		std::ostringstream stream;
+		stream << value;
+		_fields.push_back(Field { name, stream.str(), std::is_arithmetic<T>::value, isParameter });
+		return *this;
+	}
+
+	/*! Adds a field, which names the HDR histogram of the run. */
+	template<typename T>
+	BenchRecord & addParameter(const std::string & name, const T & value)
+	{
+		return add(name, value, true);
+	}
+
+	/*! Adds mean, percentiles and maximum of the latencies in microseconds and writes their HDR histogram, named
+	 * after the suite and the parameters of the run, so the files of repeated runs can be compared. */
+	BenchRecord & addLatencies(std::vector<double> & latencies)
+	{
+		std::sort(latencies.begin(), latencies.end());
+		if (!benchOptions.hdrPrefix.empty())
+		{
+			std::string path = benchOptions.hdrPrefix + benchSuiteName;
+			for (const Field & field : _fields)
+				if (field.isParameter)
+					path += "_" + field.value;
+			writeHdrHistogram(path + ".hgrm", latencies);
+		}
+		double mean = 0.0;
+		for (const double & latency : latencies)
+			mean += latency / latencies.size();
+		return add("mean [us]", mean).add("p50 [us]", percentile(latencies, 0.5)).add("p90 [us]", percentile(latencies, 0.9))
+				.add("p99 [us]", percentile(latencies, 0.99)).add("p99.9 [us]", percentile(latencies, 0.999)).add("max [us]", latencies.back());
+	}
+
+	/*! Prints one field per line for a single run. */
+	void printLines() const
+	{
+		for (const Field & field : _fields)
+			std::cout << field.name << ": " << std::string(std::max(1, 24 - static_cast<int>(field.name.size())), ' ') << field.value << "\n";
+	}
+
+	void print() const
+	{
+		if (benchOptions.json)
+		{
+			std::cout << "{\"suite\": \"" << benchSuiteName << "\"";
+			for (const Field & field : _fields)
+				std::cout << ", \"" << field.name << "\": " << (field.isNumber ? field.value : "\"" + field.value + "\"");
+			std::cout << "}\n";
+			return;
+		}
+		if (!benchColumnsPrinted)
+		{
+			for (size_t i = 0; i < _fields.size(); ++i)
+				std::cout << ((i > 0) ? ", " : "") << _fields[i].name;
+			std::cout << "\n";
+			benchColumnsPrinted = true;
+		}
+		for (size_t i = 0; i < _fields.size(); ++i)
+			std::cout << ((i > 0) ? "," : "") << _fields[i].value;
+		std::cout << "\n";
+	}
+};
+
+/*! Returns a free loopback port chosen by the OS. The port is released again for the server, which binds it
+ * immediately, so only a process binding it in between could take it. */
+int reserveLoopbackPort()
+{
+#ifndef NETOFF_USE_SDL_NET
+	sockaddr_in addr = sockaddr_in();
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addrLen = sizeof(addr);
+	const int sock = socket(AF_INET, SOCK_STREAM, 0);
+	const bool bound = sock >= 0 && bind(sock, reinterpret_cast<sockaddr *>(&addr), addrLen) == 0
+			&& getsockname(sock, reinterpret_cast<sockaddr *>(&addr), &addrLen) == 0;
+	if (sock >= 0)
+		close(sock);
+	if (!bound)
+		throw std::runtime_error("Couldn't reserve a loopback port.");
+	return ntohs(addr.sin_port);
+#else
+	return 3009;
+#endif
+}
+
+/*! Serves the initialization requests of the client until it started. Returns -1 then, otherwise the exit code of the
+ * server. */
+int BenchServerInit(NetOff::SimulationServer & noFS, std::vector<BenchSim> & fmus, const size_t & numStates)
+{
 	bool run = true;
 	NetOff::InitialClientMessageSpecifyer spec;
 	int requestedFmu, newFmuId;
@@ -67,8 +581,8 @@ int BenchServer(const int & port, const size_t & numStates)
 		{
 			// to react on this message the server has to call getAddedFmu()
 			std::tie(newFmuName, newFmuId) = noFS.getAddedSimulation();
-			// check if the fmu exists
-			if (newFmuName != "/home/of/very/funny/Fmu.fmu")
+			// check if the fmu exists, the client numbers the paths of further simulations
+			if (newFmuName.compare(0, benchSimPath.size() - 4, benchSimPath, 0, benchSimPath.size() - 4) != 0)
 			{
 				noFS.deinitialize();
 				return 1;
@@ -112,15 +626,54 @@ int BenchServer(const int & port, const size_t & numStates)
 			throw std::runtime_error("Received unknown request.");
 		}
 	}
+	return -1;
+}
 
-	// let the simulation run begin:
+/*! Serves one client. The i-th simulation computes work[i % work.size()] iterations per state and step. With
+ * numWorkers > 0 the server steps the simulations in parallel with stepSimulations(). */
+int BenchServer(const Transport & transport, const int & port, const size_t & numStates, const std::vector<size_t> & work = std::vector<size_t>(), const size_t & numWorkers = 0,
+		const NetOff::WaitPolicy & policy = NetOff::WaitPolicy::BLOCK)
+{
+	NetOff::SimulationServer noFS((transport == Transport::UNIX) ? benchSocketAddress(port) : std::to_string(port));
+	noFS.setSharedMemory(transport == Transport::SHM);
+	noFS.setIoUring(transport == Transport::URING);
+	noFS.setWaitPolicy(policy, latencySpinUs);
+	// open server
+	if (!noFS.initializeConnection())
+		throw std::runtime_error("Couldn't open server.");
+
+	std::vector<BenchSim> fmus;
+
+	// now wait for initialization requests of a client:
+	int res = BenchServerInit(noFS, fmus, numStates);
+	if (res >= 0)
+		return res;
+	for (size_t i = 0; i < fmus.size(); ++i)
+	{
+		fmus[i]._work = work.empty() ? 0 : work[i % work.size()];
+		if (numWorkers > 0)
+		{
+			// every simulation only touches its own BenchSim, so the steps can run concurrently
+			BenchSim * sim = &fmus[i];
+			noFS.setStepCallback(i, [sim](const double & time, const NetOff::ValueContainer & inputs, NetOff::ValueContainer & outputs)
+			{
+				outputs.setRealValues(sim->solveSplit(inputs.getRealValues(), time));
+			});
+		}
+	}
+	if (numWorkers > 0)
+		noFS.setNumWorkers(numWorkers);
 
-	run = true;
+	// let the simulation run begin:
+	int requestedFmu;
+	bool run = true;
 	while (run)
 	{
-		NetOff::ClientMessageSpecifyer spec = noFS.getClientRequest();
+		NetOff::ClientMessageSpecifyer spec = (numWorkers > 0) ? noFS.stepSimulations() : noFS.getClientRequest();
 		switch (spec)
 		{
+		case NetOff::ClientMessageSpecifyer::STEPPED:
+			break;
 		case NetOff::ClientMessageSpecifyer::INPUTS:
 		{
 			requestedFmu = noFS.getLastSimId();
@@ -137,11 +690,23 @@ int BenchServer(const int & port, const size_t & numStates)
 			noFS.sendOutputValues(requestedFmu, fmus[requestedFmu]._currentTime);
 			break;
 		}
+		case NetOff::ClientMessageSpecifyer::INPUTS_ALL:
+		{
+			// the inputs of all simulations arrived at once and are answered at once
+			for (size_t i = 0; i < fmus.size(); ++i)
+			{
+				NetOff::ValueContainer & inputs = noFS.getInputValueContainer(i);
+				fmus[i].solve(inputs.getRealValues(), noFS.getLastReceivedTime(i));
+				noFS.getOutputValueContainer(i).setRealValues(fmus[i]._states.get());
+			}
+			noFS.sendOutputValuesAll(fmus[0]._currentTime);
+			break;
+		}
 		case NetOff::ClientMessageSpecifyer::PAUSE:
 		{
 			// pause a bit (1sec):
 			noFS.confirmPause();
-			SDL_Delay(1000);
+			std::this_thread::sleep_for(std::chrono::seconds(1));
 			break;
 		}
 		case NetOff::ClientMessageSpecifyer::UNPAUSE:
@@ -173,56 +738,64 @@ int BenchServer(const int & port, const size_t & numStates)
 	return 0;
 }
 
-int BenchClient(const std::string & hostname, int port, const size_t & numInputs, const size_t & numRounds, const size_t numSims = 1ul, bool bench = false)
+/*! Steps numSims simulations per round, with one frame per simulation or, if batched, one frame for all. Every round
+ * is timed. */
+int BenchClient(const Transport & transport, const std::string & hostname, int port, const size_t & numInputs, const size_t & numRounds, const size_t numSims = 1ul, bool bench = false, bool batched = false)
 {
 	size_t numStates = 0;
 	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
-	NetOff::SimulationClient noFC(hostname, port);
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
 	// test if server can be reached
 	if (!noFC.initializeConnection())
 		throw std::runtime_error("Couldn't reach important server.");
 
 	std::vector<int> sims(numSims, -1);
 
-	std::shared_ptr<double> inputsClient(new double[numInputs]);
+	std::vector<double> inputsClient(numInputs);
 	for (size_t i = 0; i < numInputs; ++i)
 	{
-		inputsClient.get()[i] = i;
+		inputsClient[i] = i;
 	}
 
-	std::shared_ptr<double> outputsClient;
+	std::vector<double> outputsClient;
 
 	for (size_t i = 0; i < numSims; ++i)
 	{
 		// send server data about the fmu u want to calculate and get a handle ID of the fmu
-		sims[i] = noFC.addSimulation("/home/of/very/funny/Fmu.fmu");
+		sims[i] = noFC.addSimulation(benchSimPathOf(i));
 
 		// checkout the variables of the fmu
 		NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sims[i]);
 		numStates = all.getReals().size();
-		// set the input variables to send (in this case just the first variable of all fmu variables)
+		if (numInputs > numStates)
+			throw std::runtime_error("The simulation has less states than inputs.");
+		// set the input variables to send (in this case the first numInputs variables of all fmu variables)
 		NetOff::VariableList inputVars;
-		std::shared_ptr<double> inputsClient(new double[numInputs]);
 		for (size_t i = 0; i < numInputs; ++i)
 		{
 			inputVars.addReal(all.getReals()[i]);
 		}
 
 		if (i == 0)
-			outputsClient = std::shared_ptr<double>(new double[all.getReals().size()]);
+			outputsClient.resize(numStates);
 
 		// set the output variables, which should be received (in this case all fmu variables)
 		NetOff::VariableList outputVars;
 		outputVars = all;
 
-		noFC.initializeSimulation(sims[i], inputVars, outputVars, inputsClient.get(), nullptr, nullptr);
+		noFC.initializeSimulation(sims[i], inputVars, outputVars, inputsClient.data(), nullptr, nullptr);
 	}
 
 	// start the server
 	if (!noFC.start())
 		throw std::runtime_error("Couldn't start important server.");
 
+	noFC.resetNetworkCounters();
+	std::vector<double> latencies(numRounds);
 	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	std::chrono::high_resolution_clock::time_point roundStart = t2;
 	double t = 0;
 
 	for (size_t i = 0; i < numRounds; ++i)
@@ -231,137 +804,1208 @@ int BenchClient(const std::string & hostname, int port, const size_t & numInputs
 		for (size_t i = 0; i < numSims; ++i)
 		{
 			NetOff::ValueContainer & inputsServer = noFC.getInputValueContainer(sims[i]);
-			inputsServer.setRealValues(inputsClient.get());
+			inputsServer.setRealValues(inputsClient.data());
 			// send inputs
-			noFC.sendInputValues(sims[i], t, inputsServer);
+			if (!batched)
+				noFC.sendInputValues(sims[i], t, inputsServer);
 		}
-		// receive all ouputs
+		if (batched)
+		{
+			noFC.sendInputValuesAll(t);
+			noFC.recvOutputValuesAll(t);
+		}
+		// receive all ouputs, a server stepping in parallel answers the simulations in the order they finished
 		for (size_t i = 0; i < numSims; ++i)
 		{
 			// get outputs
-			NetOff::ValueContainer & outputsServer = noFC.recvOutputValues(sims[i], t);
-			std::copy(outputsServer.getRealValues(), outputsServer.getRealValues() + noFC.getPossibleOutputVariableNames(sims[i]).getReals().size(), outputsClient.get());
+			NetOff::ValueContainer & outputsServer = noFC.getOutputValueContainer(batched ? sims[i] : noFC.recvAnyOutput());
+			std::copy(outputsServer.getRealValues(), outputsServer.getRealValues() + numStates, outputsClient.begin());
 		}
 		t += 0.1;
+		// the end of a round is the start of the next one
+		const std::chrono::high_resolution_clock::time_point roundEnd = std::chrono::high_resolution_clock::now();
+		latencies[i] = std::chrono::duration<double, std::micro>(roundEnd - roundStart).count();
+		roundStart = roundEnd;
 	}
 
 	std::chrono::high_resolution_clock::time_point t3 = std::chrono::high_resolution_clock::now();
+	// syscalls and bytes of the socket layer per round
+	const NetOff::NetworkCounters counters = noFC.getNetworkCounters();
+	const double sendCalls = static_cast<double>(counters.numSendCalls) / numRounds;
+	const double recvCalls = static_cast<double>(counters.numRecvCalls) / numRounds;
+	const double bytes = static_cast<double>(counters.numBytesSent + counters.numBytesReceived) / numRounds;
 	noFC.deinitialize();
 
 	std::chrono::high_resolution_clock::time_point t4 = std::chrono::high_resolution_clock::now();
+	const double simTime = std::chrono::duration<double>(t3 - t2).count();
 
+	BenchRecord record;
+	record.addParameter("transport", transportName(transport)).addParameter("numSims", numSims).addParameter("numStates", numStates).addParameter("numInputs", numInputs);
+	record.add("initTime [s]", std::chrono::duration<double>(t2 - t1).count()).add("deinitTime [s]", std::chrono::duration<double>(t4 - t3).count());
+	record.addLatencies(latencies);
+	record.add("steps/s", numRounds * numSims / simTime).add("MB/s", bytes * numRounds / simTime / 1e6);
+	record.add("sendCalls/round", sendCalls).add("recvCalls/round", recvCalls).add("bytes/round", bytes);
 	if (!bench)
 	{
 		std::cout << "Connection to host: " << hostname << " on port " << port << ":\n";
-		std::cout << "Initialization: 	" << std::chrono::duration<double>(t2 - t1).count() << "\n";
-		std::cout << "Simulation: 		" << std::chrono::duration<double>(t3 - t2).count() << "\n";
-		std::cout << "Deinitialization: 	" << std::chrono::duration<double>(t4 - t3).count() << "\n";
+		record.printLines();
 	} else
-		std::cout << numSims << "," << numStates << "," << numInputs << "," << std::chrono::duration<double>(t2 - t1).count() << ","
-				<< std::chrono::duration<double>(t3 - t2).count() / numRounds << "," << std::chrono::duration<double>(t4 - t3).count() << "\n";
+		record.print();
 	return 0;
 }
 
-int main(int argc, char * argv[])
+int BenchMultiServer(const Transport & transport, const int & port, const size_t & numStates, const size_t & numSessions)
 {
-	if (argc < 2)
-	{
-		std::cout << "Usage 1: ./NetOffBenchmark client [numInputs]  [numRounds] [port] [servername]\n";
-		std::cout << "Usage 2: ./NetOffBenchmark server [numStates] [port]\n";
-		std::cout << "If no servername is set, the program will start a server, otherwise a client.\n";
-		std::cout << "Usage 3: ./NetOffBenchmark [client | server] bench will start a predefined scaling benchmark.\n";
-		return 0;
-	}
-	const size_t roundsPerTest = 10;
-	const size_t numRounds = 1000;
-	const size_t statesStart = 16;
-	const double percentInputs = 0.1;
-	const int port = 3009;
-	if (std::string(argv[1]) == std::string("client"))
+	NetOff::SimulationServer noFS((transport == Transport::UNIX) ? benchSocketAddress(port) : std::to_string(port));
+	noFS.setSharedMemory(transport == Transport::SHM);
+	noFS.setIoUring(transport == Transport::URING);
+	noFS.setMaxClients(64);
+	// open server, the clients are accepted in the event loop
+	if (!noFS.initializeConnection())
+		throw std::runtime_error("Couldn't open server.");
+
+	// every client has its own simulations, selected by its client id
+	std::map<int, std::vector<BenchSim>> fmus;
+	size_t finishedSessions = 0;
+	while (finishedSessions < numSessions)
 	{
-		if (std::string(argv[2]) == std::string("bench"))
+		const int clientId = noFS.waitForClientRequest();
+		std::vector<BenchSim> & sims = fmus[clientId];
+		if (!noFS.isClientStarted())
 		{
-			///////////////////////////////////////// STATES SCALE ///////////////////////////////////////////
-			// Scales the number of states from 16 to 8192 for 16 input variables.                          //
-		    //////////////////////////////////////////////////////////////////////////////////////////////////
-			std::cout << "Scale states with _" << numRounds << " rounds:\n";
-			std::cout << "numSims, numStates, numInputs, initTime, simTime/rounds, deinitTime\n";
-			size_t stateIt = statesStart;
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			switch (noFS.getInitialClientRequest())
+			{
+			case NetOff::InitialClientMessageSpecifyer::ADD_SIM:
 			{
-				BenchClient(argv[3], port, statesStart, numRounds, 1, true);
-				stateIt *= 2;
+				std::string newFmuName;
+				int newFmuId;
+				std::tie(newFmuName, newFmuId) = noFS.getAddedSimulation();
+				sims.push_back(BenchSim(numStates));
+				noFS.confirmSimulationAdd(newFmuId, sims.back()._vars, sims.back()._vars);
+				break;
 			}
-			std::cout << "\n";
-
-			///////////////////////////////////////// INPUTES SCALE //////////////////////////////////////////
-			// Scales the number of input variables from 100 to 1000 using 1000 states.                     //
-			//////////////////////////////////////////////////////////////////////////////////////////////////
-			std::cout << "Scale input variables with _" << numRounds << " rounds and 1000 states:\n";
-			std::cout << "numSims,numStates, numInputs, initTime, simTime/rounds, deinitTime\n";
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			case NetOff::InitialClientMessageSpecifyer::INIT_SIM:
 			{
-				BenchClient(argv[3], port, std::min((unsigned) (1000 * i * percentInputs), 1000u), numRounds, 1, true);
+				const int requestedFmu = noFS.getLastSimId();
+				sims[requestedFmu]._numInputs = noFS.getSelectedInputVariables(requestedFmu).getReals().size();
+				sims[requestedFmu].init(noFS.getInputValueContainer(requestedFmu).getRealValues());
+				NetOff::ValueContainer & outputVals = noFS.getOutputValueContainer(requestedFmu);
+				outputVals.setRealValues(sims[requestedFmu]._states.get());
+				noFS.confirmSimulationInit(requestedFmu, outputVals);
+				break;
 			}
-			std::cout << "\n";
-
-
-			///////////////////////////////////////// SIMULATION SCALE with CONSTANT LOAD ////////////////////
-			// Scales the number of simulations from 1 to 512 and the number of states from 1024 to 2. Thus,//
-			// the load per simulation is constant.                                                         //
-		    //////////////////////////////////////////////////////////////////////////////////////////////////
-			std::cout << "Scale sims with _" << numRounds << " rounds and 1024 states:\n";
-			std::cout << "numSims,numStates, numInputs, initTime, simTime/rounds, deinitTime\n";
-			size_t curSimNum = 1;
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			case NetOff::InitialClientMessageSpecifyer::START:
 			{
-				BenchClient(argv[3], port, 1, 1000u, curSimNum, true);
-				curSimNum *= 2;
+				noFS.confirmStart();
+				break;
+			}
+			case NetOff::InitialClientMessageSpecifyer::CLIENT_INIT_ABORT:
+			{
+				// only this client is gone, the others are still served
+				noFS.disconnectClient();
+				fmus.erase(clientId);
+				++finishedSessions;
+				break;
+			}
+			default:
+				throw std::runtime_error("Received unknown request.");
 			}
-
-			return 0;
 		}
 		else
 		{
-			size_t numInputs = std::stoi(argv[2]);
-			size_t numRounds = std::stoi(argv[3]);
-			int port = std::stoi(argv[4]);
-			return BenchClient(argv[5], port, numInputs, numRounds);
-		}
-	}
-	else if (std::string(argv[1]) == std::string("server"))
-	{
-		if (std::string(argv[2]) == std::string("bench"))
-		{
-		    ///////////////////////////////////////// STATES SCALE ///////////////////////////////////////////
-			size_t stateIt = statesStart;
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			switch (noFS.getClientRequest())
 			{
-				BenchServer(port, stateIt);
-				stateIt *= 2u;
-			}
-
-		    ///////////////////////////////////////// INPUTES SCALE //////////////////////////////////////////
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			case NetOff::ClientMessageSpecifyer::INPUTS:
 			{
-				BenchServer(port, 1000);
+				const int requestedFmu = noFS.getLastSimId();
+				NetOff::ValueContainer & inputs = noFS.recvInputValues(requestedFmu);
+				sims[requestedFmu].solve(inputs.getRealValues(), noFS.getLastReceivedTime(requestedFmu));
+				NetOff::ValueContainer & outputs = noFS.getOutputValueContainer(requestedFmu);
+				outputs.setRealValues(sims[requestedFmu]._states.get());
+				noFS.sendOutputValues(requestedFmu, sims[requestedFmu]._currentTime);
+				break;
 			}
-
-		    ///////////////////////////////////////// SIMULATION SCALE with CONSTANT LOAD ////////////////////
-			size_t curSimNum = 1;
-			for (size_t i = 1; i <= roundsPerTest; ++i)
+			case NetOff::ClientMessageSpecifyer::CLIENT_ABORT:
 			{
-				BenchServer(port, 1024 / curSimNum);
-				curSimNum *= 2;
+				noFS.disconnectClient();
+				fmus.erase(clientId);
+				++finishedSessions;
+				break;
+			}
+			default:
+				throw std::runtime_error("Received unsupported request.");
 			}
-
-			return 0;
-		} else
-		{
-			size_t numStates = std::stoi(argv[2]);
-			int port = std::stoi(argv[3]);
-			return BenchServer(port, numStates);
 		}
 	}
+	noFS.deinitialize();
+	return 0;
+}
+
+/*! One client of the multi client benchmark. It steps one simulation, whose states are all inputs and outputs. The
+ * rounds start, when all clients are started. */
+void BenchMultiClientWorker(const Transport & transport, const std::string & hostname, int port, const size_t & numRounds,
+		const size_t & numClients, std::atomic<size_t> & numReady, std::chrono::high_resolution_clock::time_point & tStart,
+		std::chrono::high_resolution_clock::time_point & tEnd)
+{
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+
+	int sim = noFC.addSimulation(benchSimPath);
+	NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+	std::vector<double> values(all.getReals().size(), 1.0);
+	noFC.initializeSimulation(sim, all, all, values.data(), nullptr, nullptr);
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+
+	++numReady;
+	while (numReady < numClients)
+		std::this_thread::yield();
+
+	tStart = std::chrono::high_resolution_clock::now();
+	double t = 0;
+	for (size_t i = 0; i < numRounds; ++i)
+	{
+		NetOff::ValueContainer & inputs = noFC.getInputValueContainer(sim);
+		inputs.setRealValues(values.data());
+		noFC.sendInputValues(sim, t, inputs);
+		NetOff::ValueContainer & outputs = noFC.recvOutputValues(sim, t);
+		std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+		t += 0.1;
+	}
+	tEnd = std::chrono::high_resolution_clock::now();
+	noFC.deinitialize();
+}
+
+int BenchMultiClient(const Transport & transport, const std::string & hostname, int port, const size_t & numClients, const size_t & numStates, const size_t & numRounds, bool bench = false)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	std::atomic<size_t> numReady(0);
+	std::vector<Clock::time_point> starts(numClients), ends(numClients);
+	std::vector<std::thread> clients;
+	for (size_t i = 0; i < numClients; ++i)
+		clients.push_back(std::thread(BenchMultiClientWorker, transport, hostname, port, numRounds, numClients, std::ref(numReady), std::ref(starts[i]), std::ref(ends[i])));
+	for (std::thread & client : clients)
+		client.join();
 
+	// the aggregate throughput covers the time from the first start to the last finish
+	const double simTime = std::chrono::duration<double>(*std::max_element(ends.begin(), ends.end()) - *std::min_element(starts.begin(), starts.end())).count();
+	const double steps = static_cast<double>(numClients * numRounds) / simTime;
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << " with " << numClients << " clients:\n";
+		std::cout << "Transport: 		" << transportName(transport) << "\n";
+		std::cout << "Simulation: 		" << simTime << "\n";
+		std::cout << "Steps/s: 		" << steps << "\n";
+		std::cout << "Steps/s per client: 	" << steps / numClients << "\n";
+	} else
+		std::cout << transportName(transport) << "," << numClients << "," << numClients << "," << numStates << "," << simTime << "," << steps << "," << steps / numClients << "\n";
+	return 0;
+}
+
+/*! Same as the multi client benchmark, but all clients are driven by the calling thread. It waits until the socket
+ * of any client becomes readable and reads the outputs without blocking. */
+int BenchEventLoopClient(const Transport & transport, const std::string & hostname, int port, const size_t & numClients, const size_t & numStates, const size_t & numRounds, bool bench = false)
+{
+	std::vector<std::unique_ptr<NetOff::SimulationClient>> clients;
+	std::vector<std::vector<double>> values;
+	for (size_t i = 0; i < numClients; ++i)
+	{
+		clients.push_back(std::unique_ptr<NetOff::SimulationClient>(new NetOff::SimulationClient((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port)));
+		NetOff::SimulationClient & noFC = *clients.back();
+		if (transport != Transport::SHM)
+			noFC.setSharedMemorySize(0);
+		if (!noFC.initializeConnection())
+			throw std::runtime_error("Couldn't reach important server.");
+		int sim = noFC.addSimulation(benchSimPath);
+		NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+		values.push_back(std::vector<double>(all.getReals().size(), 1.0));
+		noFC.initializeSimulation(sim, all, all, values.back().data(), nullptr, nullptr);
+		if (!noFC.start())
+			throw std::runtime_error("Couldn't start important server.");
+	}
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	std::vector<size_t> numSteps(numClients, 0);
+	size_t numActive = numClients;
+	for (size_t i = 0; i < numClients; ++i)
+	{
+		NetOff::ValueContainer & inputs = clients[i]->getInputValueContainer(0);
+		inputs.setRealValues(values[i].data());
+		clients[i]->sendInputValues(0, 0.0, inputs);
+	}
+	while (numActive > 0)
+	{
+		for (size_t i = 0; i < numClients; ++i)
+		{
+			// the last unsuccessful try prepares the client for the wait
+			while (numSteps[i] < numRounds && clients[i]->tryRecvOutputValues(0))
+			{
+				NetOff::ValueContainer & outputs = clients[i]->getOutputValueContainer(0);
+				std::copy(outputs.getRealValues(), outputs.getRealValues() + values[i].size(), values[i].begin());
+				if (++numSteps[i] == numRounds)
+				{
+					--numActive;
+					break;
+				}
+				NetOff::ValueContainer & inputs = clients[i]->getInputValueContainer(0);
+				inputs.setRealValues(values[i].data());
+				clients[i]->sendInputValues(0, 0.1 * numSteps[i], inputs);
+			}
+		}
+#ifndef NETOFF_USE_SDL_NET
+		std::vector<pollfd> fds(numClients);
+		for (size_t i = 0; i < numClients; ++i)
+		{
+			fds[i].fd = (numSteps[i] < numRounds) ? clients[i]->nativeHandle() : -1;
+			fds[i].events = POLLIN;
+		}
+		if (numActive > 0)
+			poll(fds.data(), fds.size(), -1);
+#endif
+	}
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	for (std::unique_ptr<NetOff::SimulationClient> & noFC : clients)
+		noFC->deinitialize();
+
+	const double simTime = std::chrono::duration<double>(t2 - t1).count();
+	const double steps = static_cast<double>(numClients * numRounds) / simTime;
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << " with " << numClients << " clients on one thread:\n";
+		std::cout << "Transport: 		" << transportName(transport) << "\n";
+		std::cout << "Simulation: 		" << simTime << "\n";
+		std::cout << "Steps/s: 		" << steps << "\n";
+		std::cout << "Steps/s per client: 	" << steps / numClients << "\n";
+	} else
+		std::cout << transportName(transport) << ",1," << numClients << "," << numStates << "," << simTime << "," << steps << "," << steps / numClients << "\n";
+	return 0;
+}
+
+/*! Steps one simulation, whose states are all inputs and outputs, with up to depth steps in flight. The inputs of a
+ * step don't wait for the outputs of the previous one, so the round trips of the steps overlap. */
+int BenchPipelineClient(const Transport & transport, const std::string & hostname, int port, const size_t & depth, const size_t & numRounds, bool bench = false)
+{
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+
+	int sim = noFC.addSimulation(benchSimPath);
+	NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+	std::vector<double> values(all.getReals().size(), 1.0);
+	noFC.initializeSimulation(sim, all, all, values.data(), nullptr, nullptr);
+	noFC.setPipelineDepth(depth);
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	double t = 0;
+	size_t numSent = 0;
+	for (size_t i = 0; i < numRounds; ++i)
+	{
+		// keep the pipeline filled
+		while (numSent < numRounds && noFC.getNumPendingSteps(sim) < depth)
+		{
+			NetOff::ValueContainer & inputs = noFC.getInputValueContainer(sim);
+			inputs.setRealValues(values.data());
+			noFC.sendInputValues(sim, t, inputs);
+			t += 0.1;
+			++numSent;
+		}
+		NetOff::ValueContainer & outputs = noFC.recvOutputValues(sim, t);
+		std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+	}
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	noFC.deinitialize();
+
+	const double simTime = std::chrono::duration<double>(t2 - t1).count();
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << " with pipeline depth " << depth << ":\n";
+		std::cout << "Transport: 		" << transportName(transport) << "\n";
+		std::cout << "Simulation: 		" << simTime << "\n";
+		std::cout << "Steps/s: 		" << numRounds / simTime << "\n";
+	} else
+		std::cout << transportName(transport) << "," << depth << "," << values.size() << "," << simTime / numRounds << "," << numRounds / simTime << "\n";
+	return 0;
+}
+
+/*! Measures the round trip time of every step of one small simulation, while client and server wait with the given
+ * policy. */
+int BenchLatencyClient(const Transport & transport, const std::string & hostname, int port, const NetOff::WaitPolicy & policy, const size_t & numRounds, bool bench = false)
+{
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	noFC.setWaitPolicy(policy, latencySpinUs);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+
+	int sim = noFC.addSimulation(benchSimPath);
+	NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+	std::vector<double> values(all.getReals().size(), 1.0);
+	noFC.initializeSimulation(sim, all, all, values.data(), nullptr, nullptr);
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+
+	noFC.resetNetworkCounters();
+	std::vector<double> rtts(numRounds);
+	std::chrono::high_resolution_clock::time_point tStart = std::chrono::high_resolution_clock::now();
+	double t = 0;
+	for (size_t i = 0; i < numRounds; ++i)
+	{
+		std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+		NetOff::ValueContainer & inputs = noFC.getInputValueContainer(sim);
+		inputs.setRealValues(values.data());
+		noFC.sendInputValues(sim, t, inputs);
+		NetOff::ValueContainer & outputs = noFC.recvOutputValues(sim, t);
+		std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+		std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+		rtts[i] = std::chrono::duration<double, std::micro>(t2 - t1).count();
+		t += 0.1;
+	}
+	const double simTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - tStart).count();
+	const NetOff::NetworkCounters counters = noFC.getNetworkCounters();
+	noFC.deinitialize();
+
+	BenchRecord record;
+	record.addParameter("transport", transportName(transport)).addParameter("policy", waitPolicyName(policy)).addParameter("numStates", values.size());
+	record.addLatencies(rtts);
+	record.add("steps/s", numRounds / simTime).add("MB/s", (counters.numBytesSent + counters.numBytesReceived) / simTime / 1e6);
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << " waiting with " << waitPolicyName(policy) << ":\n";
+		record.printLines();
+	} else
+		record.print();
+	return 0;
+}
+
+/*! Serves one client like BenchServer() and counts the heap allocations of the handshake and of the steps. With
+ * numWorkers > 0 the steps run in parallel with stepSimulations(), whose first round starts the workers and isn't
+ * counted. Returns 1, if the steps allocated. */
+int BenchAllocServer(const Transport & transport, const int & port, const size_t & numStates, const size_t & numWorkers = 0)
+{
+	const size_t allocsStart = countHeapAllocs();
+	NetOff::SimulationServer noFS((transport == Transport::UNIX) ? benchSocketAddress(port) : std::to_string(port));
+	noFS.setSharedMemory(transport == Transport::SHM);
+	noFS.setIoUring(transport == Transport::URING);
+	if (!noFS.initializeConnection())
+		throw std::runtime_error("Couldn't open server.");
+
+	std::vector<BenchSim> fmus;
+	int res = BenchServerInit(noFS, fmus, numStates);
+	if (res >= 0)
+		return res;
+	std::atomic<size_t> numParallelSteps(0);
+	for (size_t i = 0; i < fmus.size() && numWorkers > 0; ++i)
+	{
+		BenchSim * sim = &fmus[i];
+		noFS.setStepCallback(i, [sim, &numParallelSteps](const double & time, const NetOff::ValueContainer & inputs, NetOff::ValueContainer & outputs)
+		{
+			outputs.setRealValues(sim->solve(inputs.getRealValues(), time));
+			++numParallelSteps;
+		});
+	}
+	if (numWorkers > 0)
+		noFS.setNumWorkers(numWorkers);
+
+	size_t allocsStarted = countHeapAllocs();
+	size_t allocsStepped = allocsStarted;
+	size_t numSteps = 0;
+	bool run = true;
+	while (run)
+	{
+		switch ((numWorkers > 0) ? noFS.stepSimulations() : noFS.getClientRequest())
+		{
+		case NetOff::ClientMessageSpecifyer::STEPPED:
+		{
+			allocsStepped = countHeapAllocs();
+			if (numSteps == 0)
+				allocsStarted = allocsStepped;
+			numSteps = numParallelSteps;
+			break;
+		}
+		case NetOff::ClientMessageSpecifyer::INPUTS:
+		{
+			const int requestedFmu = noFS.getLastSimId();
+			NetOff::ValueContainer & inputs = noFS.recvInputValues(requestedFmu);
+			fmus[requestedFmu].solve(inputs.getRealValues(), noFS.getLastReceivedTime(requestedFmu));
+			noFS.getOutputValueContainer(requestedFmu).setRealValues(fmus[requestedFmu]._states.get());
+			noFS.sendOutputValues(requestedFmu, fmus[requestedFmu]._currentTime);
+			allocsStepped = countHeapAllocs();
+			++numSteps;
+			break;
+		}
+		case NetOff::ClientMessageSpecifyer::INPUTS_ALL:
+		{
+			for (size_t i = 0; i < fmus.size(); ++i)
+			{
+				fmus[i].solve(noFS.getInputValueContainer(i).getRealValues(), noFS.getLastReceivedTime(i));
+				noFS.getOutputValueContainer(i).setRealValues(fmus[i]._states.get());
+			}
+			noFS.sendOutputValuesAll(fmus[0]._currentTime);
+			allocsStepped = countHeapAllocs();
+			numSteps += fmus.size();
+			break;
+		}
+		case NetOff::ClientMessageSpecifyer::CLIENT_ABORT:
+		{
+			noFS.deinitialize();
+			run = false;
+			break;
+		}
+		default:
+			throw std::runtime_error("Received unexpected request.");
+		}
+	}
+
+	const size_t handshakeAllocs = allocsStarted - allocsStart;
+	const size_t stepAllocs = allocsStepped - allocsStarted;
+	std::cout << "server," << transportName(transport) << "," << fmus.size() << "," << handshakeAllocs << "," << numSteps << "," << stepAllocs << "\n";
+	if (stepAllocs > 0)
+	{
+		std::cerr << "The server allocated " << stepAllocs << " times in " << numSteps << " steps over " << transportName(transport) << ".\n";
+		return 1;
+	}
+	return 0;
+}
+
+/*! Steps numSims simulations, whose states are all inputs and outputs, and counts the heap allocations of every
+ * handshake phase and of the steps. The mode is "single" (per simulation), "batched" or "any order", which receives
+ * the outputs of a server stepping in parallel in completion order, out of order and without blocking in turn.
+ * Returns 1, if the steps allocated. */
+int BenchAllocClient(const Transport & transport, const std::string & hostname, int port, const size_t & numSims, const size_t & numRounds, const std::string & mode)
+{
+	const bool batched = (mode == "batched");
+	size_t allocs = countHeapAllocs();
+	// allocations since the last call
+	auto allocsSince = [&allocs]()
+	{
+		const size_t last = allocs;
+		allocs = countHeapAllocs();
+		return allocs - last;
+	};
+
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+	const size_t connectAllocs = allocsSince();
+
+	std::vector<int> sims(numSims);
+	std::vector<NetOff::VariableList> vars(numSims);
+	for (size_t i = 0; i < numSims; ++i)
+	{
+		sims[i] = noFC.addSimulation(benchSimPathOf(i));
+		vars[i] = noFC.getPossibleOutputVariableNames(sims[i]);
+	}
+	const size_t addAllocs = allocsSince();
+
+	std::vector<double> values(vars[0].getReals().size(), 1.0);
+	for (size_t i = 0; i < numSims; ++i)
+		noFC.initializeSimulation(sims[i], vars[i], vars[i], values.data(), nullptr, nullptr);
+	const size_t initAllocs = allocsSince();
+
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+	const size_t startAllocs = allocsSince();
+
+	double t = 0;
+	for (size_t i = 0; i < numRounds; ++i)
+	{
+		for (size_t j = 0; j < numSims; ++j)
+		{
+			NetOff::ValueContainer & inputs = noFC.getInputValueContainer(sims[j]);
+			inputs.setRealValues(values.data());
+			if (!batched)
+				noFC.sendInputValues(sims[j], t, inputs);
+		}
+		if (batched)
+		{
+			noFC.sendInputValuesAll(t);
+			noFC.recvOutputValuesAll(t);
+		}
+		for (size_t j = 0; j < numSims; ++j)
+		{
+			int sim = sims[j];
+			if (mode == "single")
+				noFC.recvOutputValues(sim, t);
+			else if (mode == "any order")
+			{
+				// the answers of the other simulations arriving meanwhile are stored as early answers
+				if (i % 3 == 0)
+					sim = noFC.recvAnyOutput();
+				else if (i % 3 == 1)
+					noFC.recvOutputValues(sim = sims[numSims - 1 - j], t);
+				else
+					while (!noFC.tryRecvOutputValues(sim))
+						std::this_thread::yield();
+			}
+			NetOff::ValueContainer & outputs = noFC.getOutputValueContainer(sim);
+			std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+		}
+		t += 0.1;
+	}
+	const size_t stepAllocs = allocsSince();
+	noFC.deinitialize();
+
+	std::cout << transportName(transport) << "," << numSims << "," << mode << "," << connectAllocs << "," << addAllocs << ","
+			<< initAllocs << "," << startAllocs << "," << stepAllocs << "," << static_cast<double>(stepAllocs) / (numRounds * numSims) << "\n";
+	if (stepAllocs > 0)
+	{
+		std::cerr << "The client allocated " << stepAllocs << " times in " << numRounds * numSims << " steps over " << transportName(transport) << ".\n";
+		return 1;
+	}
+	return 0;
+}
+
+/*! Stands in for the work of a frontend between two steps, e.g. rendering the outputs. */
+double benchRender(const std::vector<double> & values, const size_t & work)
+{
+	double sum = 0.0;
+	for (size_t k = 0; k < work; ++k)
+		for (const double & value : values)
+			sum += std::sin(value + k);
+	return sum;
+}
+
+/*! Steps one simulation, whose states are all inputs and outputs, and renders every step. The synchronous client
+ * renders after the outputs arrived, the asynchronous one renders the previous outputs while the step runs. */
+int BenchAsyncClient(const Transport & transport, const std::string & hostname, int port, const size_t & renderWork, const size_t & numRounds, bool async, bool bench = false)
+{
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+
+	int sim = noFC.addSimulation(benchSimPath);
+	NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+	std::vector<double> values(all.getReals().size(), 1.0);
+	noFC.initializeSimulation(sim, all, all, values.data(), nullptr, nullptr);
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	double t = 0;
+	// keeps the rendering from being optimized away
+	volatile double sink = 0;
+	if (async)
+	{
+		NetOff::AsyncSimulationClient asyncFC(noFC);
+		NetOff::StepValues inputs;
+		for (size_t i = 0; i < numRounds; ++i)
+		{
+			inputs.reals = values;
+			asyncFC.sendInputValuesAsync(sim, t, inputs);
+			std::future<NetOff::StepValues> outputs = asyncFC.recvOutputValuesAsync(sim, t);
+			sink += benchRender(values, renderWork);
+			values = outputs.get().reals;
+			t += 0.1;
+		}
+	} else
+	{
+		for (size_t i = 0; i < numRounds; ++i)
+		{
+			NetOff::ValueContainer & inputs = noFC.getInputValueContainer(sim);
+			inputs.setRealValues(values.data());
+			noFC.sendInputValues(sim, t, inputs);
+			NetOff::ValueContainer & outputs = noFC.recvOutputValues(sim, t);
+			std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+			sink += benchRender(values, renderWork);
+			t += 0.1;
+		}
+	}
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	noFC.deinitialize();
+
+	const double simTime = std::chrono::duration<double>(t2 - t1).count();
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << ((async) ? " stepping asynchronously" : " stepping synchronously") << ":\n";
+		std::cout << "Transport: 		" << transportName(transport) << "\n";
+		std::cout << "Simulation: 		" << simTime << "\n";
+		std::cout << "Steps/s: 		" << numRounds / simTime << "\n";
+	} else
+		std::cout << transportName(transport) << "," << ((async) ? "async" : "sync") << "," << values.size() << "," << simTime / numRounds << "," << numRounds / simTime << "\n";
+	return 0;
+}
+
+/*! Runs the simulations freely and pushes the outputs of the subscribed ones. Inputs are applied as updates. */
+int BenchStreamServer(const Transport & transport, const int & port, const size_t & numStates)
+{
+	NetOff::SimulationServer noFS((transport == Transport::UNIX) ? benchSocketAddress(port) : std::to_string(port));
+	noFS.setSharedMemory(transport == Transport::SHM);
+	noFS.setIoUring(transport == Transport::URING);
+	if (!noFS.initializeConnection())
+		throw std::runtime_error("Couldn't open server.");
+
+	std::vector<BenchSim> fmus;
+	int res = BenchServerInit(noFS, fmus, numStates);
+	if (res >= 0)
+		return res;
+
+	std::vector<double> inputs(numStates, 0.0);
+	double t = 0;
+	bool run = true;
+	while (run)
+	{
+		bool subscribed = false;
+		for (size_t i = 0; i < fmus.size(); ++i)
+			subscribed = subscribed || noFS.isSubscribed(i);
+		// without subscriptions the server just waits for the next request
+		while (run && noFS.waitForClientRequest(subscribed ? 0 : -1) >= 0)
+		{
+			switch (noFS.getClientRequest())
+			{
+			case NetOff::ClientMessageSpecifyer::SUBSCRIBE:
+			case NetOff::ClientMessageSpecifyer::UNSUBSCRIBE:
+				break;
+			case NetOff::ClientMessageSpecifyer::INPUTS:
+			{
+				// inputs of a subscribed simulation are updates, the others are stepped and answered
+				const int requestedFmu = noFS.getLastSimId();
+				NetOff::ValueContainer & update = noFS.recvInputValues(requestedFmu);
+				std::copy(update.getRealValues(), update.getRealValues() + fmus[requestedFmu]._numInputs, inputs.begin());
+				if (!noFS.isSubscribed(requestedFmu))
+				{
+					fmus[requestedFmu].solve(inputs.data(), noFS.getLastReceivedTime(requestedFmu));
+					noFS.getOutputValueContainer(requestedFmu).setRealValues(fmus[requestedFmu]._states.get());
+					noFS.sendOutputValues(requestedFmu, fmus[requestedFmu]._currentTime);
+				}
+				break;
+			}
+			case NetOff::ClientMessageSpecifyer::CLIENT_ABORT:
+				run = false;
+				break;
+			default:
+				throw std::runtime_error("Received unsupported request.");
+			}
+			subscribed = true;
+		}
+		// one step of every simulation
+		for (size_t i = 0; run && i < fmus.size(); ++i)
+		{
+			if (!noFS.isSubscribed(i))
+				continue;
+			fmus[i].solve(inputs.data(), t);
+			noFS.getOutputValueContainer(i).setRealValues(fmus[i]._states.get());
+			noFS.pushOutputValues(i, t);
+		}
+		t += 0.1;
+	}
+	noFS.deinitialize();
+	return 0;
+}
+
+/*! Subscribes to one simulation and polls its outputs like a display loop, which never waits for a round trip. */
+int BenchStreamClient(const Transport & transport, const std::string & hostname, int port, const size_t & numFrames, bool bench = false)
+{
+	NetOff::SimulationClient noFC((transport == Transport::UNIX) ? benchSocketAddress(port) : hostname, port);
+	if (transport != Transport::SHM)
+		noFC.setSharedMemorySize(0);
+	if (!noFC.initializeConnection())
+		throw std::runtime_error("Couldn't reach important server.");
+
+	int sim = noFC.addSimulation(benchSimPath);
+	NetOff::VariableList all = noFC.getPossibleOutputVariableNames(sim);
+	std::vector<double> values(all.getReals().size(), 1.0);
+	noFC.initializeSimulation(sim, all, all, values.data(), nullptr, nullptr);
+	if (!noFC.start())
+		throw std::runtime_error("Couldn't start important server.");
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	noFC.subscribe(sim, 0.0);
+	size_t numReceived = 0, numPolls = 0;
+	while (numReceived < numFrames)
+	{
+		bool received = false;
+		NetOff::ValueContainer & outputs = noFC.pollLatestOutputs(sim, &received, 1000);
+		if (received)
+		{
+			std::copy(outputs.getRealValues(), outputs.getRealValues() + values.size(), values.begin());
+			++numReceived;
+		}
+		++numPolls;
+	}
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+	// the answer of a step follows the outputs pushed before the server unsubscribed
+	noFC.unsubscribe(sim);
+	noFC.sendInputValues(sim, 0.0, noFC.getInputValueContainer(sim));
+	noFC.recvOutputValues(sim, 0.0);
+	noFC.deinitialize();
+
+	const double simTime = std::chrono::duration<double>(t2 - t1).count();
+	if (!bench)
+	{
+		std::cout << "Connection to host: " << hostname << " on port " << port << " streaming outputs:\n";
+		std::cout << "Transport: 		" << transportName(transport) << "\n";
+		std::cout << "Simulation: 		" << simTime << "\n";
+		std::cout << "Updates/s: 		" << numFrames / simTime << "\n";
+		std::cout << "Polls/update: 		" << static_cast<double>(numPolls) / numFrames << "\n";
+	} else
+		std::cout << transportName(transport) << ",0," << values.size() << "," << simTime / numFrames << "," << numFrames / simTime << "," << static_cast<double>(numPolls) / numFrames << "\n";
+	return 0;
+}
+
+int main(int argc, char * argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage 1: ./NetOffBenchmark client [numInputs]  [numRounds] [port] [servername]\n";
+		std::cout << "Usage 2: ./NetOffBenchmark server [numStates] [port]\n";
+		std::cout << "If no servername is set, the program will start a server, otherwise a client.\n";
+		std::cout << "Usage 3: ./NetOffBenchmark client bench [servername] [transports] and ./NetOffBenchmark server bench [transports]\n";
+		std::cout << "         will start a predefined scaling benchmark.\n";
+		std::cout << "Usage 4: ./NetOffBenchmark client multi [servername] [transports] and ./NetOffBenchmark server multi [transports]\n";
+		std::cout << "         will scale the number of concurrent clients.\n";
+		std::cout << "Usage 5: ./NetOffBenchmark client pipeline [servername] [transports] and ./NetOffBenchmark server pipeline [transports]\n";
+		std::cout << "         will scale the number of steps in flight.\n";
+		std::cout << "Usage 6: ./NetOffBenchmark client stream [servername] [transports] and ./NetOffBenchmark server stream [transports]\n";
+		std::cout << "         will compare pushed outputs to request/response stepping.\n";
+		std::cout << "Usage 7: ./NetOffBenchmark client workload [servername] [transports] [workloads] and ./NetOffBenchmark server workload [transports] [workloads]\n";
+		std::cout << "         will step simulations of different costs serially and in parallel.\n";
+		std::cout << "         The workloads are a comma separated subset of uniform,exponential,lognormal,stiff (default: all).\n";
+		std::cout << "Usage 8: ./NetOffBenchmark client async [servername] [transports] and ./NetOffBenchmark server async [transports]\n";
+		std::cout << "         will compare stepping with and without the asynchronous client, while rendering every step.\n";
+		std::cout << "Usage 9: ./NetOffBenchmark client latency [servername] [transports] and ./NetOffBenchmark server latency [transports]\n";
+		std::cout << "         will compare the round trip times of blocking, spinning and busy polling.\n";
+		std::cout << "Usage 10: ./NetOffBenchmark client --count-allocs [servername] [transports] and ./NetOffBenchmark server --count-allocs [transports]\n";
+		std::cout << "          will count the heap allocations of the handshake and fail, if the steps allocate.\n";
+		std::cout << "The transports are a comma separated subset of tcp,unix,shm,uring (default: all). unix and shm need a local server.\n";
+		std::cout << "Usage 11: ./NetOffBenchmark local <mode> [transports] [workloads]\n";
+		std::cout << "          runs server and client of one of the modes 3 to 10 in one process on a free loopback port.\n";
+		std::cout << "          --server-cpus=0,1 and --client-cpus=2 pin the server and the client thread.\n";
+		std::cout << "Options of bench, workload and latency, behind the positional arguments:\n";
+		std::cout << "  --states=16,32,...  --inputs=100,200,...  --sims=1,2,...  sweeps of bench, given to client and server alike.\n";
+		std::cout << "  --rounds=1000       rounds of a bench run.\n";
+		std::cout << "  --format=csv|json   prints CSV or one JSON object per run.\n";
+		std::cout << "  --hdr=prefix        writes the HdrHistogram percentile distribution of every run to prefix<suite>_<run>.hgrm.\n";
+		return 0;
+	}
+	const size_t roundsPerTest = 10;
+	const size_t numRounds = 1000;
+	const size_t statesStart = 16;
+	const double percentInputs = 0.1;
+	const int defaultPort = 3009;
+	const size_t multiStates = 128;
+	const size_t maxMultiClients = 16;
+	const size_t maxPipelineDepth = 32;
+	const size_t stepWork = 64;
+	// 0 steps on the server thread
+	const std::vector<size_t> stepWorkers = { 0, std::max(std::thread::hardware_concurrency(), 1u) };
+	const std::string allTransports = "tcp,unix,shm,uring";
+	const size_t workloadSims = 32;
+	const size_t workloadStates = 1024;
+	const size_t workloadRounds = 100;
+	const std::string allWorkloads = "uniform,exponential,lognormal,stiff";
+	const size_t renderWork = 64;
+	const size_t latencyRounds = 10000;
+	const size_t allocSims = 4;
+	const size_t inputStates = 1000;
+	const size_t simStates = 1024;
+	// the default sweeps double from their first value, the inputs grow by percentInputs of inputStates
+	for (size_t i = 0; i < roundsPerTest; ++i)
+	{
+		benchOptions.states.push_back(statesStart << i);
+		benchOptions.inputs.push_back(static_cast<size_t>(inputStates * percentInputs * (i + 1)));
+		benchOptions.sims.push_back(static_cast<size_t>(1) << i);
+	}
+	benchOptions.rounds = numRounds;
+	std::vector<char *> args;
+	parseBenchOptions(argc, argv, args);
+	// the suites of one side, argv[1] selects it
+	auto runSide = [&](const int & argc, char ** argv, const int & port) -> int
+	{
+		if (std::string(argv[1]) == std::string("client"))
+		{
+			if (std::string(argv[2]) == std::string("bench"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				const size_t rounds = benchOptions.rounds;
+				///////////////////////////////////////// STATES SCALE ///////////////////////////////////////////
+				// Scales the number of states, by default from 16 to 8192, for up to 16 input variables.       //
+			    //////////////////////////////////////////////////////////////////////////////////////////////////
+				benchSuite("states", "Scale states with _" + std::to_string(rounds) + " rounds");
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & stateIt : benchOptions.states)
+					{
+						BenchClient(transport, argv[3], port, std::min(statesStart, stateIt), rounds, 1, true);
+					}
+				}
+
+				///////////////////////////////////////// INPUTES SCALE //////////////////////////////////////////
+				// Scales the number of input variables, by default from 100 to 1000, using 1000 states.        //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				benchSuite("inputs", "Scale input variables with _" + std::to_string(rounds) + " rounds and " + std::to_string(inputStates) + " states");
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & numInputs : benchOptions.inputs)
+					{
+						BenchClient(transport, argv[3], port, std::min(numInputs, inputStates), rounds, 1, true);
+					}
+				}
+
+				///////////////////////////////////////// SIMULATION SCALE with CONSTANT LOAD ////////////////////
+				// Scales the number of simulations, by default from 1 to 512, and the number of states from    //
+				// 1024 down, so the load of a round is constant.                                               //
+			    //////////////////////////////////////////////////////////////////////////////////////////////////
+				benchSuite("sims", "Scale sims with _" + std::to_string(rounds) + " rounds and " + std::to_string(simStates) + " states");
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & curSimNum : benchOptions.sims)
+					{
+						BenchClient(transport, argv[3], port, 1, rounds, curSimNum, true);
+					}
+				}
+
+				///////////////////////////////////////// BATCHED SIMULATION SCALE ///////////////////////////////
+				// Same as above, but the inputs and outputs of all simulations are exchanged in one frame per   //
+				// direction and round.                                                                         //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				benchSuite("batched", "Scale batched sims with _" + std::to_string(rounds) + " rounds and " + std::to_string(simStates) + " states");
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & curSimNum : benchOptions.sims)
+					{
+						BenchClient(transport, argv[3], port, 1, rounds, curSimNum, true, true);
+					}
+				}
+
+				///////////////////////////////////////// PARALLEL SIMULATION SCALE //////////////////////////////
+				// Same as the simulation scale, but every step costs stepWork iterations per state. The server  //
+				// steps the simulations once serially and once in parallel on all hardware threads.            //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				for (const size_t & numWorkers : stepWorkers)
+				{
+					benchSuite("work-" + std::to_string(numWorkers), "Scale sims with _" + std::to_string(rounds) + " rounds, " + std::to_string(simStates) + " states and "
+							+ std::to_string(stepWork) + " iterations per state on "
+							+ ((numWorkers == 0) ? std::string("the server thread") : std::to_string(numWorkers) + " workers"));
+					for (const Transport & transport : transports)
+					{
+						for (const size_t & curSimNum : benchOptions.sims)
+						{
+							BenchClient(transport, argv[3], port, 1, rounds, curSimNum, true);
+						}
+					}
+				}
+
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("workload"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				const std::vector<std::string> workloads = parseWorkloads((argc > 5) ? argv[5] : allWorkloads);
+				///////////////////////////////////////// WORKLOADS //////////////////////////////////////////////
+				// Steps simulations, whose costs follow a distribution with a mean of stepWork iterations per   //
+				// state, on the server thread and on all hardware threads with work stealing.                  //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				for (const std::string & workload : workloads)
+				{
+					for (const size_t & numWorkers : stepWorkers)
+					{
+						benchSuite(workload + "-" + std::to_string(numWorkers), "Workload " + workload + " with _" + std::to_string(workloadRounds) + " rounds, "
+								+ std::to_string(workloadSims) + " sims and " + std::to_string(workloadStates) + " states on "
+								+ ((numWorkers == 0) ? std::string("the server thread") : std::to_string(numWorkers) + " workers"));
+						for (const Transport & transport : transports)
+						{
+							BenchClient(transport, argv[3], port, 1, workloadRounds, workloadSims, true);
+						}
+					}
+				}
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("multi"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// CLIENT SCALE ///////////////////////////////////////////
+				// Scales the number of concurrent clients from 1 to 16, each with one simulation of 128 states.//
+				// The clients run on a thread each and then all on one thread, which waits on their sockets.   //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				std::cout << "Scale clients with _" << numRounds << " rounds and " << multiStates << " states:\n";
+				std::cout << "transport, clientThreads, numClients, numStates, simTime, steps/s, steps/s per client\n";
+				for (const Transport & transport : transports)
+				{
+					for (size_t numClients = 1; numClients <= maxMultiClients; numClients *= 2)
+					{
+						BenchMultiClient(transport, argv[3], multiPort(port, transport), numClients, multiStates, numRounds, true);
+					}
+					for (size_t numClients = 1; numClients <= maxMultiClients; numClients *= 2)
+					{
+						BenchEventLoopClient(transport, argv[3], multiPort(port, transport), numClients, multiStates, numRounds, true);
+					}
+				}
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("pipeline"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// PIPELINE SCALE /////////////////////////////////////////
+				// Scales the steps in flight from 1 to 32 for one simulation of 128 states.                    //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				std::cout << "Scale pipeline depth with _" << numRounds << " rounds and " << multiStates << " states:\n";
+				std::cout << "transport, depth, numStates, simTime/rounds, steps/s\n";
+				for (const Transport & transport : transports)
+				{
+					for (size_t depth = 1; depth <= maxPipelineDepth; depth *= 2)
+					{
+						BenchPipelineClient(transport, argv[3], port, depth, numRounds, true);
+					}
+				}
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("async"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// ASYNC CLIENT ///////////////////////////////////////////
+				// One simulation of 128 states, whose steps cost stepWork iterations per state, is rendered    //
+				// with renderWork iterations per state after every step, synchronously and asynchronously.     //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				std::cout << "Step and render _" << numRounds << " rounds of " << multiStates << " states:\n";
+				std::cout << "transport, client, numStates, time/step, steps/s\n";
+				for (const Transport & transport : transports)
+				{
+					BenchAsyncClient(transport, argv[3], port, renderWork, numRounds, false, true);
+					BenchAsyncClient(transport, argv[3], port, renderWork, numRounds, true, true);
+				}
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("latency"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// WAIT POLICIES //////////////////////////////////////////
+				// Round trip times of one simulation of statesStart states, while client and server block,     //
+				// spin latencySpinUs before they block or only poll.                                           //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				benchSuite("latency", "Round trips of _" + std::to_string(latencyRounds) + " rounds and " + std::to_string(statesStart) + " states");
+				for (const Transport & transport : transports)
+				{
+					for (const NetOff::WaitPolicy & policy : benchWaitPolicies())
+					{
+						BenchLatencyClient(transport, argv[3], port, policy, latencyRounds, true);
+					}
+				}
+				return 0;
+			}
+			else if (std::string(argv[2]) == std::string("--count-allocs"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// ALLOCATIONS ////////////////////////////////////////////
+				// Heap allocations of allocSims simulations of statesStart states, stepped per simulation,    //
+				// batched and in parallel with the outputs received in any order. The steps mustn't allocate, //
+				// neither in the client nor in the server.                                                     //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				std::cout << "Heap allocations of " << numRounds << " rounds:\n";
+				std::cout << "transport, numSims, mode, connect, add, init, start, steps, per step\n";
+				int res = 0;
+				for (const Transport & transport : transports)
+				{
+					res |= BenchAllocClient(transport, argv[3], port, allocSims, numRounds, "single");
+					res |= BenchAllocClient(transport, argv[3], port, allocSims, numRounds, "batched");
+					res |= BenchAllocClient(transport, argv[3], port, allocSims, numRounds, "any order");
+				}
+				return res;
+			}
+			else if (std::string(argv[2]) == std::string("stream"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 4) ? argv[4] : allTransports);
+				///////////////////////////////////////// STREAMING //////////////////////////////////////////////
+				// Updates of one simulation of 128 states per second, requested per step and pushed.           //
+				//////////////////////////////////////////////////////////////////////////////////////////////////
+				std::cout << "Stream _" << numRounds << " updates of " << multiStates << " states:\n";
+				std::cout << "transport, depth (0: pushed), numStates, time/update, updates/s, polls/update\n";
+				for (const Transport & transport : transports)
+				{
+					BenchPipelineClient(transport, argv[3], port, 1, numRounds, true);
+					BenchStreamClient(transport, argv[3], port, numRounds, true);
+				}
+				return 0;
+			}
+			else
+			{
+				size_t numInputs = std::stoi(argv[2]);
+				size_t numRounds = std::stoi(argv[3]);
+				int port = std::stoi(argv[4]);
+				return BenchClient(Transport::SHM, argv[5], port, numInputs, numRounds);
+			}
+		}
+		else if (std::string(argv[1]) == std::string("server"))
+		{
+			if (std::string(argv[2]) == std::string("bench"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+			    ///////////////////////////////////////// STATES SCALE ///////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & stateIt : benchOptions.states)
+					{
+						BenchServer(transport, port, stateIt);
+					}
+				}
+
+			    ///////////////////////////////////////// INPUTES SCALE //////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (size_t i = 0; i < benchOptions.inputs.size(); ++i)
+					{
+						BenchServer(transport, port, inputStates);
+					}
+				}
+
+			    ///////////////////////////////////////// SIMULATION SCALE with CONSTANT LOAD ////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & curSimNum : benchOptions.sims)
+					{
+						BenchServer(transport, port, std::max(simStates / curSimNum, static_cast<size_t>(1)));
+					}
+				}
+
+			    ///////////////////////////////////////// BATCHED SIMULATION SCALE ///////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (const size_t & curSimNum : benchOptions.sims)
+					{
+						BenchServer(transport, port, std::max(simStates / curSimNum, static_cast<size_t>(1)));
+					}
+				}
+
+			    ///////////////////////////////////////// PARALLEL SIMULATION SCALE //////////////////////////////
+				for (const size_t & numWorkers : stepWorkers)
+				{
+					for (const Transport & transport : transports)
+					{
+						for (const size_t & curSimNum : benchOptions.sims)
+						{
+							BenchServer(transport, port, std::max(simStates / curSimNum, static_cast<size_t>(1)), std::vector<size_t>(1, stepWork), numWorkers);
+						}
+					}
+				}
+
+				return 0;
+			} else if (std::string(argv[2]) == std::string("workload"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				const std::vector<std::string> workloads = parseWorkloads((argc > 4) ? argv[4] : allWorkloads);
+				///////////////////////////////////////// WORKLOADS //////////////////////////////////////////////
+				for (const std::string & workload : workloads)
+				{
+					const std::vector<size_t> work = benchWorkload(workload, workloadSims, stepWork);
+					for (const size_t & numWorkers : stepWorkers)
+					{
+						for (const Transport & transport : transports)
+						{
+							BenchServer(transport, port, workloadStates, work, numWorkers);
+						}
+					}
+				}
+				return 0;
+			} else if (std::string(argv[2]) == std::string("multi"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// CLIENT SCALE ///////////////////////////////////////////
+				// one server per transport serves all client sessions of both sweeps: 2 * (1 + 2 + 4 + 8 + 16)
+				for (const Transport & transport : transports)
+				{
+					BenchMultiServer(transport, multiPort(port, transport), multiStates, 2 * (2 * maxMultiClients - 1));
+				}
+				return 0;
+			} else if (std::string(argv[2]) == std::string("pipeline"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// PIPELINE SCALE /////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (size_t depth = 1; depth <= maxPipelineDepth; depth *= 2)
+					{
+						BenchServer(transport, port, multiStates);
+					}
+				}
+				return 0;
+			} else if (std::string(argv[2]) == std::string("async"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// ASYNC CLIENT ///////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					BenchServer(transport, port, multiStates, std::vector<size_t>(1, stepWork));
+					BenchServer(transport, port, multiStates, std::vector<size_t>(1, stepWork));
+				}
+				return 0;
+			} else if (std::string(argv[2]) == std::string("latency"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// WAIT POLICIES //////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					for (const NetOff::WaitPolicy & policy : benchWaitPolicies())
+					{
+						BenchServer(transport, port, statesStart, std::vector<size_t>(), 0, policy);
+					}
+				}
+				return 0;
+			} else if (std::string(argv[2]) == std::string("--count-allocs"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// ALLOCATIONS ////////////////////////////////////////////
+				std::cout << "side, transport, numSims, handshake, numSteps, steps\n";
+				int res = 0;
+				for (const Transport & transport : transports)
+				{
+					res |= BenchAllocServer(transport, port, statesStart);
+					res |= BenchAllocServer(transport, port, statesStart);
+					res |= BenchAllocServer(transport, port, statesStart, allocSims);
+				}
+				return res;
+			} else if (std::string(argv[2]) == std::string("stream"))
+			{
+				const std::vector<Transport> transports = parseTransports((argc > 3) ? argv[3] : allTransports);
+				///////////////////////////////////////// STREAMING //////////////////////////////////////////////
+				for (const Transport & transport : transports)
+				{
+					BenchServer(transport, port, multiStates);
+					BenchStreamServer(transport, port, multiStates);
+				}
+				return 0;
+			} else
+			{
+				size_t numStates = std::stoi(argv[2]);
+				int port = std::stoi(argv[3]);
+				return BenchServer(Transport::SHM, port, numStates);
+			}
+		}
+		return 0;
+	};
+
+	if (std::string(argv[1]) == std::string("local") && argc > 2)
+	{
+		// both sides run in this process, the server on a thread of its own
+		const int port = reserveLoopbackPort();
+		std::vector<char *> serverArgs = { argv[0], const_cast<char *>("server") };
+		std::vector<char *> clientArgs = { argv[0], const_cast<char *>("client"), argv[2], const_cast<char *>("localhost") };
+		serverArgs.insert(serverArgs.end(), argv + 2, argv + argc);
+		clientArgs.insert(clientArgs.end(), argv + 3, argv + argc);
+		serverArgs.push_back(nullptr);
+		clientArgs.push_back(nullptr);
+		int serverRes = 0;
+		std::thread server([&]()
+		{
+			if (!benchOptions.serverCpus.empty() && !NetOff::pinCurrentThread(benchOptions.serverCpus))
+				std::cerr << "Couldn't pin the server.\n";
+			serverRes = runSide(static_cast<int>(serverArgs.size()) - 1, serverArgs.data(), port);
+		});
+		if (!benchOptions.clientCpus.empty() && !NetOff::pinCurrentThread(benchOptions.clientCpus))
+			std::cerr << "Couldn't pin the client.\n";
+		const int clientRes = runSide(static_cast<int>(clientArgs.size()) - 1, clientArgs.data(), port);
+		server.join();
+		return clientRes | serverRes;
+	}
+	return runSide(argc, argv, defaultPort);
 }
@@ -0,0 +1,239 @@
+/*
+ * SerializationBenchmark.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: agent
+ */
+
+#include "../include/BufferPool.hpp"
+#include "../include/VariableList.hpp"
+#include "../include/messages/AddSimMessage.hpp"
+#include "../include/messages/InitSimulationMessage.hpp"
+#include "../include/messages/ValueContainerMessage.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace NetOff;
+
+struct SerializationOptions
+{
+	std::vector<size_t> vars;
+	std::vector<size_t> names;
+	double minTime;
+	bool json;
+};
+
+SerializationOptions options { { 10, 100, 1000, 10000, 100000, 1000000 }, { 4, 16, 64, 256 }, 0.1, false };
+
+/*! Keeps the results of the timed operations alive, so the compiler can't drop them. */
+volatile size_t sink = 0;
+
+std::vector<size_t> parseSizes(const std::string & list)
+{
+	std::vector<size_t> res;
+	std::istringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ','))
+		if (!item.empty())
+			res.push_back(std::strtoull(item.c_str(), nullptr, 10));
+	return res;
+}
+
+bool parseOptions(int argc, char * argv[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+		if (arg.compare(0, 7, "--vars=") == 0)
+			options.vars = parseSizes(arg.substr(7));
+		else if (arg.compare(0, 8, "--names=") == 0)
+			options.names = parseSizes(arg.substr(8));
+		else if (arg.compare(0, 11, "--min-time=") == 0)
+			options.minTime = std::atof(arg.substr(11).c_str()) / 1000.0;
+		else if (arg == "--format=json")
+			options.json = true;
+		else
+			return false;
+	}
+	return !options.vars.empty() && !options.names.empty();
+}
+
+/*! A model with numVars variables of nameLength characters, a third of them each real, integer and boolean. Names are
+ * numbered from the back like "xxxx12", so they differ like the names of a flattened model. */
+VariableList createVariables(const size_t & numVars, const size_t & nameLength)
+{
+	VariableList res;
+	std::vector<std::string> names[3];
+	for (size_t i = 0; i < numVars; ++i)
+	{
+		std::string name(nameLength, 'x');
+		const std::string number = std::to_string(i);
+		const size_t numDigits = std::min(number.size(), nameLength);
+		name.replace(nameLength - numDigits, numDigits, number, number.size() - numDigits, numDigits);
+		names[i % 3].push_back(name);
+	}
+	res.addReals(names[0]);
+	res.addInts(names[1]);
+	res.addBools(names[2]);
+	return res;
+}
+
+/*! Runs the operation until it took options.minTime and returns the nanoseconds per run. The first run is a warm-up
+ * and not timed, the number of runs doubles, so the clock is read rarely for fast operations. */
+double timeOperation(const std::function<void()> & operation, size_t & numRuns)
+{
+	typedef std::chrono::steady_clock Clock;
+	operation();
+	numRuns = 0;
+	double seconds = 0.0;
+	size_t batch = 1;
+	while (seconds < options.minTime)
+	{
+		const Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < batch; ++i)
+			operation();
+		seconds += std::chrono::duration<double>(Clock::now() - start).count();
+		numRuns += batch;
+		batch *= 2;
+	}
+	return seconds * 1e9 / numRuns;
+}
+
+/*! Returns the bytes of the encoded message like the receiving side gets them. */
+template<typename Message>
+std::shared_ptr<char> copyData(const Message & message)
+{
+	std::shared_ptr<char> res = BufferPool::allocate(message.dataSize());
+	std::memcpy(res.get(), message.data(), message.dataSize());
+	return res;
+}
+
+bool columnsPrinted = false;
+
+void report(const std::string & message, const std::string & operation, const size_t & numVars, const size_t & nameLength,
+		const size_t & numBytes, const std::function<void()> & run)
+{
+	size_t numRuns = 0;
+	const double ns = timeOperation(run, numRuns);
+	const double mbPerSecond = numBytes * 1e3 / ns;
+	if (options.json)
+	{
+		std::cout << "{\"message\": \"" << message << "\", \"operation\": \"" << operation << "\", \"variables\": " << numVars
+				<< ", \"name length\": " << nameLength << ", \"runs\": " << numRuns << ", \"ns/op\": " << ns << ", \"bytes/op\": "
+				<< numBytes << ", \"MB/s\": " << mbPerSecond << "}" << std::endl;
+		return;
+	}
+	if (!columnsPrinted)
+	{
+		std::cout << "message, operation, variables, name length, runs, ns/op, bytes/op, MB/s" << std::endl;
+		columnsPrinted = true;
+	}
+	std::cout << message << "," << operation << "," << numVars << "," << nameLength << "," << numRuns << "," << ns << ","
+			<< numBytes << "," << mbPerSecond << std::endl;
+}
+
+/*! Encodes and decodes every handshake message and the value message of one model. Inputs and outputs of the handshake
+ * are the whole model, like a client, which selects all variables. */
+void benchModel(const size_t & numVars, const size_t & nameLength)
+{
+	const VariableList vars = createVariables(numVars, nameLength);
+	const int simId = 0;
+	{
+		std::vector<char> buffer(vars.dataSize());
+		report("VariableList", "encode", numVars, nameLength, buffer.size(), [&]()
+		{
+			vars.saveVariablesTo(buffer.data());
+			sink += vars.dataSize();
+		});
+		report("VariableList", "decode", numVars, nameLength, buffer.size(), [&]()
+		{
+			sink += VariableList::getVariableListFromData(buffer.data()).sizeReals();
+		});
+	}
+	BufferPool::trim();
+	{
+		const size_t numBytes = AddSimSuccessMessage(simId, vars, vars).dataSize();
+		report("AddSimSuccessMessage", "encode", numVars, nameLength, numBytes, [&]()
+		{
+			sink += AddSimSuccessMessage(simId, vars, vars).dataSize();
+		});
+		std::shared_ptr<char> data = copyData(AddSimSuccessMessage(simId, vars, vars));
+		report("AddSimSuccessMessage", "decode", numVars, nameLength, numBytes, [&]()
+		{
+			AddSimSuccessMessage message(data);
+			sink += message.getInputVariableList().sizeReals() + message.getOutputVariableList().sizeReals();
+		});
+	}
+	BufferPool::trim();
+	{
+		const size_t numBytes = InitSimulationMessage(simId, vars, vars).dataSize();
+		report("InitSimulationMessage", "encode", numVars, nameLength, numBytes, [&]()
+		{
+			sink += InitSimulationMessage(simId, vars, vars).dataSize();
+		});
+		std::shared_ptr<char> data = copyData(InitSimulationMessage(simId, vars, vars));
+		report("InitSimulationMessage", "decode", numVars, nameLength, numBytes, [&]()
+		{
+			InitSimulationMessage message(data);
+			sink += message.getInputs().sizeReals() + message.getOutputs().sizeReals();
+		});
+	}
+	BufferPool::trim();
+	{
+		// the names don't reach the value messages, so only the first name length is interesting
+		if (nameLength != options.names.front())
+			return;
+		const std::vector<double> reals(vars.getReals().size(), 1.0);
+		const std::vector<int> ints(vars.getInts().size(), 1);
+		const std::vector<char> bools(vars.getBools().size(), 1);
+		ValueContainerMessage<ServerMessageSpecifyer> wire(simId, vars, ServerMessageSpecifyer::OUTPUTS);
+		const size_t numBytes = wire.dataSize();
+		report("ValueContainerMessage", "encode", numVars, nameLength, numBytes, [&]()
+		{
+			ValueContainerMessage<ServerMessageSpecifyer> message(simId, vars, ServerMessageSpecifyer::OUTPUTS);
+			message.setTime(1.0);
+			message.getContainer().setRealValues(reals.data());
+			message.getContainer().setIntValues(ints.data());
+			message.getContainer().setBoolValues(bools.data());
+			sink += message.dataSize();
+		});
+		// receiving copies the frame into the buffer of the message, whose container is read afterwards
+		ValueContainerMessage<ServerMessageSpecifyer> message(simId, vars, ServerMessageSpecifyer::OUTPUTS);
+		std::vector<double> realsOut(reals.size());
+		std::vector<int> intsOut(ints.size());
+		std::vector<char> boolsOut(bools.size());
+		report("ValueContainerMessage", "decode", numVars, nameLength, numBytes, [&]()
+		{
+			std::memcpy(message.data(), wire.data(), numBytes);
+			const ValueContainer & container = message.getContainer();
+			std::copy(container.getRealValues(), container.getRealValues() + realsOut.size(), realsOut.begin());
+			std::copy(container.getIntValues(), container.getIntValues() + intsOut.size(), intsOut.begin());
+			std::copy(container.getBoolValues(), container.getBoolValues() + boolsOut.size(), boolsOut.begin());
+			sink += static_cast<size_t>(message.getTime());
+		});
+	}
+	BufferPool::trim();
+}
+
+int main(int argc, char * argv[])
+{
+	if (!parseOptions(argc, argv))
+	{
+		std::cout << "Usage: " << argv[0] << " [--vars=10,100,...] [--names=4,16,...] [--min-time=ms] [--format=json]\n"
+				<< "Times encoding and decoding of the handshake and value messages for every number of variables and name length." << std::endl;
+		return 1;
+	}
+	std::cout << std::fixed << std::setprecision(1);
+	for (const size_t & numVars : options.vars)
+		for (const size_t & nameLength : options.names)
+			benchModel(numVars, nameLength);
+	return 0;
+}
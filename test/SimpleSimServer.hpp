@@ -10,7 +10,9 @@
 
 #include "../include/SimulationServer.hpp"
 
+#include <chrono>
 #include <fstream>
+#include <thread>
 
 struct PseudoSim
 {
@@ -178,7 +180,7 @@ int serverFunc(int port)
             {
                 // pause a bit (1sec):
                 noFS.confirmPause();            // NON OPTIONAL CALL!!!!!!!!!!!!
-                SDL_Delay(1000);
+                std::this_thread::sleep_for(std::chrono::seconds(1));
                 break;
             }
             case NetOff::ClientMessageSpecifyer::UNPAUSE: